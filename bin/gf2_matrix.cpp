@@ -0,0 +1,295 @@
+#include "gf2_matrix.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace {
+    /** Hands the blocks of gf2_matrix::reduce() to its worker threads
+     *
+     * The calling thread publishes a block by incrementing generation, every worker applies it to its rows and
+     * decrements pending. Table and index are written before the mutex is released, so the workers see them.
+     */
+    struct block_sync_t {
+        std::mutex mutex;
+        std::condition_variable start_cond;
+        std::condition_variable done_cond;
+        uint64_t generation;
+        uint64_t pending;
+        uint64_t first_word;
+        bool quit;
+    };
+}
+
+gf2_matrix::gf2_matrix(uint64_t rows, uint64_t cols) {
+    this->rows = rows;
+    this->cols = cols;
+    this->words = (cols+63)/64;
+    this->data = new uint64_t[rows*this->words]();
+}
+
+gf2_matrix::~gf2_matrix() {
+    delete[] this->data;
+}
+
+uint64_t gf2_matrix::get_rows(void) const {
+    return this->rows;
+}
+
+uint64_t gf2_matrix::get_cols(void) const {
+    return this->cols;
+}
+
+bool gf2_matrix::get(uint64_t row, uint64_t col) const {
+    return (this->row(row)[col/64] >> (col%64)) & 0x01u;
+}
+
+void gf2_matrix::set(uint64_t row, uint64_t col) {
+    this->row(row)[col/64] |= static_cast<uint64_t>(1) << (col%64);
+}
+
+uint64_t* gf2_matrix::row(uint64_t r) {
+    return &this->data[r*this->words];
+}
+
+const uint64_t* gf2_matrix::row(uint64_t r) const {
+    return &this->data[r*this->words];
+}
+
+void gf2_matrix::add_row(uint64_t dst, uint64_t src, uint64_t first_word) {
+    uint64_t *d = this->row(dst);
+    const uint64_t *s = this->row(src);
+    for(uint64_t w=first_word; w<this->words; w++) {
+        d[w] ^= s[w];
+    }
+}
+
+void gf2_matrix::swap_rows(uint64_t a, uint64_t b) {
+    if(a != b) {
+        std::swap_ranges(this->row(a), this->row(a)+this->words, this->row(b));
+    }
+}
+
+void gf2_matrix::swap_cols(uint64_t a, uint64_t b) {
+    for(uint64_t r=0; r<this->rows; r++) {
+        if(this->get(r, a) != this->get(r, b)) {
+            this->row(r)[a/64] ^= static_cast<uint64_t>(1) << (a%64);
+            this->row(r)[b/64] ^= static_cast<uint64_t>(1) << (b%64);
+        }
+    }
+}
+
+uint64_t gf2_matrix::find_pivot(uint64_t c, uint64_t i, uint64_t k) const {
+    // Column c+i of a row as it will be once the pivots of columns c...c+i-1 are applied
+    uint64_t r = c+i;
+    for(; r<this->rows; r++) {
+        uint64_t b = this->get_block(r, c, k);
+        for(uint64_t j=0; j<i; j++) {
+            if((b >> j) & 0x01u) {
+                b ^= this->get_block(c+j, c, k);
+            }
+        }
+        if((b >> i) & 0x01u) {
+            break;
+        }
+    }
+    return r;
+}
+
+uint64_t gf2_matrix::find_pivot_column(uint64_t c, uint64_t i, uint64_t k, uint64_t num_cols) const {
+    // First column behind num_cols that is set in any remaining row, once the pivots of the block are applied
+    const uint64_t first_word = num_cols/64;
+    const uint64_t first_mask = ~((static_cast<uint64_t>(1) << (num_cols%64)) - 1);
+    for(uint64_t r=c+i; r<this->rows; r++) {
+        uint64_t b = this->get_block(r, c, k);
+        uint64_t sel = 0;
+        for(uint64_t j=0; j<i; j++) {
+            if((b >> j) & 0x01u) {
+                b ^= this->get_block(c+j, c, k);
+                sel |= static_cast<uint64_t>(1) << j;
+            }
+        }
+        
+        for(uint64_t w=first_word; w<this->words; w++) {
+            uint64_t v = this->row(r)[w];
+            for(uint64_t j=0; j<i; j++) {
+                if((sel >> j) & 0x01u) {
+                    v ^= this->row(c+j)[w];
+                }
+            }
+            v &= (w == first_word) ? first_mask : ~static_cast<uint64_t>(0);
+            if(v != 0) {
+                return w*64 + static_cast<uint64_t>(__builtin_ctzll(v));
+            }
+        }
+    }
+    return this->cols;
+}
+
+uint64_t gf2_matrix::get_block(uint64_t r, uint64_t col, uint64_t num) const {
+    const uint64_t *p = this->row(r);
+    uint64_t v = p[col/64] >> (col%64);
+    if(col%64 + num > 64) {
+        v |= p[col/64+1] << (64 - col%64);
+    }
+    return v & ((static_cast<uint64_t>(1) << num) - 1);
+}
+
+bool gf2_matrix::reduce(uint64_t num_cols, uint64_t num_threads, uint64_t *col_order) {
+    if(num_cols > this->rows || num_cols > this->cols) {
+        return false;
+    }
+    
+    if(num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        num_threads = (num_threads > 0) ? num_threads : 1;
+    }
+    num_threads = std::min<uint64_t>(num_threads, this->rows);
+    
+    const uint64_t table_rows = static_cast<uint64_t>(1) << GF2_M4RM_BITS;
+    uint64_t *table = new uint64_t[table_rows*this->words];
+    uint64_t *index = new uint64_t[this->rows];
+    
+    // Apply the table stripe by stripe, so the stripe of the table stays in the cache
+    auto apply = [this, table, index](uint64_t first_word, uint64_t first_row, uint64_t last_row) {
+        for(uint64_t w0=first_word; w0<this->words; w0+=GF2_M4RM_STRIPE_WORDS) {
+            const uint64_t w1 = std::min<uint64_t>(w0+GF2_M4RM_STRIPE_WORDS, this->words);
+            for(uint64_t r=first_row; r<last_row; r++) {
+                if(index[r] != 0) {
+                    const uint64_t *src = &table[index[r]*this->words];
+                    uint64_t *dst = this->row(r);
+                    for(uint64_t w=w0; w<w1; w++) {
+                        dst[w] ^= src[w];
+                    }
+                }
+            }
+        }
+    };
+    
+    // The workers are started once, the calling thread applies the table to the first share of the rows
+    block_sync_t sync;
+    sync.generation = 0;
+    sync.pending = 0;
+    sync.first_word = 0;
+    sync.quit = false;
+    
+    auto worker = [this, &sync, &apply, num_threads](uint64_t t) {
+        uint64_t generation = 0;
+        while(true) {
+            uint64_t first_word;
+            {
+                std::unique_lock<std::mutex> lock(sync.mutex);
+                sync.start_cond.wait(lock, [&sync, generation]() { return sync.quit || sync.generation != generation; });
+                if(sync.quit) {
+                    return;
+                }
+                generation = sync.generation;
+                first_word = sync.first_word;
+            }
+            
+            apply(first_word, this->rows*t/num_threads, this->rows*(t+1)/num_threads);
+            
+            {
+                std::lock_guard<std::mutex> lock(sync.mutex);
+                sync.pending--;
+            }
+            sync.done_cond.notify_one();
+        }
+    };
+    
+    std::thread *threads = new std::thread[num_threads];
+    for(uint64_t t=1; t<num_threads; t++) {
+        threads[t] = std::thread(worker, t);
+    }
+    
+    bool ret = true;
+    for(uint64_t c=0; c<num_cols && ret; c+=GF2_M4RM_BITS) {
+        const uint64_t k = std::min<uint64_t>(GF2_M4RM_BITS, num_cols-c);
+        
+        // Columns left of c are zero in all rows from c on, so row operations start at the word of column c
+        const uint64_t first_word = c/64;
+        
+        // Move a pivot for every column of the block to rows c...c+k-1 and reduce them among each other
+        for(uint64_t i=0; i<k && ret; i++) {
+            uint64_t r = this->find_pivot(c, i, k);
+            if(r == this->rows && col_order) {
+                // Bring in a later column with a pivot, it takes the place of column c+i
+                const uint64_t q = this->find_pivot_column(c, i, k, num_cols);
+                if(q < this->cols) {
+                    this->swap_cols(c+i, q);
+                    std::swap(col_order[c+i], col_order[q]);
+                    r = this->find_pivot(c, i, k);
+                }
+            }
+            if(r == this->rows) {
+                ret = false;
+                break;
+            }
+            
+            this->swap_rows(r, c+i);
+            for(uint64_t j=0; j<i; j++) {
+                if(this->get(c+i, c+j)) {
+                    this->add_row(c+i, c+j, first_word);
+                }
+            }
+            for(uint64_t j=0; j<i; j++) {
+                if(this->get(c+j, c+i)) {
+                    this->add_row(c+j, c+i, first_word);
+                }
+            }
+        }
+        if(!ret) {
+            break;
+        }
+        
+        // Every combination of the pivot rows, combination t adds pivot row j if bit j of t is set
+        std::memset(&table[first_word], 0, (this->words-first_word)*sizeof(uint64_t));
+        for(uint64_t t=1; t<(static_cast<uint64_t>(1) << k); t++) {
+            const uint64_t *src = this->row(c + static_cast<uint64_t>(__builtin_ctzll(t)));
+            const uint64_t *prev = &table[(t & (t-1))*this->words];
+            uint64_t *dst = &table[t*this->words];
+            for(uint64_t w=first_word; w<this->words; w++) {
+                dst[w] = prev[w] ^ src[w];
+            }
+        }
+        
+        // The pivot rows are the identity on the block, so its bits select the combination that clears them
+        for(uint64_t r=0; r<this->rows; r++) {
+            index[r] = (r >= c && r < c+k) ? 0 : this->get_block(r, c, k);
+        }
+        
+        // Small blocks are applied right here, waking the workers would take longer
+        if(num_threads > 1 && this->rows*(this->words-first_word) >= GF2_PARALLEL_MIN_WORDS) {
+            {
+                std::lock_guard<std::mutex> lock(sync.mutex);
+                sync.first_word = first_word;
+                sync.pending = num_threads-1;
+                sync.generation++;
+            }
+            sync.start_cond.notify_all();
+            
+            apply(first_word, 0, this->rows/num_threads);
+            
+            std::unique_lock<std::mutex> lock(sync.mutex);
+            sync.done_cond.wait(lock, [&sync]() { return sync.pending == 0; });
+        } else {
+            apply(first_word, 0, this->rows);
+        }
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(sync.mutex);
+        sync.quit = true;
+    }
+    sync.start_cond.notify_all();
+    for(uint64_t t=1; t<num_threads; t++) {
+        threads[t].join();
+    }
+    
+    delete[] threads;
+    delete[] index;
+    delete[] table;
+    
+    return ret;
+}
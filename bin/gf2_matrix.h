@@ -0,0 +1,69 @@
+#ifndef __LDPC_GF2_MATRIX_H__DEFINED__
+#define __LDPC_GF2_MATRIX_H__DEFINED__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/** Number of columns eliminated at once by gf2_matrix::reduce(), the lookup table has 2^GF2_M4RM_BITS rows */
+#define GF2_M4RM_BITS 8
+
+/** Number of 64 bit words of a row updated at once, so the part of the lookup table in use stays in the cache */
+#define GF2_M4RM_STRIPE_WORDS 64
+
+/** Smallest number of words a block of gf2_matrix::reduce() has to update to be split among the threads */
+#define GF2_PARALLEL_MIN_WORDS 65536
+
+/** Dense matrix over GF(2) with bit-packed rows
+ *
+ * Column c of a row is bit c%64 of word c/64, unused bits of the last word are zero.
+ */
+class gf2_matrix {
+private:
+    uint64_t rows;
+    uint64_t cols;
+    
+    /** Number of 64 bit words per row */
+    uint64_t words;
+    
+    uint64_t *data;
+    
+public:
+    /** Create an all-zero matrix */
+    gf2_matrix(uint64_t rows, uint64_t cols);
+    ~gf2_matrix();
+    
+    uint64_t get_rows(void) const;
+    uint64_t get_cols(void) const;
+    
+    bool get(uint64_t row, uint64_t col) const;
+    void set(uint64_t row, uint64_t col);
+    
+    /** Gauss-Jordan elimination of the first num_cols columns with the Method of the Four Russians
+     *
+     * Afterwards these columns form the identity in the first num_cols rows and are zero in any further rows,
+     * so the remaining columns of the first num_cols rows hold the inverse of the leading square block applied
+     * to them. Returns false if the first num_cols columns have less than full rank.
+     *
+     * GF2_M4RM_BITS columns are eliminated at a time: their pivot rows are reduced among each other, then every
+     * other row is reduced by a single lookup into a table of all combinations of the pivot rows. The rows are
+     * split among num_threads threads, zero uses one thread per core. The threads are started once and
+     * synchronized for every block, blocks of less than GF2_PARALLEL_MIN_WORDS words run on the calling thread.
+     * 
+     * If col_order is given (cols elements, initialised by the caller), a column of the first num_cols
+     * columns without a pivot is swapped with a later column that has one, and the swap is applied to
+     * col_order. Then false is only returned if the whole matrix has less than full row rank.
+     */
+    bool reduce(uint64_t num_cols, uint64_t num_threads, uint64_t *col_order=NULL);
+    
+private:
+    uint64_t* row(uint64_t r);
+    const uint64_t* row(uint64_t r) const;
+    void add_row(uint64_t dst, uint64_t src, uint64_t first_word);
+    void swap_rows(uint64_t a, uint64_t b);
+    void swap_cols(uint64_t a, uint64_t b);
+    uint64_t find_pivot(uint64_t c, uint64_t i, uint64_t k) const;
+    uint64_t find_pivot_column(uint64_t c, uint64_t i, uint64_t k, uint64_t num_cols) const;
+    uint64_t get_block(uint64_t r, uint64_t col, uint64_t num) const;
+};
+
+#endif /* __LDPC_GF2_MATRIX_H__DEFINED__ */
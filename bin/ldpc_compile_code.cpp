@@ -0,0 +1,74 @@
+#include <ldpc/code.h>
+#include <ldpc/encoder.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void usage(const char *name) {
+    fprintf(stdout, "Usage: %s [-o generator_file] parity_file output_file <front|back num_punct>\n", name);
+    fprintf(stdout, "       %s -g generator_file output_file\n\n", name);
+    fprintf(stdout, "Converts a parity check matrix (alist or base matrix) into a compiled code, which the library maps\n");
+    fprintf(stdout, "instead of parsing it. Puncturing maps for the given puncturing are stored along with the code.\n");
+    fprintf(stdout, "With -o the bits are stored in the column order of the generator (see ldpc_compute_generator -p).\n\n");
+    fprintf(stdout, "With -g a generator (*.gen) is converted into a compiled generator, which encoders map and encode from.\n");
+    exit( EXIT_FAILURE );
+}
+
+int main(int argc, char* argv[]) {
+    if(argc == 4 && strcmp(argv[1], "-g") == 0) {
+        ldpc::puncturing::conf_t pconf;
+        ldpc::encoder enc(argv[2], ldpc::systematic::NONE, &pconf);
+        
+        printf("Writing compiled generator (%lu information bytes, %lu parity bytes) to %s\n", enc.get_num_input(), enc.get_num_output(), argv[3]);
+        enc.write_compiled(argv[3]);
+        
+        return EXIT_SUCCESS;
+    }
+    
+    // The column order of a generator computed with pivoting
+    const char *name = argv[0];
+    const char *gen_file = NULL;
+    if(argc > 2 && strcmp(argv[1], "-o") == 0) {
+        gen_file = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+    
+    if(argc != 3 && argc != 5) {
+        usage(name);
+    }
+    
+    ldpc::puncturing::puncturing_t type = ldpc::puncturing::NONE;
+    uint64_t num_punct = 0;
+    if(argc == 5) {
+        if(strcmp(argv[3], "front") == 0) {
+            type = ldpc::puncturing::FRONT;
+        } else if(strcmp(argv[3], "back") == 0) {
+            type = ldpc::puncturing::BACK;
+        } else {
+            fprintf(stderr, "Unknown puncturing %s, expected front or back.\n", argv[3]);
+            exit( EXIT_FAILURE );
+        }
+        num_punct = strtoull(argv[4], NULL, 10);
+    }
+    
+    const uint64_t *column_order = NULL;
+    ldpc::puncturing::conf_t gen_pconf;
+    ldpc::encoder *enc = NULL;
+    if(gen_file) {
+        enc = new ldpc::encoder(gen_file, ldpc::systematic::NONE, &gen_pconf);
+        column_order = enc->get_column_order();
+        if(!column_order) {
+            printf("Generator %s has no column order, the bits keep the order of the parity check matrix\n", gen_file);
+        }
+    }
+    
+    ldpc::puncturing::conf_t pconf(type, num_punct, NULL);
+    ldpc::code c(argv[1], ldpc::systematic::NONE, &pconf, column_order);
+    
+    printf("Writing compiled code (%lu checks, %lu bits, %lu punctured) to %s\n", c.get_num_checks(), c.get_num_bits(), num_punct, argv[2]);
+    c.write_compiled(argv[2]);
+    delete enc;
+    
+    return EXIT_SUCCESS;
+}
@@ -1,11 +1,11 @@
-#include <NTL/GF2.h>
-#include <NTL/mat_GF2.h>
+#include "gf2_matrix.h"
+#include <ldpc/code.h>
+#include <ldpc/encoder.h>
 #include <vector>
 #include <stdio.h>
-#include <unistd.h>
 #include <stdlib.h>
-#include <errno.h>
 #include <stdint.h>
+#include <string.h>
 
 void error(const char* err_str) {
     fprintf(stderr, "ERROR: ");
@@ -14,212 +14,130 @@ void error(const char* err_str) {
     exit( EXIT_FAILURE );
 }
 
-template <typename T> std::vector<T> parse_digits_from_line(FILE *f, const char *line_descr, size_t num, bool ignore_zeros) {
-    std::vector<T> ret;
-    
-    char *line = NULL;
-    char *line_alloc;
-    char *end;
-    size_t len = 0;
-    ssize_t read;
-    
-    read = getline(&line, &len, f);
-    if(read == -1) {
-        fprintf(stderr, "EOF reached while reading %s.\n", line_descr);
-        exit( EXIT_FAILURE );
-    }
-    line_alloc = line;
-    
-    //fprintf(stdout, "Parsing line: '%s'\n", line);
-    for (long long i = strtoll(line, &end, 10); line != end; i = strtol(line, &end, 10)) {
-        //fprintf(stdout, "'%.*s' -> %lld", (int)(end-line), line, i);
-        line = end;
-        if (errno == ERANGE){
-            fprintf(stderr, "Read number is out of range.\n");
-            exit( EXIT_FAILURE );
-        } else if(i<0) {
-            fprintf(stderr, "Number is negative.\n");
-            exit( EXIT_FAILURE );
-        } else {
-            // Value in range
-            
-            if(!ignore_zeros || i != 0) {
-                ret.push_back( (T) i );
-            }
-        }
-    }
-    
-    free(line_alloc);
-    
-    if(ret.size() != num) {
-        fprintf(stderr, "%lu numbers read in %s line, but %lu were expected.\n", ret.size(), line_descr, num);
-        exit( EXIT_FAILURE );
-    }
-    
-    return ret;
+/** First column of G in the matrix returned by compute_generator() */
+size_t generator_offset(size_t N) {
+    return (N+63)/64*64;
 }
 
+/** Column of the parity check matrix of column col of the matrix returned by compute_generator() */
+size_t parity_check_column(size_t col, size_t N, size_t K) {
+    return (col < N) ? K+col : col-generator_offset(N);
+}
 
-void compute_generator(NTL::Mat<NTL::GF2> &G, const char* alist_file) {
-    NTL::Mat<NTL::GF2> Q, P;
-    
-    ////
-    //// Read alist file and output matrix as wide [Q P] matrix
-    ////
-    // M > N
+/** Compute the generator, with pivoting the column order of the codeword bits is returned in col_order
+ *
+ * col_order is NULL if the columns of P can be used as they are.
+ */
+gf2_matrix* compute_generator(const char* alist_file, uint64_t num_threads, bool pivoting, std::vector<uint64_t> *col_order) {
+    // The parity check matrix is read by the library, tall matrices are transposed to NxM with M >= N
     // K := M-N
     // Q: NxK matrix
     // P: NxN matrix
+    // Q starts at the word following P, so G can be read from whole words
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code code(alist_file, ldpc::systematic::NONE, &punctconf);
     
-    FILE* f = fopen(alist_file, "r");
-    
-    if(!f) {
-        fprintf(stderr, "Cannot open file %s\n", alist_file);
-        exit( EXIT_FAILURE );
-    }
-    
-    std::vector<size_t> buf;
-    std::vector<size_t> num_n, num_m;
-    
-    // Read N M
-    buf = parse_digits_from_line<size_t>(f, "dimensions", 2, false);
-    
-    const size_t alist_N = buf[0];
-    const size_t alist_M = buf[1];
-    
-    bool do_trans = (alist_N > alist_M);
-    
-    const size_t N = do_trans ? alist_M : alist_N;
-    const size_t M = do_trans ? alist_N : alist_M;
-    
-    if(N > M) {
-        error("Transpose logic failed.");
-    }
-    
+    const size_t N = code.get_num_checks();
+    const size_t M = code.get_num_bits();
     const size_t K = M-N;
-    Q.SetDims(static_cast<long>(N), static_cast<long>(K));
-    P.SetDims(static_cast<long>(N), static_cast<long>(N));
-    
-    
-    // Read biggest_num_n biggest_num_m (ignored)
-    buf = parse_digits_from_line<size_t>(f, "maximum elements", 2, false);
+    const size_t offset = generator_offset(N);
+    gf2_matrix *A = new gf2_matrix(N, offset+K);
     
-    // Read num_n
-    num_n = parse_digits_from_line<size_t>(f, "nlist count", alist_N , false);
-    
-    // Read num_m
-    num_m = parse_digits_from_line<size_t>(f, "mlist count", alist_M , false);
-    
-    // If we have to transpose, skip nlist
-    if(do_trans) {
-        for(size_t i=0; i<alist_N ;i++) {
-            buf = parse_digits_from_line<size_t>(f, "nlist", num_n[i], true);
-        }
-        num_n = num_m;
-    }
-    
-    // Now read either nlist or mlist as new nlist (num_n was updated before)
-    for(size_t i=0; i<N ;i++) {
-        buf = parse_digits_from_line<size_t>(f, "n/m-list", num_n[i], true);
-        const long i_long = static_cast<long>(i);
+    for(size_t i=0; i<N; i++) {
+        uint64_t num;
+        const uint64_t *bits = code.get_check_bits(i, &num);
         
-        for(size_t j=0; j<num_n[i]; j++) {
-            if(buf[j] <= K) {
+        for(size_t j=0; j<num; j++) {
+            if(bits[j] < K) {
                 // Entry belongs to Q matrix
-                const long Q_indx_long = static_cast<long>(buf[j]-1u);
-                Q[i_long][Q_indx_long] = 1;
+                A->set(i, offset + bits[j]);
             } else {
                 // Entry belongs to P matrix
-                const long P_indx_long = static_cast<long>(buf[j]-K-1u);
-                P[i_long][P_indx_long] = 1;
+                A->set(i, bits[j]-K);
             }
         }
     }
     
-    // If we have not transposed, read mlist now
-    if(!do_trans) {
-        for(size_t i=0; i<alist_M ;i++) {
-            buf = parse_digits_from_line<size_t>(f, "mlist", num_m[i], true);
+    // Gauss-Jordan elimination of P turns [P Q] into [I inv(P)*Q], without inverting P explicitly
+    if(!pivoting) {
+        if(!A->reduce(N, num_threads)) {
+            error("Parity part P of the parity check matrix is singular, use -p to choose other parity bits.");
         }
+        col_order->clear();
+        return A;
     }
     
-    // Read until EOF, ignore spaces and newlines
-    int c;
-    while(true) {
-        c = getc(f);
-        
-        if(c == -1) {
-            // EOF
-            break;
-        } else if( c == ' ' || c == '\n' || c == '\r' ) {
-            continue;
-        } else {
-            fprintf(stderr, "alist file contains illegal character '%c' after matrix is read in.\n", c);
-            exit( EXIT_FAILURE );
-        }
+    // Columns of Q take the place of the columns of P without pivot, every swap is tracked
+    std::vector<uint64_t> swaps(A->get_cols());
+    for(size_t i=0; i<swaps.size(); i++) {
+        swaps[i] = i;
+    }
+    if(!A->reduce(N, num_threads, swaps.data())) {
+        error("Parity check matrix has less than full rank, codes with redundant checks are not supported.");
     }
     
-    fclose(f);
-    // Reading of alist finished
-    
-    // print alist_ matrix
-    /*
-    printf("[Q | P] = \n");
+    // Information bits first, then the parity bits, like in the codeword of the generator
+    col_order->resize(M);
+    size_t num_moved = 0;
+    for(size_t k=0; k<K; k++) {
+        (*col_order)[k] = parity_check_column(swaps[offset+k], N, K);
+        num_moved += ((*col_order)[k] != k) ? 1u : 0u;
+    }
     for(size_t i=0; i<N; i++) {
-        for(size_t j=0; j<K; j++) {
-            printf("%1d ", NTL::IsOne(Q[i][j]) ? 1 : 0);
-        }
-        printf("| ");
-        for(size_t j=0; j<N; j++) {
-            printf("%1d ", NTL::IsOne(P[i][j]) ? 1 : 0);
-        }
-        printf("\n");
+        (*col_order)[K+i] = parity_check_column(swaps[i], N, K);
     }
-    //*/
     
-    NTL::Mat<NTL::GF2> Pi;
-    NTL::inv(Pi, P);
-    
-    // Free P
-    P.kill();
+    if(num_moved == 0) {
+        col_order->clear();
+    } else {
+        printf(" ... %lu parity bits exchanged for information bits\n", num_moved);
+    }
     
-    G = Pi * Q;
+    return A;
 }
 
-void write_matrix_txt(FILE *out, NTL::Mat<NTL::GF2> &G) {
-    const long N = G.NumRows();
-    const long K = G.NumCols();
+void write_matrix_txt(FILE *out, const gf2_matrix &A, size_t offset) {
+    const size_t N = A.get_rows();
+    const size_t K = A.get_cols() - offset;
     
-    for(long i=0; i<N; i++) {
-        for(long j=0; j<K; j++) {
-            fprintf(out, "%1d ", NTL::IsOne(G[i][j]) ? 1 : 0);
+    std::vector<char> line(2*K+1, ' ');
+    line[2*K] = '\n';
+    for(size_t i=0; i<N; i++) {
+        for(size_t j=0; j<K; j++) {
+            line[2*j] = A.get(i, offset+j) ? '1' : '0';
         }
-        fprintf(out, "\n");
+        fwrite(line.data(), sizeof(char), line.size(), out);
     }
 }
 
-void write_matrix_bin(FILE *out, NTL::Mat<NTL::GF2> &G) {
-    
-    // G is a NxK matrix
-    const long N = G.NumRows();
-    const long K = G.NumCols();
+/** Rows of G, laid out like in the binary form */
+std::vector<uint8_t> get_rows(const gf2_matrix &A, size_t offset) {
+    const size_t N = A.get_rows();
+    const size_t K = A.get_cols() - offset;
+    const size_t num_bytes = (K+7)/8;
     
-    if (N<0l) {
-        fprintf(stderr, "Number of rows in G is negative.\n");
-        exit( EXIT_FAILURE );
+    std::vector<uint8_t> rows(N*num_bytes, 0x00);
+    for(size_t i=0; i<N; i++) {
+        for(size_t k=0; k<K; k++) {
+            if(A.get(i, offset+k)) {
+                rows[i*num_bytes + k/8] = static_cast<uint8_t>(rows[i*num_bytes + k/8] | (0x80u >> (k%8)));
+            }
+        }
     }
+    return rows;
+}
+
+void write_matrix_bin(FILE *out, const gf2_matrix &A, size_t offset) {
     
-    if (K<0l) {
-        fprintf(stderr, "Number of columns in G is negative.\n");
-        exit( EXIT_FAILURE );
-    }
+    // G is a NxK matrix
+    const size_t N = A.get_rows();
+    const size_t K = A.get_cols() - offset;
     
     if(K%8 != 0) {
         error("Number of information bits is not a multiple of 8 bit. Cannot write binary compressed form.");
     }
-    const long num_bytes = K/8;
+    const size_t num_bytes = K/8;
     uint8_t buf[8];
-    uint8_t tmp;
     
     // Write N as 8 byte
     buf[0] = (uint8_t) (0x00000000000000FF & (N>>7*8));
@@ -246,47 +164,59 @@ void write_matrix_bin(FILE *out, NTL::Mat<NTL::GF2> &G) {
     printf("K = %lu = %2X%2X%2X%2X%2X%2X%2X%2X\n", K, buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7]);
     
     // Write byte masks
-    for(long i=0; i<N; i++) {
+    std::vector<uint8_t> row(num_bytes);
+    for(size_t i=0; i<N; i++) {
         
-        // Write mask for parity check i
-        for(long j=0; j<num_bytes; j++) {
-            
-            // Write j-th byte mask of parity check i
-            tmp = 0x00;
-            buf[0] = 0x00;
-            
-            for(uint8_t k=0; k<8; k++) {
-                if(NTL::IsOne(G[i][j*8+k])) {
-                    // if k-th bit (0:MSB, 7:LSB) is one, set it in mask
-                    
-                    // Set bit to one
-                    tmp = static_cast<uint8_t>(0x01u << (7u-k));
-                    
-                    // Toggle bit in buffer
-                    buf[0] ^= tmp;
+        // Write mask for parity check i, the k-th bit of byte j (0:MSB, 7:LSB) is column j*8+k
+        for(size_t j=0; j<num_bytes; j++) {
+            row[j] = 0x00;
+            for(size_t k=0; k<8; k++) {
+                if(A.get(i, offset + j*8+k)) {
+                    row[j] = static_cast<uint8_t>(row[j] | (0x80u >> k));
                 }
             }
-            fwrite(buf, sizeof(uint8_t), 1, out);
         }
+        fwrite(row.data(), sizeof(uint8_t), num_bytes, out);
     }
 }
 
 
 int main(int argc, char* argv[]) {
     
+    // Optional number of threads, zero uses one thread per core, and pivoting
+    uint64_t num_threads = 0;
+    bool pivoting = false;
+    while(argc >= 2) {
+        if(argc >= 3 && strcmp(argv[1], "-t") == 0) {
+            num_threads = strtoull(argv[2], NULL, 10);
+            argv[2] = argv[0];
+            argv += 2;
+            argc -= 2;
+        } else if(strcmp(argv[1], "-p") == 0) {
+            pivoting = true;
+            argv[1] = argv[0];
+            argv += 1;
+            argc -= 1;
+        } else {
+            break;
+        }
+    }
+    
     // Check number of provided arguments and print help if number is not correct.
     if(argc < 2 || argc > 4) {
-        fprintf(stdout, "Usage: %s alist_file <output_txt> <output_gen>\n\n", argv[0]);
-        fprintf(stdout, "Read parity check matrix from `alist_file`. If matrix is tall (i.e. has more rows than columns) it is transposed to always yield a NxM matrix with M >= N and K=M-N >= 0. This matrix is split into [Q P] with Q: NxK and P: NxN. The generator matrix is then found by inverting P and computing G=inv(P)*Q. The generator has dimensions NxK.\n\n");
+        fprintf(stdout, "Usage: %s [-t num_threads] [-p] alist_file <output_txt> <output_gen>\n\n", argv[0]);
+        fprintf(stdout, "Read parity check matrix from `alist_file`, which can also be a base matrix or compiled code like the library reads. If matrix is tall (i.e. has more rows than columns) it is transposed to always yield a NxM matrix with M >= N and K=M-N >= 0. This matrix is split into [Q P] with Q: NxK and P: NxN. The generator matrix G=inv(P)*Q is then found by Gauss-Jordan elimination of P in [P Q], without inverting P explicitly. The generator has dimensions NxK. The elimination uses num_threads threads, by default one per core.\n\n");
         fprintf(stdout, "The computed generator is written in ASCII format (N lines of K '0' or '1's, separated by spaces). If `output_txt` is provided, the matrix is written into this file, otherwise it is printed on stdout. The output can be read in by matlab's load command by using the '-ascii' option.\n\n");
+        fprintf(stdout, "With -p the columns of P do not have to be independent. Columns of P without pivot are exchanged for columns of Q, so other bits become parity bits. The codeword bits are then no longer in the order of the parity check matrix, their order has to be given to the decoder (see ldpc::encoder::get_column_order()). It is stored in the binary form, which is then written as compiled generator.\n\n");
         fprintf(stdout, "If `output_gen` is provided, a binary form of the generator matrix is produced and written into this file. The binary form consists of 2*8 bytes containing N and K followed by N*ceil(K/8) bytes. The first ceil(K/8) bytes belong to the first row of G, the next ceil(K/8) bytes to the second row, etc. The first byte of each row contains the first 8 columns of G, the second the next 8 columns, etc. The MSB belongs to the column with the lowest index covered by the byte. E.g: the MSB for the first byte belongs to the first column of G.\n");
         return 1;
     }
     
     // Compute generator matrix G
-    NTL::Mat<NTL::GF2> G;
     printf("Computing generator matrix\n");
-    compute_generator(G, argv[1]);
+    std::vector<uint64_t> col_order;
+    gf2_matrix *G = compute_generator(argv[1], num_threads, pivoting, &col_order);
+    const size_t offset = generator_offset(G->get_rows());
     printf(" ... complete\n\n");
     
     // Produce ASCII output
@@ -298,7 +228,7 @@ int main(int argc, char* argv[]) {
         printf("Computed ASCII generator:\n");
         out_txt = stdout;
     }
-    write_matrix_txt(out_txt, G);
+    write_matrix_txt(out_txt, *G, offset);
     if(argc >= 3) {
         fclose(out_txt);
     }
@@ -306,11 +236,21 @@ int main(int argc, char* argv[]) {
     
     // Produce binary output
     if(argc >= 4) {
-        printf("Writing binary generator to %s\n", argv[3]);
-        
-        FILE *out_bin = fopen(argv[3], "wb");
-        write_matrix_bin(out_bin, G);
-        fclose(out_bin);
+        if(col_order.empty()) {
+            printf("Writing binary generator to %s\n", argv[3]);
+            
+            FILE *out_bin = fopen(argv[3], "wb");
+            write_matrix_bin(out_bin, *G, offset);
+            fclose(out_bin);
+        } else {
+            // Only the compiled generator holds the column order
+            printf("Writing compiled generator with column order to %s\n", argv[3]);
+            
+            const std::vector<uint8_t> rows = get_rows(*G, offset);
+            ldpc::encoder::write_compiled(argv[3], G->get_rows(), G->get_cols()-offset, rows.data(), col_order.data());
+        }
         printf(" ... complete\n\n");
     }
+    
+    delete G;
 }
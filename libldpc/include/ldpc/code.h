@@ -0,0 +1,154 @@
+#ifndef __LIBLDPC_CODE_H__DEFINED__
+#define __LIBLDPC_CODE_H__DEFINED__
+
+#include <ldpc/ldpc_export.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <ldpc/ldpc.h>
+
+namespace ldpc {
+    
+    class decoder;
+    class encoder;
+    class mapped_file;
+    
+    /** Parity check matrix of an LDPC code and its Tanner graph
+     * 
+     * The code is not modified after construction, so a single instance can be shared by any number of
+     * decoders, also by decoders running in different threads. The puncturing configuration is referenced,
+     * not copied, and has to outlive the code. The punctured bits are looked up once at construction.
+     */
+    class LDPC_EXPORT code {
+        friend class decoder;
+        friend class encoder;
+        
+    private:
+        /** Number of parity checks without puncturing */
+        uint64_t N;
+        
+        /** Number of total bits without puncturing */
+        uint64_t M;
+        
+        /** Number of information bits */
+        uint64_t K;
+        
+        /** Number of edges in the Tanner graph */
+        uint64_t E;
+        
+        /** Largest number of bits connected to a single check */
+        uint64_t max_check_degree;
+        
+        /** Offset of the first edge of each check in the check-major edge order (N+1 elements) */
+        uint64_t *check_offsets;
+        
+        /** Bit index (zero based) of every edge in check-major order (E elements) */
+        uint64_t *check_edges;
+        
+        /** Offset of the first edge of each bit in the bit-major edge order (M+1 elements) */
+        uint64_t *bit_offsets;
+        
+        /** Check index (zero based) of every edge in bit-major order (E elements) */
+        uint64_t *bit_edges;
+        
+        /** Position in check-major order of every edge given in bit-major order (E elements) */
+        uint64_t *edge_b2c;
+        
+        /** Position in bit-major order of every edge given in check-major order (E elements) */
+        uint64_t *edge_c2b;
+        
+        /** Circulant size, if the parity check matrix consists of ZxZ circulant permutation matrices, zero otherwise
+         * 
+         * Check r*Z+i of block row r is connected to bit c*Z+(i+s)%Z for every nonzero block in block column c
+         * with shift s.
+         */
+        uint64_t Z;
+        
+        /** Number of block rows (N/Z) */
+        uint64_t base_rows;
+        
+        /** Offset of the first nonzero block of each block row (base_rows+1 elements, NULL if Z is zero) */
+        uint64_t *block_offsets;
+        
+        /** Block column of every nonzero block in row-major order (E/Z elements) */
+        uint64_t *block_cols;
+        
+        /** Shift of every nonzero block in row-major order (E/Z elements) */
+        uint64_t *block_shifts;
+        
+        systematic::systematic_t systype;
+        const puncturing::conf_t *punctconf;
+        
+        /** Whether each bit is punctured, zero or one (M elements) */
+        uint8_t *punctured;
+        
+        /** Bit index of every input LLR of the decoder, i.e. of every bit that is not punctured (get_num_input() elements) */
+        uint64_t *input_bits;
+        
+        /** Column of the parity check matrix of every bit (M elements), NULL if the bits are in its order */
+        uint64_t *column_order;
+        
+        /** Compiled code file the arrays point into, NULL if they have been allocated */
+        mapped_file *mapping;
+        
+        /** Whether the puncturing maps have been allocated, also if the other arrays point into mapping */
+        bool own_puncturing_maps;
+        
+    public:
+        /** Read a parity check matrix
+         * 
+         * The file is either an alist file, the base matrix of a quasi-cyclic code or a compiled code written by
+         * write_compiled(). A base matrix file starts with the line "rows cols Z", followed by rows lines of
+         * cols shifts each, -1 denotes an all-zero block. Quasi-cyclic structure of an alist file is detected
+         * automatically.
+         * 
+         * A compiled code is memory mapped and used in place, after its checksums and the ranges of its arrays
+         * have been verified. Its puncturing maps are used if they have been compiled for the same puncturing
+         * configuration, otherwise they are computed again.
+         * 
+         * If column_order is given, bit i of the code is column column_order[i] of the parity check matrix,
+         * like the codeword bits of a generator with encoder::get_column_order(). The bits are renumbered once
+         * here, so decoding takes no extra time. A compiled code keeps the order it was written with,
+         * ldpc_compile_code -o writes it in the order of a generator.
+         */
+        code(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, const uint64_t *column_order=NULL);
+        ~code();
+        
+        /** Write the Tanner graph and the puncturing maps in the compiled format, see code_compiled.cpp */
+        void write_compiled(const char *file) const;
+        
+        uint64_t get_num_input(void) const;
+        uint64_t get_num_output(void) const;
+        
+        /** Number of bits without puncturing */
+        uint64_t get_num_bits(void) const;
+        
+        /** Number of parity checks */
+        uint64_t get_num_checks(void) const;
+        
+        /** Circulant size of a quasi-cyclic code, zero if the code has no such structure */
+        uint64_t get_circulant_size(void) const;
+        
+        /** Bits connected to check check_indx, *num zero based bit indices */
+        const uint64_t* get_check_bits(uint64_t check_indx, uint64_t *num) const;
+        
+    private:
+        void parse_alist(const char* alist_file);
+        void parse_base_matrix(const char* qc_file);
+        void parse_numbers_from_file(uint64_t *ret, FILE *f, const char *line_descr, uint64_t num, bool ignore_zeros);
+        void parse_shifts_from_file(int64_t *ret, FILE *f, const char *line_descr, uint64_t num);
+        void parse_end_of_file(FILE *f, const char *file_descr);
+        bool is_base_matrix_file(const char* file) const;
+        bool is_compiled_file(const char* file) const;
+        bool map_compiled(const char* file); // Point the arrays into a compiled code, returns whether its puncturing maps match
+        bool valid_compiled(uint64_t num_blocks, uint64_t num_punct, const uint64_t *input_bits, const uint64_t *punct_pos, const uint8_t *flags) const; // Whether the mapped arrays are in range and consistent
+        void detect_quasi_cyclic(void);
+        bool find_blocks(uint64_t circulant_size);
+        void build_graph_from_blocks(void);
+        void apply_column_order(const uint64_t *column_order);
+        void build_edge_permutation(void);
+        void build_puncturing_maps(void);
+        void get_output_range(uint64_t *first, uint64_t *last) const; // Return range of bits given to the output
+    };
+}
+
+#endif /* __LIBLDPC_CODE_H__DEFINED__ */
@@ -5,58 +5,299 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <ldpc/ldpc.h>
+#include <ldpc/code.h>
 #include <string>
 
-/** Maximum number of decoding iterations before decoding failure is declared */
+/** Default maximum number of decoding iterations before decoding failure is declared, see stopping::conf_t */
 #define DECODER_MAX_ITERATIONS 1000
 
-/** Maximum number of iterations until the AWRM has to reach a new minimum or the codeword is considered undecodable
+/** Default maximum number of iterations until the AWRM has to reach a new minimum or the codeword is considered undecodable
  * 
  * Set to DECODER_MAX_ITERATIONS or larger to disable early return due to AWRM heuristic
  */
 #define DECODER_MAX_AWRM_ITERATIONS 25
 
-/** Minimum LLR magnitude to consider bit defined
+/** Number of fractional bits of the fixed point sums of the AWRM
+ * 
+ * The AWRM is updated incrementally whenever a check changes between satisfied and unsatisfied. Integer sums
+ * make the metric independent of the order of these updates, so equal syndromes yield equal metrics.
+ */
+#define DECODER_AWRM_FRAC_BITS 32
+
+/** Default minimum LLR magnitude to consider bit defined
  * 
  * LLRs with lower abs value are considered undefined and will always generate a positive syndrome. Consequently the output LLRs of the decoder will all have a magnitude greater than this value if decoding is succesfull.
  */
 #define DECODER_MIN_LLR_MAG 0.000001f
 
+/** Default scaling factor of the normalized min-sum check node update */
+#define DECODER_MINSUM_SCALE 0.75f
+
+/** Default offset of the offset min-sum check node update */
+#define DECODER_MINSUM_OFFSET 0.15f
+
+/** Default resolution (table entries per octave of the LLR magnitude) of the phi table of SUM_PRODUCT_PHI */
+#define DECODER_PHI_STEPS 64.0f
+
+/** Largest resolution of the phi table, which has 24 octaves */
+#define DECODER_PHI_MAX_STEPS 4096.0f
+
+/** Default resolution (steps per LLR unit) and largest channel LLR magnitude of 16 bit quantized decoding */
+#define DECODER_QUANT_INT16_SCALE 256.0f
+#define DECODER_QUANT_INT16_CLIP 8191
+
+/** Default resolution (steps per LLR unit) and largest channel LLR magnitude of 8 bit quantized decoding */
+#define DECODER_QUANT_INT8_SCALE 4.0f
+#define DECODER_QUANT_INT8_CLIP 15
+
+/** Number of checks the layered schedule processes between two checks of the time limit of decode() */
+#define DECODER_DEADLINE_CHECKS 64
+
+/** Number of least reliable bits decode_guess() guesses at most, one per level of the guess tree */
+#define DECODER_GUESS_MAX_DEPTH 8
+
+/** Number of guess tree branches decode_guess() follows to the next level, the most promising ones first */
+#define DECODER_GUESS_BEAM 4
+
+/** Number of threads decode_guess() decodes the guesses of a level on, zero for one per hardware thread */
+#define DECODER_GUESS_THREADS 0
+
+/** Default order of decode_osd(), i.e. the largest number of information bits flipped in a test pattern */
+#define DECODER_OSD_ORDER 2
+
+/** Number of least reliable information bits the test patterns of decode_osd() flip, zero for all */
+#define DECODER_OSD_WINDOW 128
+
+/** Resolution of the bit reliabilities decode_osd() compares test patterns with */
+#define DECODER_OSD_WEIGHT_BITS 12
+
 namespace ldpc {
     
+    namespace checknode {
+        /** Algorithm used to compute the messages from check nodes to bit nodes
+         * 
+         * SUM_PRODUCT is the exact belief propagation update. The min-sum variants approximate it by the
+         * smallest magnitude of all other incoming messages, NORMALIZED_MIN_SUM scales and OFFSET_MIN_SUM
+         * reduces this magnitude to compensate for the overestimation of the approximation.
+         * 
+         * SUM_PRODUCT_PHI computes the sum-product update with phi(x) = -ln(tanh(x/2)), which is its own
+         * inverse: the magnitude of every message is phi of the sum of phi of all other incoming magnitudes.
+         * phi is read from a table, so a check of degree d takes d additions and 2*d lookups. The table
+         * quantizes the magnitudes logarithmically, outgoing magnitudes are limited to about 14.6 natural LLRs.
+         */
+        enum algorithm_t { SUM_PRODUCT=0, MIN_SUM=1, NORMALIZED_MIN_SUM=2, OFFSET_MIN_SUM=3, SUM_PRODUCT_PHI=4 };
+    }
+    
+    namespace schedule {
+        /** Order in which the messages are updated during one iteration
+         * 
+         * FLOODING updates all bit nodes and afterwards all check nodes. LAYERED processes one check after
+         * the other and updates the posterior LLRs of the connected bits immediately, so later checks of
+         * the same iteration already use the new information.
+         */
+        enum schedule_t { FLOODING=0, LAYERED=1 };
+    }
+    
+    namespace quantization {
+        /** Representation of the LLRs inside the decoder
+         * 
+         * FLOAT decodes with softbit_t. INT16 and INT8 decode with saturating fixed point LLRs, which fit
+         * more frames into a SIMD register. Input LLRs are multiplied with the scale, rounded and clipped,
+         * the output is converted back to softbit_t. Only the min-sum variants support fixed point.
+         */
+        enum type_t { FLOAT=0, INT16=1, INT8=2 };
+    }
+    
+    namespace stopping {
+        /** Criteria that end the decoding of a frame
+         * 
+         * Decoding always ends once all syndromes are fulfilled or max_iterations have been run. The AWRM and
+         * LLR change criteria give up early on frames that are unlikely to be decoded, syndrome_only disables
+         * both. The defaults are given by the DECODER_* defines.
+         */
+        class LDPC_EXPORT conf_t {
+        public:
+            /** Largest number of iterations */
+            uint64_t max_iterations;
+            
+            /** Iterations until the AWRM has to reach a new minimum, max_iterations or larger disables the criterion */
+            uint64_t max_awrm_iterations;
+            
+            /** Minimum LLR magnitude to consider a bit defined */
+            softbit_t min_llr_mag;
+            
+            /** Stop once the average absolute change of the posterior LLRs in one iteration is not larger, negative disables
+             * 
+             * decode_batch() and fixed point decode() only stop on unchanged LLRs, i.e. treat every threshold
+             * that is not negative as zero.
+             */
+            softbit_t min_llr_delta;
+            
+            /** Only evaluate the syndromes, max_iterations and max_time_us */
+            bool syndrome_only;
+            
+            /** Largest decoding time of a frame in microseconds, zero disables
+             * 
+             * The floating point decode() checks the time after every iteration and, with the layered schedule,
+             * every DECODER_DEADLINE_CHECKS checks. Once it has passed, the posterior LLRs of the iteration
+             * with the fewest unsatisfied checks are returned and DEADLINE is set. Fixed point decode() and
+             * decode_batch() check the time after every iteration and return the last posterior LLRs,
+             * decode_batch() applies the limit to every group of frames decoded in lockstep.
+             */
+            uint64_t max_time_us;
+            
+            /** Default criteria */
+            conf_t(void);
+        };
+    }
+    
+    namespace approx {
+        struct phi_table_t;
+    }
+    
+    namespace batch {
+        struct graph_t;
+        struct conf_t;
+        template<typename T> struct work_t;
+    }
+    
     class LDPC_EXPORT decoder {
     private:
-        class LDPC_EXPORT check_node;
-        class LDPC_EXPORT bit_node;
         class LDPC_NO_EXPORT guess_tree;
-
-        /** Number of parity checks without puncturing */
-        uint64_t N;
+        struct guess_task_t;
         
-        /** Number of total bits without puncturing */
-        uint64_t M;
+        struct llrsum_t {
+            /** Counter for infinite terms.
+             * 
+             * If negative there are more -inf terms in the sum than +inf. If zero, there are either
+             * equal ammounts of positive and negative infinity terms in the sum, or none at all.
+             */
+            int inf_count;
+            
+            /** Sum of finite sum elements */
+            softbit_t fin_sum;
+        };
         
-        /** Number of information bits */
-        uint64_t K;
+        /** Code this decoder works on, shared with other decoders */
+        const code *graph;
         
-        uint64_t *nlist_num;
-        uint64_t *mlist_num;
-        uint64_t **nlist;
-        uint64_t **mlist;
+        /** Whether the code has been created by the decoder and has to be deleted with it */
+        bool own_graph;
         
-        systematic::systematic_t systype;
-        puncturing::conf_t *punctconf;
-
-        check_node **check_nodes;
-        bit_node **bit_nodes;
+        /** Channel LLR of every bit, zero for punctured bits (M elements) */
+        softbit_t *channel;
+        
+        /** Posterior LLR estimate of every bit, including all check messages (M elements) */
+        softbit_t *posterior;
+        
+        /** Messages from bit to check nodes in check-major order (E elements) */
+        softbit_t *msg_b2c;
+        
+        /** Messages from check to bit nodes in bit-major order (E elements) */
+        softbit_t *msg_c2b;
+        
+        /** Posterior LLR sums of the layered schedule (M elements) */
+        llrsum_t *posterior_sum;
+        
+        /** Scratch buffer for a single check node update (2*max_check_degree elements) */
+        softbit_t *check_buf;
+        
+        /** Check node update algorithm */
+        checknode::algorithm_t algorithm;
+        
+        /** Scale or offset of the min-sum variants, table resolution of SUM_PRODUCT_PHI, ignored otherwise */
+        softbit_t algorithm_param;
+        
+        /** Table of SUM_PRODUCT_PHI, NULL for other algorithms */
+        approx::phi_table_t *phi_table;
+        
+        /** Message update schedule */
+        schedule::schedule_t sched;
+        
+        /** Logarithm of the input, output and message LLRs */
+        llr::domain_t domain;
+        
+        /** Natural LLR units per LLR unit of the domain, see get_llr_nats() */
+        softbit_t llr_nats;
         
         softbit_t *bits_last_it;
         
+        /** Posterior LLRs of the iteration with the fewest unsatisfied checks so far, only kept with a time limit (M elements) */
+        softbit_t *best_posterior;
+        
+        /** Time stamp counter value the current frame has to be decoded by, zero for none (see timing.h) */
+        uint64_t deadline;
+        
+        /** Hard decision of every bit during decode(), see update_syndrome() (M elements) */
+        uint8_t *bit_hard;
+        
+        /** Parity of the negative bits of every check (N elements) */
+        uint8_t *check_parity;
+        
+        /** Number of undefined bits of every check, the check is unsatisfied while it is nonzero (N elements) */
+        uint64_t *check_undef;
+        
+        /** Number of unsatisfied checks */
+        uint64_t num_unsatisfied;
+        
+        /** Channel reliability |tanh(y_k/2)| of every bit k with its natural channel LLR y_k (M elements) */
+        softbit_t *bit_weight;
+        
+        /** Sum of the channel reliabilities w_ij of all bits of every check, fixed point (N elements)
+         * 
+         * w_ij is the smallest reliability of all other bits k of check j. The weights depend on the channel
+         * only and are computed once per frame.
+         */
+        int64_t *check_weight;
+        
+        /** AWRM of the current syndrome times M, fixed point */
+        int64_t awrm_sum;
+        
+        /** LLR representation of the min-sum decoders */
+        quantization::type_t quant;
+        
+        /** Fixed point steps per LLR unit */
+        softbit_t quant_scale;
+        
+        /** Largest fixed point magnitude of a channel LLR */
+        uint64_t quant_clip;
+        
+        /** Stopping criteria */
+        stopping::conf_t stop;
+        
+        /** Lane-wise interleaved memory of decode_batch() for each LLR representation, allocated on first use */
+        batch::work_t<softbit_t> *batch_work;
+        batch::work_t<int16_t> *batch_work_i16;
+        batch::work_t<int8_t> *batch_work_i8;
+        
+        /** Memory of fixed point decode() calls, allocated on first use */
+        batch::work_t<int16_t> *single_work_i16;
+        batch::work_t<int8_t> *single_work_i8;
+        
+        /** Decoders of the additional threads of decode_guess(), allocated on first use */
+        decoder **guess_decoders;
+        uint64_t num_guess_decoders;
+        
     public:
-        decoder(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf);
+        /** Create decoder from a parity check matrix
+         * 
+         * The file is read into a code owned by this decoder, see code::code() for the supported formats.
+         * decode_batch() and fixed point decode() process quasi-cyclic codes with the layered schedule one
+         * block row at a time. column_order is passed on to the code, for codewords of generators that have
+         * been computed with permuted columns.
+         */
+        decoder(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, const uint64_t *column_order=NULL);
+        
+        /** Create decoder for a shared code
+         * 
+         * Only the message memory and the decoding parameters belong to the decoder, so one decoder per
+         * thread can be created cheaply for the same code. The code has to outlive the decoder.
+         */
+        decoder(const code *c);
+        
         ~decoder();
         
-        enum fail_t : uint8_t { NONE=0x00, MAX_ITERATIONS=(0x01<<0), AWRM_STOP=(0x01<<1), NO_SOFTBITS_CHANGE=(0x01<<2) };
+        enum fail_t : uint8_t { NONE=0x00, MAX_ITERATIONS=(0x01<<0), AWRM_STOP=(0x01<<1), NO_SOFTBITS_CHANGE=(0x01<<2), DEADLINE=(0x01<<3) };
         
         struct metadata_t {
             /** Number of decoding iterations */
@@ -65,7 +306,11 @@ namespace ldpc {
             /** Whether or not decoding was successful */
             bool success;
             
-            /** Flags to indicate failure reason(s) from the fail_t enum */
+            /** Flags to indicate failure reason(s) from the fail_t enum
+             * 
+             * Flags are only set for frames with unsatisfied checks. A frame whose checks are all satisfied in the
+             * last allowed iteration has been decoded successfully, without MAX_ITERATIONS.
+             */
             uint8_t failure_flags;
             
             /** Number of violated syndrome elements */
@@ -95,18 +340,145 @@ namespace ldpc {
         uint64_t get_num_input(void) const;
         uint64_t get_num_output(void) const;
         
-        bool decode(softbit_t *out, const softbit_t *input, metadata_t *metadata=NULL, const char *debugout=NULL); // decode K bits from M inputs
-        bool decode_guess(softbit_t *out, const softbit_t *input, metadata_t *metadata=NULL, const char *debugprefix=NULL); // decode K bits from M inputs
+        /** Circulant size of a quasi-cyclic code, zero if the code has no such structure */
+        uint64_t get_circulant_size(void) const;
+        
+        /** Select check node update algorithm with its default scale/offset */
+        void set_algorithm(checknode::algorithm_t algorithm);
+        
+        /** Select check node update algorithm
+         * 
+         * param is the scaling factor for NORMALIZED_MIN_SUM, the offset for OFFSET_MIN_SUM, the number of
+         * phi table entries per octave for SUM_PRODUCT_PHI (a power of two) and ignored otherwise.
+         */
+        void set_algorithm(checknode::algorithm_t algorithm, softbit_t param);
+        
+        /** Select message update schedule */
+        void set_schedule(schedule::schedule_t sched);
+        
+        /** Select the logarithm of the LLRs decode() takes and returns, LOG10 by default
+         * 
+         * The sum-product update works on natural LLRs, with LOG10 every message is converted on the way in
+         * and out of a check. All thresholds and min-sum parameters are given in LLRs of this domain.
+         */
+        void set_domain(llr::domain_t domain);
+        
+        llr::domain_t get_domain(void) const;
+        
+        /** Select LLR representation with its default scale and clipping */
+        void set_quantization(quantization::type_t type);
+        
+        /** Select LLR representation
+         * 
+         * scale is the number of fixed point steps per LLR unit and clip the largest magnitude of a quantized
+         * channel LLR. Both are ignored for FLOAT. clip has to leave headroom below the largest value of the
+         * type, since messages saturate there.
+         */
+        void set_quantization(quantization::type_t type, softbit_t scale, uint64_t clip);
+        
+        /** Select the criteria that end decoding, applies to all following decode() and decode_batch() calls
+         * 
+         * The criteria can be changed between any two calls, e.g. to reduce the number of iterations while
+         * frames queue up.
+         */
+        void set_stopping(const stopping::conf_t &stop);
+        
+        /** Current stopping criteria */
+        const stopping::conf_t& get_stopping(void) const;
+        
+        /** Exit with an error message if the stopping criteria are invalid */
+        static void check_stopping(const stopping::conf_t &stop);
+        
+        /** Decode K bits from M inputs
+         * 
+         * With fixed point quantization and a min-sum algorithm, the frame is decoded by the fixed point
+         * kernel. It does not evaluate the AWRM criterion and does not write debugout.
+         */
+        bool decode(softbit_t *out, const softbit_t *input, metadata_t *metadata=NULL, const char *debugout=NULL);
+        
+        /** Decode several frames of this code at once
+         * 
+         * The frames are interleaved lane-wise and decoded in lockstep with the widest SIMD instruction set
+         * supported by the CPU, the environment variable LDPC_SIMD (generic, avx2 or avx512) limits the choice.
+         * Frames leave the group as soon as their syndrome is fulfilled or their LLRs stop changing. The AWRM
+         * criterion is not evaluated and infinite input LLRs are clipped to a large finite value. Only the
+         * min-sum variants are vectorized, with the sum-product updates the frames are decoded one after the
+         * other by decode(). Fixed point quantization increases the number of frames per group.
+         * 
+         * out, input and metadata (if not NULL) are arrays of num_frames elements, each entry in out and
+         * input points to the buffer of a single frame as used by decode(). Returns true if all frames have
+         * been decoded successfully.
+         */
+        bool decode_batch(softbit_t **out, const softbit_t * const *input, uint64_t num_frames, metadata_t *metadata=NULL);
+        
+        /** Number of frames decode_batch() processes in lockstep on this CPU with the current quantization */
+        uint64_t get_batch_lanes(void) const;
+        
+        /** Decode a frame like decode() and guess unreliable bits if that fails
+         * 
+         * If belief propagation fails, the DECODER_GUESS_MAX_DEPTH bits with the smallest posterior magnitude
+         * are fixed one after the other to an infinite LLR of either sign and the frame is decoded again. A
+         * guess that reduces the number of unsatisfied checks is refined with the next bit, at most
+         * DECODER_GUESS_BEAM guesses per level. The guesses of a level are independent and decoded in
+         * parallel on DECODER_GUESS_THREADS threads. The first guess that yields a codeword is returned,
+         * otherwise the result of plain belief propagation.
+         * 
+         * The frame is always decoded in floating point. metadata->num_guesses is the number of guesses
+         * decoded, the other fields describe the returned result. With debugprefix every decoding attempt is
+         * written to its own debug file (see decode()), starting with debugprefix and numbered from zero, and
+         * the guesses are decoded on the calling thread only.
+         */
+        bool decode_guess(softbit_t *out, const softbit_t *input, metadata_t *metadata=NULL, const char *debugprefix=NULL);
+        
+        /** Decode a frame like decode() and post-process failures with ordered statistics decoding
+         * 
+         * If belief propagation fails, its posterior LLRs are sorted by magnitude and the parity check matrix is
+         * brought to reduced row echelon form with the pivots in the least reliable columns. The remaining,
+         * most reliable bits form an information set. Their hard decisions and every test pattern that flips
+         * up to order of the DECODER_OSD_WINDOW least reliable ones are re-encoded, the codeword closest to
+         * the posterior LLRs is returned with the sign of each output LLR set to its codeword bit.
+         * 
+         * The frame is always decoded in floating point. metadata->num_guesses is the number of test patterns
+         * evaluated and metadata->syndrome_count refers to the returned codeword.
+         */
+        bool decode_osd(softbit_t *out, const softbit_t *input, metadata_t *metadata=NULL, uint64_t order=DECODER_OSD_ORDER);
         
     private:
-        void parse_alist(const char* alist_file);
-        void parse_numbers_from_file(uint64_t *ret, FILE *f, const char *line_descr, uint64_t num, bool ignore_zeros);
+        void init_workspace(void);
+        void load_channel(const softbit_t *input); // Copy input LLRs to the channel LLRs, punctured bits get zero
+        bool decode_channel(softbit_t *out, metadata_t *meta, const char *debugout); // Floating point belief propagation of the channel LLRs
+        void decode_guess_task(guess_task_t *task, const softbit_t *base_channel, const char *debugout); // Decode a guess of decode_guess()
+        template<typename T> bool decode_lanes(softbit_t **out, const softbit_t * const *input, uint64_t num_frames, metadata_t *meta, void (*kernel)(const batch::graph_t*, const batch::conf_t*, batch::work_t<T>*), uint64_t lanes, batch::work_t<T> **work);
         bool get_syndrome(const uint64_t check_indx, bool *defined=NULL) const;
-        uint64_t get_syndrome_count(void) const;
+        void reset_syndrome(void);
+        void update_syndrome(const uint64_t bit_indx, const softbit_t value);
+        bool is_unsatisfied(const uint64_t check_indx) const;
+        void verify_syndrome(void) const; // Compare the incremental syndrome and AWRM with a full recomputation
         double get_awrm(void) const;
+        softbit_t get_final_value(const uint64_t bit_indx) const; // Return posterior estimate of a bit. Throws an error if not computed yet.
+        void update_bits(void); // Compute all bit to check messages and the posterior estimates
+        void update_checks(void); // Compute all check to bit messages
+        void update_check(const uint64_t check_indx); // Compute check to bit messages of a single check
+        void update_layered(void); // Process all checks one after the other and update the posterior estimates
+        void update_check_sum_product(const uint64_t check_indx);
+        void update_check_min_sum(const uint64_t check_indx);
+        void update_check_phi(const uint64_t check_indx);
+        bool is_sum_product(void) const; // Whether the algorithm is one of the sum-product updates, which are not vectorized
         softbit_t llrdiff(const softbit_t a, softbit_t b) const;
         void debug_check(const uint64_t check_indx);
         
+        /** Set LLR sum to zero */
+        static void llrsum_reset(llrsum_t *l);
+        
+        /** Add softbit to sum */
+        static void llrsum_add(llrsum_t *l, softbit_t val);
+        
+        /** Remove softbit, that has been added before, from sum */
+        static void llrsum_sub(llrsum_t *l, softbit_t val);
+        
+        /** Return sum as softbit */
+        static softbit_t llrsum_get(const llrsum_t *l);
+    
     };
     
     class LDPC_NO_EXPORT decoder::guess_tree {
@@ -123,74 +495,26 @@ namespace ldpc {
         bool pref_pos;
         enum result_t { PENDING=0, WORSE=1, BETTER=2, SUCCESS=3 };
         
+        /** Result of fixing the bit to the preferred sign (0) and the other sign (1) */
         result_t results[2];
         
+        /** Result index of the parent this node refines, i.e. the value the bit of the parent is fixed to */
+        uint8_t branch;
+        
+        /** Number of unsatisfied checks of the guess this node refines */
+        uint64_t syndrome_count;
+        
         uint64_t traverse_counter;
         
         guess_tree(guess_tree *parent, uint64_t guess_pos, bool pref_pos, uint64_t max_children=0);
         ~guess_tree(void);
         
-        void add_child(uint64_t guess_pos, bool pref_pos, uint64_t max_children=0);
+        guess_tree* add_child(uint64_t guess_pos, bool pref_pos, uint64_t max_children=0);
         guess_tree* traverse(void);
         void reset_traverse(void);
         std::string get_str(void);
     };
-    
-    class LDPC_EXPORT decoder::check_node {
-    public:
-        const uint64_t NUM_BITS;
-        softbit_t *bit_values_tanh;
-        uint64_t tmp_indx;
-        
-        check_node(const uint64_t NUM_BITS);
-        ~check_node(void);
-        
-        softbit_t computeValForMessage(uint64_t indx) const;
-        void new_round(void); // Reset node to new round of value inputs
-        void set_bit_value(softbit_t val); // Set a new bit value at tmp_indx
-    };
-    
-    class LDPC_EXPORT decoder::bit_node {
-    public:
-        const uint64_t NUM_CHECKS;
-        softbit_t *check_values;
-        softbit_t channel_value;
-        softbit_t final_value;
-        uint64_t tmp_indx;
-        
-        bit_node(const uint64_t NUM_CHECKS);
-        ~bit_node(void);
-        
-        void reset(softbit_t channel_val); // Reset decoder to decode new message
-        void new_round(void); // Reset node to new round of value inputs
-        void set_check_value(softbit_t val); // Set a new check value at tmp_indx
-        softbit_t get_buffered_final_value(void) const; // Return buffered final estimate (include all check-nodes. Throws an error is not computed yet.
-        
-        softbit_t computeValForCheck(uint64_t indx, bool final); // Compute probability (LLR) that bit should be one, based on all check node informations, but the one indicated by indx. In the final iteration all check messages are considered and indx is ignored
-        
-    private:
-        struct llrsum_t {
-            /** Counter for infinite terms.
-             * 
-             * If negative there are more -inf terms in the sum than +inf. If zero, there are either
-             * equal ammounts of positive and negative infinity terms in the sum, or none at all.
-             */
-            int inf_count;
-            
-            /** Sum of finite sum elements */
-            softbit_t fin_sum;
-        };
-        
-        /** Set LLR sum to zero */
-        void llrsum_reset(llrsum_t *l) const;
-        
-        /** Add softbit to sum */
-        void llrsum_add(llrsum_t *l, softbit_t val) const;
-        
-        /** Return sum as softbit */
-        softbit_t llrsum_get(llrsum_t *l) const;
-    };
-    
+
 }
 
 #endif /* __LIBLDPC_DECODER_H__DEFINED__ */
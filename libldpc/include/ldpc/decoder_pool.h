@@ -0,0 +1,164 @@
+#ifndef __LIBLDPC_DECODER_POOL_H__DEFINED__
+#define __LIBLDPC_DECODER_POOL_H__DEFINED__
+
+#include <ldpc/ldpc_export.h>
+#include <stdint.h>
+#include <ldpc/ldpc.h>
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace ldpc {
+    
+    /** Decodes independent frames of a single code on several worker threads
+     *
+     * Every worker owns a decoder created from the shared code and a queue of frames. Frames are distributed
+     * over the queues round robin, a worker whose queue runs empty takes frames from the back of the other
+     * queues. With ordered delivery, the results of every stream are delivered in the order the frames have
+     * been submitted, otherwise as soon as they are decoded.
+     */
+    class LDPC_EXPORT decoder_pool {
+    public:
+        /** Called from a worker thread with the output buffer and metadata of a decoded frame */
+        typedef void (*callback_t)(void *user, softbit_t *out, const decoder::metadata_t *meta);
+        
+    private:
+        struct job_t;
+        struct queue_t;
+        
+        /** Delivery state of a stream with ordered delivery */
+        struct stream_t {
+            /** Sequence number of the next frame submitted to the stream */
+            uint64_t next_submit;
+            
+            /** Sequence number of the next frame to be delivered */
+            uint64_t next_deliver;
+            
+            /** Whether a worker is currently delivering frames of this stream */
+            bool delivering;
+            
+            /** Decoded frames waiting for earlier frames of the stream, by sequence number */
+            std::map<uint64_t, job_t*> done;
+        };
+        
+        const code *graph;
+        bool ordered;
+        
+        uint64_t num_threads;
+        std::thread *threads;
+        
+        /** Decoder of every worker */
+        decoder **decoders;
+        
+        /** Frame queue of every worker */
+        queue_t *queues;
+        
+        /** Queue the next frame is added to */
+        std::atomic<uint64_t> next_queue;
+        
+        /** Frames waiting in any queue */
+        std::atomic<uint64_t> num_queued;
+        
+        /** Frames submitted, decoded and delivered since creation */
+        std::atomic<uint64_t> num_submitted;
+        std::atomic<uint64_t> num_decoded;
+        std::atomic<uint64_t> num_delivered;
+        
+        /** Idle workers wait for new frames or the shutdown */
+        std::mutex idle_mutex;
+        std::condition_variable idle_cond;
+        bool stopping;
+        
+        /** wait() waits for the delivery of all submitted frames */
+        std::mutex done_mutex;
+        std::condition_variable done_cond;
+        
+        /** Streams of the ordered delivery */
+        std::mutex order_mutex;
+        std::map<uint64_t, stream_t> streams;
+        
+        std::chrono::steady_clock::time_point start_time;
+        
+        /** Stopping criteria of newly submitted frames */
+        std::mutex stop_mutex;
+        stopping::conf_t stop;
+        
+    public:
+        /** Create pool with num_threads workers for a shared code
+         *
+         * A num_threads of zero starts one worker per hardware thread. The code has to outlive the pool.
+         */
+        decoder_pool(const code *c, uint64_t num_threads=0, bool ordered=false);
+        
+        /** Wait for all submitted frames, then stop the workers */
+        ~decoder_pool();
+        
+        /** Select check node update algorithm of all workers, see decoder::set_algorithm()
+         *
+         * The decoding parameters may only be changed while no other thread submits frames. Frames submitted
+         * before are decoded with the previous parameters.
+         */
+        void set_algorithm(checknode::algorithm_t algorithm);
+        void set_algorithm(checknode::algorithm_t algorithm, softbit_t param);
+        
+        /** Select message update schedule of all workers, see decoder::set_schedule() */
+        void set_schedule(schedule::schedule_t sched);
+        
+        /** Select the logarithm of the LLRs of all workers, see decoder::set_domain() */
+        void set_domain(llr::domain_t domain);
+        
+        /** Select LLR representation of all workers, see decoder::set_quantization() */
+        void set_quantization(quantization::type_t type);
+        void set_quantization(quantization::type_t type, softbit_t scale, uint64_t clip);
+        
+        /** Select the stopping criteria of all frames submitted from now on, see decoder::set_stopping()
+         * 
+         * Unlike the other parameters, the criteria can be changed at any time without waiting for the queued
+         * frames, e.g. to reduce the number of iterations while the queue depth grows. The time limit
+         * max_time_us counts from the submission of a frame, so it includes the time spent in the queue.
+         */
+        void set_stopping(const stopping::conf_t &stop);
+        
+        /** Queue a frame for decoding and call callback once it has been decoded
+         *
+         * input has get_num_input() and out get_num_output() elements as for decoder::decode(), both have to
+         * stay valid until the callback returns. The callback runs in a worker thread and may submit further
+         * frames.
+         */
+        void submit(softbit_t *out, const softbit_t *input, callback_t callback, void *user, uint64_t stream=0);
+        
+        /** Queue a frame for decoding, the future holds the metadata once it has been decoded */
+        std::future<decoder::metadata_t> submit(softbit_t *out, const softbit_t *input, uint64_t stream=0);
+        
+        /** Wait until all frames submitted so far have been delivered */
+        void wait(void);
+        
+        uint64_t get_num_input(void) const;
+        uint64_t get_num_output(void) const;
+        uint64_t get_num_threads(void) const;
+        
+        /** Number of frames waiting for a worker */
+        uint64_t get_queue_depth(void) const;
+        
+        /** Number of frames decoded since the pool has been created */
+        uint64_t get_num_decoded(void) const;
+        
+        /** Average number of decoded frames per second since the pool has been created */
+        double get_throughput(void) const;
+        
+    private:
+        void enqueue(job_t *job);
+        job_t* take_job(uint64_t worker_indx);
+        void run_worker(uint64_t worker_indx);
+        void finish(job_t *job);
+        void deliver(job_t *job);
+    };
+}
+
+#endif /* __LIBLDPC_DECODER_POOL_H__DEFINED__ */
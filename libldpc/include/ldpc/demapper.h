@@ -0,0 +1,117 @@
+#ifndef __LIBLDPC_DEMAPPER_H__DEFINED__
+#define __LIBLDPC_DEMAPPER_H__DEFINED__
+
+#include <ldpc/ldpc_export.h>
+#include <stdint.h>
+#include <ldpc/ldpc.h>
+
+/** Largest number of bits per symbol of a demapper, i.e. constellations of up to 256 points */
+#define DEMAPPER_MAX_BITS 8
+
+namespace ldpc {
+    
+    namespace modulation {
+        /** Constellation of a demapper, all with unit average energy and Gray labels
+         *
+         * The label bits of a symbol are sent MSB first, like the bits of the encoder output. BPSK sends
+         * bit 0 as +1 and bit 1 as -1 on a real channel. QPSK sends its first bit on I and its second bit on Q,
+         * each like BPSK scaled by 1/sqrt(2). PSK8 sends label k^(k>>1) at angle k*pi/4. CUSTOM constellations,
+         * e.g. APSK, are given point by point.
+         */
+        enum modulation_t { BPSK=0, QPSK=1, PSK8=2, CUSTOM=3 };
+    }
+    
+    namespace demapping {
+        /** Computation of the LLRs of constellations with more than two points per dimension
+         *
+         * EXACT sums the likelihoods of all points with a given bit value. MAX_LOG only takes the most likely
+         * point of either value, which turns the sums into comparisons of linear metrics and vectorizes across
+         * symbols. BPSK and QPSK have the same LLRs with both methods, they are a single multiplication.
+         */
+        enum demapping_t { MAX_LOG=0, EXACT=1 };
+    }
+    
+    /** Soft demapper, converts received samples into the input LLRs of a decoder
+     *
+     * Samples are given as I and Q interleaved, one complex sample per symbol, except for BPSK which takes
+     * one real sample per symbol. They have to be scaled to the constellation, noise_variance is the variance
+     * of the noise in each of I and Q. The LLRs are written in the domain selected with set_domain(), decimal
+     * by default like prob2llr(), the bits of consecutive symbols one after the other, which is the layout decode() and
+     * decode_batch() expect for every frame.
+     *
+     * The vectorized kernels are selected at runtime for the instruction set of the CPU. A demapper is not
+     * modified by demap(), so it can be shared by several threads.
+     */
+    class LDPC_EXPORT demapper {
+    private:
+        modulation::modulation_t modtype;
+        demapping::demapping_t method;
+        
+        uint64_t bits;
+        uint64_t num_points;
+        
+        /** Metric coefficients of every point (3*num_points elements)
+         *
+         * With the point x, the metric of a sample y is 2*Re(y*conj(x)) - |x|^2, so the coefficients of I, Q
+         * and the constant are 2*Re(x), 2*Im(x) and -|x|^2. Metrics do not depend on the noise variance, the
+         * difference of two of them is scaled to an LLR.
+         */
+        softbit_t *points;
+        
+        softbit_t noise_variance;
+        llr::domain_t domain;
+        
+        /** LLR per unit of metric difference, 1/(2*noise_variance) natural LLRs converted into the domain */
+        softbit_t scale;
+        
+        /** Amplitude of BPSK and QPSK in each dimension, their LLR is 4*amplitude*scale times the sample */
+        softbit_t amplitude;
+        
+        void (*scale_kernel)(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor);
+        void (*max_log_kernel)(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale);
+        
+    public:
+        /** Create a demapper for one of the predefined constellations */
+        demapper(modulation::modulation_t modtype, softbit_t noise_variance, demapping::demapping_t method=demapping::MAX_LOG);
+        
+        /** Create a demapper for a CUSTOM constellation of 2^bits points
+         *
+         * points holds I and Q of the point with label s at 2*s and 2*s+1. It is copied.
+         */
+        demapper(uint64_t bits, const softbit_t *points, softbit_t noise_variance, demapping::demapping_t method=demapping::MAX_LOG);
+        ~demapper();
+        
+        uint64_t get_bits_per_symbol(void) const;
+        
+        /** Number of symbols demap() reads for num_llrs LLRs, the last symbol may only be used in part */
+        uint64_t get_num_symbols(uint64_t num_llrs) const;
+        
+        softbit_t get_noise_variance(void) const;
+        
+        /** Set the noise variance for the following calls of demap(), zero yields infinite LLRs */
+        void set_noise_variance(softbit_t noise_variance);
+        
+        llr::domain_t get_domain(void) const;
+        
+        /** Select the logarithm of the LLRs, which has to match the domain of the decoder */
+        void set_domain(llr::domain_t domain);
+        
+        /** Estimate the noise variance from num_symbols received symbols
+         *
+         * Constellations of constant magnitude use the M2M4 moment estimator, which does not need to know the
+         * transmitted symbols. Others assume the closest point has been sent, which underestimates the noise
+         * at low SNR.
+         */
+        softbit_t estimate_noise_variance(const softbit_t *samples, uint64_t num_symbols) const;
+        
+        /** Write num_llrs LLRs of the samples of get_num_symbols(num_llrs) symbols */
+        void demap(softbit_t *llrs, const softbit_t *samples, uint64_t num_llrs) const;
+        
+    private:
+        void init(const softbit_t *xy, softbit_t noise_variance, demapping::demapping_t method);
+        void demap_exact(softbit_t *out, const softbit_t *samples, uint64_t num_symbols) const;
+        softbit_t get_metric(const softbit_t *sample, uint64_t point) const;
+    };
+}
+
+#endif /* __LIBLDPC_DEMAPPER_H__DEFINED__ */
@@ -6,7 +6,30 @@
 #include <stdio.h>
 #include <ldpc/ldpc.h>
 
+/** Number of 64 bit parity words accumulated in registers at once by encoder::encode() */
+#define ENCODER_BLOCK_WORDS 4
+
 namespace ldpc {
+    
+    class code;
+    class mapped_file;
+    
+    namespace encoding {
+        /** Representation of the generator inside the encoder
+         *
+         * DENSE stores every column of the generator. QUASI_CYCLIC requires the parity part of the generator to
+         * consist of ZxZ circulant blocks and stores only the first column of every block, which reduces the
+         * memory by a factor of Z. Rotated copies of these columns are XORed during encoding, which costs a few
+         * shifts per word, so DENSE remains faster as long as its columns fit into the cache.
+         *
+         * SPARSE needs no generator at all, it solves the parity check matrix for the parity bits with the
+         * approximate lower triangulation of Richardson and Urbanke. Most parity bits follow by back-substitution
+         * from a single check each, only the few bits of the gap are solved with a dense gap x gap matrix. This
+         * takes time and memory linear in the number of edges, plus the square of the gap.
+         */
+        enum encoding_t { DENSE=0, QUASI_CYCLIC=1, SPARSE=2 };
+    }
+    
     class LDPC_EXPORT encoder {
     private:
         uint64_t N;
@@ -15,22 +38,161 @@ namespace ldpc {
         uint64_t N_punct_bytes;
         uint64_t K_bytes;
         
-        uint8_t **parity_checks;
+        encoding::encoding_t enctype;
+        
+        /** Number of 64 bit words per generator column, N_punct bits rounded up to ENCODER_BLOCK_WORDS words */
+        uint64_t N_punct_words;
+        
+        /** Generator in column-major order (K*gen_stride words, DENSE only)
+         * 
+         * Column k holds the parity bits that depend on information bit k, MSB first like the output bytes.
+         * Encoding XORs the columns of all set information bits. Points into mapping for compiled generators.
+         */
+        uint64_t *gen_columns;
+        
+        /** Number of 64 bit words from one generator column to the next, at least N_punct_words */
+        uint64_t gen_stride;
+        
+        /** Compiled generator file the columns are encoded from, NULL if they have been copied */
+        mapped_file *mapping;
+        
+        /** Circulant size (QUASI_CYCLIC only) */
+        uint64_t Z;
+        
+        /** Number of 64 bit words holding Z bits */
+        uint64_t Z_words;
+        
+        /** Number of 64 bit words of a stored circulant */
+        uint64_t circ_words;
+        
+        /** First columns of all circulants, (K/Z)*(N/Z)*circ_words words (QUASI_CYCLIC only)
+         *
+         * Circulant (i,j) covers information bits i*Z...(i+1)*Z-1 and parity bits j*Z...(j+1)*Z-1. Its first
+         * column is stored twice in a row, MSB first, so every rotation is a contiguous window of Z bits.
+         */
+        uint64_t *circulants;
+        
+        /** All N parity bits before puncturing (N/64+1 words, QUASI_CYCLIC only) */
+        uint64_t *parity_words;
+        
+        /** Index of every parity bit that is not punctured, NULL if these are the first N_punct ones */
+        uint64_t *parity_map;
+        
+        /** Bit offset into the circulants of the generator column of every information bit (K elements, QUASI_CYCLIC only)
+         *
+         * The window of Z bits starting there is column k%Z of the circulant. The following circulants of the
+         * same information bits are circ_words words apart.
+         */
+        uint64_t *windows;
+        
+        /** Generator columns of the set information bits of the current frame (K elements) */
+        const uint64_t **set_columns;
+        
+        /** Windows of the set information bits of the current frame (K elements) */
+        uint64_t *set_windows;
+        
+        /** Number of checks solved for a single parity bit each (SPARSE only) */
+        uint64_t num_tri;
+        
+        /** Offset of the bits of each of these checks in tri_bits (num_tri+1 elements, SPARSE only) */
+        uint64_t *tri_offsets;
+        
+        /** Codeword bits of the checks except for the bit solved for, which is given in tri_pivots (SPARSE only)
+         *
+         * The checks are ordered, so each one only involves information bits, gap bits and the bits solved by
+         * the checks before it.
+         */
+        uint64_t *tri_bits;
+        uint64_t *tri_pivots;
+        
+        /** Number of parity bits not solved by back-substitution (SPARSE only) */
+        uint64_t gap;
+        
+        /** Codeword index of every gap bit (gap elements, SPARSE only) */
+        uint64_t *gap_bits;
+        
+        /** Offset of the bits of every remaining check in gap_check_bits (gap+1 elements, SPARSE only) */
+        uint64_t *gap_check_offsets;
+        uint64_t *gap_check_bits;
+        
+        /** Inverse of the map from the gap bits to the remaining checks after back-substitution (SPARSE only)
+         *
+         * Row i holds bit-packed in gap_words words, which syndromes of the remaining checks sum up to gap bit i.
+         */
+        uint64_t *gap_inverse;
+        uint64_t gap_words;
+        
+        /** Bits of the current codeword, zero or one (K+N elements, SPARSE only) */
+        uint8_t *codeword;
+        
+        /** Syndromes of the remaining checks of the current frame (gap_words words, SPARSE only) */
+        uint64_t *gap_syndrome;
+        
+        /** Column of the parity check matrix of every codeword bit (K+N elements), NULL if they are in its order */
+        uint64_t *column_order;
+        
         systematic::systematic_t systype;
         
     public:
-        encoder(const char* generator_file, systematic::systematic_t systype, puncturing::conf_t *punctconf);
+        /** Create encoder with the given generator representation
+         *
+         * With QUASI_CYCLIC the circulant size is detected from the generator if circulant_size is zero. The
+         * largest size that divides both dimensions and yields circulant blocks is used. With SPARSE the file
+         * is a parity check file as read by ldpc::code instead of a generator.
+         */
+        encoder(const char* generator_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, encoding::encoding_t enctype=encoding::DENSE, uint64_t circulant_size=0);
+        
+        /** Create a SPARSE encoder for a code, with the systematic and puncturing configuration of the code
+         *
+         * The information bits are the first K bits of the code, the last N bits the parity bits, like for a
+         * generator computed by ldpc_compute_generator. The code is only used during construction.
+         */
+        encoder(const code *c);
         ~encoder();
         
         uint64_t get_num_input(void) const;
         uint64_t get_num_output(void) const;
         
+        /** Circulant size of the QUASI_CYCLIC encoding, zero for DENSE */
+        uint64_t get_circulant_size(void) const;
+        
+        /** Column of the parity check matrix of every codeword bit, information bits first (K+N elements)
+         *
+         * Generators of codes whose last N columns are singular are computed for a different choice of parity
+         * bits, see ldpc_compute_generator -p. Codes and decoders have to be created with this order to decode
+         * the codewords. Returns NULL if the codeword bits are in the order of the parity check matrix.
+         */
+        const uint64_t* get_column_order(void) const;
+        
         void encode(uint8_t *out, const uint8_t *input);
         
+        /** Write the generator as compiled generator (version 2 of the generator file format)
+         *
+         * Compiled generators hold the columns in the layout of the DENSE encoding. Encoders without punctured
+         * parity bits, or with only the last ones punctured, map them and encode straight from the file.
+         * Requires a DENSE encoder without punctured parity bits. The format is described in encoder.cpp.
+         */
+        void write_compiled(const char *file) const;
+        
+        /** Write a generator given by its N rows, laid out like in version 1 files, as compiled generator
+         *
+         * column_order is stored along with the generator and returned by get_column_order() of encoders
+         * created from the file, it may be NULL.
+         */
+        static void write_compiled(const char *file, uint64_t N, uint64_t K, const uint8_t *rows, const uint64_t *column_order);
+        
     private:
-        static uint8_t read_byte(FILE *fp, const char *descr);
-        static bool byte_parity(uint8_t byte);
-        static void modify_bit(uint8_t *byte, uint8_t pos, bool value);
+        void init_dimensions(uint64_t N, uint64_t K, const puncturing::conf_t *punctconf, systematic::systematic_t systype, encoding::encoding_t enctype);
+        void init_dense(const uint8_t *rows, puncturing::conf_t *punctconf);
+        void init_quasi_cyclic(const uint8_t *rows, puncturing::conf_t *punctconf, uint64_t circulant_size);
+        bool is_quasi_cyclic(const uint8_t *rows, uint64_t circulant_size) const;
+        bool get_generator_bit(const uint8_t *rows, uint64_t row, uint64_t col) const;
+        uint64_t collect_set_bits(const uint8_t *input);
+        void encode_dense(uint8_t *out, uint64_t num_set);
+        void encode_quasi_cyclic(uint8_t *out, uint64_t num_set);
+        void init_sparse(const code *c);
+        void solve_triangle(void);
+        void encode_sparse(uint8_t *out, const uint8_t *input);
     };
 }
 
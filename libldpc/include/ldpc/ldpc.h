@@ -24,10 +24,14 @@ namespace ldpc {
             const puncturing_t type;
             const uint64_t num_punct;
             uint64_t *punct_pos;
-        
+            
             // Default constructor, NO puncturing
             conf_t(void);
             
+            /** Puncture num_punct bits at the front, the back, or at the num_punct positions in punct_pos
+             * 
+             * CUSTOM positions are copied in ascending order, so is_punctured() takes logarithmic time.
+             */
             conf_t(const puncturing_t type, const uint64_t num_punct, uint64_t *punct_pos);
             
             conf_t(const conf_t &cpy);
@@ -38,9 +42,28 @@ namespace ldpc {
         };
     }
     
-    softbit_t prob2llr(const softbit_t prob_one);
+    namespace llr {
+        /** Logarithm of the LLRs log(p0/p1) a decoder or demapper takes and returns
+         * 
+         * LOG10 is the decimal logarithm the library has always used. NATURAL is the base of the belief
+         * propagation equations, with it the sum-product update needs no conversion of the messages. The
+         * min-sum variants do not depend on the base, but their offset, the quantization scale and the
+         * stopping thresholds are given in LLRs of the selected base.
+         */
+        enum domain_t { LOG10=0, NATURAL=1 };
+    }
+    
+    /** LLR of a bit that is one with probability prob_one */
+    softbit_t prob2llr(const softbit_t prob_one, llr::domain_t domain=llr::LOG10);
+    
+    /** Probability of a one, inverse of prob2llr() */
+    softbit_t llr2prob(const softbit_t llr, llr::domain_t domain=llr::LOG10);
+    
+    /** Natural LLR units per LLR unit of the domain, i.e. ln(10) for LOG10 */
+    softbit_t get_llr_nats(llr::domain_t domain);
     
-    softbit_t llr2prob(const softbit_t llr);
+    /** Convert num LLRs from one domain into another, out may be equal to in */
+    void convert_llrs(softbit_t *out, const softbit_t *in, uint64_t num, llr::domain_t from, llr::domain_t to);
     
     softbit_t addllrs(const softbit_t val1, softbit_t val2);
     
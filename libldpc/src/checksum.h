@@ -0,0 +1,21 @@
+#ifndef __LIBLDPC_CHECKSUM_H__DEFINED__
+#define __LIBLDPC_CHECKSUM_H__DEFINED__
+
+#include <stdint.h>
+
+namespace ldpc {
+    /** FNV-1a over 64 bit words, used to validate mapped files */
+    namespace checksum {
+        const uint64_t INIT = 0xcbf29ce484222325u;
+        
+        /** Continue the checksum h over num words */
+        inline uint64_t add(uint64_t h, const uint64_t *words, uint64_t num) {
+            for(uint64_t i=0; i<num; i++) {
+                h = (h ^ words[i]) * 0x100000001b3u;
+            }
+            return h;
+        }
+    }
+}
+
+#endif /* __LIBLDPC_CHECKSUM_H__DEFINED__ */
@@ -0,0 +1,727 @@
+#include <ldpc/code.h>
+#include "mapped_file.h"
+#include <unistd.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <algorithm>
+
+namespace {
+    /** Read position in a memory mapped text file */
+    struct text_t {
+        const char *pos;
+        const char *end;
+    };
+    
+    /** Parse the numbers of the next line into ret, like ldpc::code::parse_numbers_from_file()
+     * 
+     * The numbers are converted in place, without copying the line. Parsing stops at the first character of
+     * the line that is neither a digit nor white space.
+     */
+    void parse_numbers_from_text(uint64_t *ret, text_t *t, const char *line_descr, uint64_t num, bool ignore_zeros) {
+        if(t->pos == t->end) {
+            fprintf(stderr, "EOF reached while reading %s.\n", line_descr);
+            exit( EXIT_FAILURE );
+        }
+        
+        uint64_t len = 0;
+        bool numbers = true;
+        while(t->pos != t->end && *t->pos != '\n') {
+            const char c = *t->pos;
+            
+            if(!numbers || c == ' ' || c == '\t' || c == '\r') {
+                t->pos++;
+            } else if(c >= '0' && c <= '9') {
+                uint64_t i = 0;
+                while(t->pos != t->end && *t->pos >= '0' && *t->pos <= '9') {
+                    const uint64_t digit = static_cast<uint64_t>(*t->pos - '0');
+                    if(i > (UINT64_MAX - digit)/10) {
+                        fprintf(stderr, "Read number is out of range.\n");
+                        exit( EXIT_FAILURE );
+                    }
+                    i = i*10 + digit;
+                    t->pos++;
+                }
+                
+                if(!ignore_zeros || i != 0) {
+                    if(len < num) {
+                        ret[len] = i;
+                    }
+                    len++;
+                }
+            } else {
+                // Ignore the rest of the line
+                numbers = false;
+            }
+        }
+        
+        if(t->pos != t->end) {
+            t->pos++;
+        }
+        
+        if(len != num) {
+            fprintf(stderr, "%lu numbers read in %s line, but %lu were expected.\n", len, line_descr, num);
+            exit( EXIT_FAILURE );
+        }
+    }
+    
+    /** Check that only white space is left, like ldpc::code::parse_end_of_file() */
+    void parse_end_of_text(text_t *t, const char *file_descr) {
+        for(; t->pos != t->end; t->pos++) {
+            const char c = *t->pos;
+            if(c != ' ' && c != '\n' && c != '\r') {
+                fprintf(stderr, "%s contains illegal character '%c' after matrix is read in.\n", file_descr, c);
+                exit( EXIT_FAILURE );
+            }
+        }
+    }
+}
+
+void ldpc::code::parse_alist(const char* alist_file) {
+    // Parse the mapped file in a single pass, straight into the edge arrays
+    mapped_file file(alist_file);
+    text_t text;
+    text.pos = file.get_data();
+    text.end = text.pos + file.get_size();
+    text_t *f = &text;
+    
+    uint64_t buf[2];
+    
+    // Read N M
+    parse_numbers_from_text(buf, f, "dimensions", 2, false);
+    this->N = buf[0];
+    this->M = buf[1];
+    
+    // Read biggest_num_n biggest_num_m (ignored)
+    parse_numbers_from_text(buf, f, "maximum elements", 2, false);
+    
+    // Read num_n and num_m, stored as degrees in the offset arrays for now
+    uint64_t *num_n = new uint64_t[this->N];
+    parse_numbers_from_text(num_n, f, "nlist count", this->N , false);
+    
+    uint64_t *num_m = new uint64_t[this->M];
+    parse_numbers_from_text(num_m, f, "mlist count", this->M , false);
+    
+    uint64_t *offsets_n = new uint64_t[this->N+1];
+    uint64_t *offsets_m = new uint64_t[this->M+1];
+    
+    offsets_n[0] = 0;
+    for(size_t i=0; i<this->N; i++) {
+        offsets_n[i+1] = offsets_n[i] + num_n[i];
+    }
+    offsets_m[0] = 0;
+    for(size_t i=0; i<this->M; i++) {
+        offsets_m[i+1] = offsets_m[i] + num_m[i];
+    }
+    delete[] num_n;
+    delete[] num_m;
+    
+    if(offsets_n[this->N] != offsets_m[this->M]) {
+        fprintf(stderr, "alist file contains %lu edges in nlist, but %lu in mlist.\n", offsets_n[this->N], offsets_m[this->M]);
+        exit( EXIT_FAILURE );
+    }
+    this->E = offsets_n[this->N];
+    
+    // Read nlist, every line is stored contiguously after the previous one
+    uint64_t *edges_n = new uint64_t[this->E];
+    for(size_t i=0; i<this->N ;i++) {
+        parse_numbers_from_text(&edges_n[offsets_n[i]], f, "n-list", offsets_n[i+1]-offsets_n[i], true);
+    }
+    
+    // Read mlist
+    uint64_t *edges_m = new uint64_t[this->E];
+    for(size_t i=0; i<this->M ;i++) {
+        parse_numbers_from_text(&edges_m[offsets_m[i]], f, "m-list", offsets_m[i+1]-offsets_m[i], true);
+    }
+    
+    parse_end_of_text(f, "alist file");
+    
+    //// Alist read, convert to zero based indices
+    for(size_t e=0; e<this->E; e++) {
+        if(edges_n[e] < 1 || edges_n[e] > this->M || edges_m[e] < 1 || edges_m[e] > this->N) {
+            fprintf(stderr, "alist file contains an index that is out of range.\n");
+            exit( EXIT_FAILURE );
+        }
+        edges_n[e]--;
+        edges_m[e]--;
+    }
+    
+    //// Transpose if necessary
+    if(this->N > this->M) {
+        // Swap N and M
+        uint64_t tmp = this->N;
+        this->N = this->M;
+        this->M =tmp;
+        
+        // Swap offsets
+        uint64_t *tmpp = offsets_n;
+        offsets_n = offsets_m;
+        offsets_m = tmpp;
+        
+        // Swap edges
+        tmpp = edges_n;
+        edges_n = edges_m;
+        edges_m = tmpp;
+    }
+    
+    this->check_offsets = offsets_n;
+    this->check_edges = edges_n;
+    this->bit_offsets = offsets_m;
+    this->bit_edges = edges_m;
+    
+    this->max_check_degree = 0;
+    for(size_t i=0; i<this->N; i++) {
+        const uint64_t deg = this->check_offsets[i+1] - this->check_offsets[i];
+        this->max_check_degree = (deg > this->max_check_degree) ? deg : this->max_check_degree;
+    }
+    
+    // Compute K
+    this->K = M-N;
+
+}
+
+
+void ldpc::code::parse_base_matrix(const char* qc_file) {
+    FILE* f = fopen(qc_file, "r");
+    
+    if(!f) {
+        fprintf(stderr, "Cannot open file %s\n", qc_file);
+        exit( EXIT_FAILURE );
+    }
+    
+    uint64_t buf[3];
+    
+    // Read rows cols Z
+    parse_numbers_from_file(buf, f, "base matrix dimensions", 3, false);
+    const uint64_t rows = buf[0];
+    const uint64_t cols = buf[1];
+    this->Z = buf[2];
+    
+    if(rows == 0 || cols <= rows || this->Z == 0) {
+        fprintf(stderr, "Base matrix with %lu rows, %lu columns and circulant size %lu does not describe a code.\n", rows, cols, this->Z);
+        exit( EXIT_FAILURE );
+    }
+    
+    // Read the shifts of every block row, only nonzero blocks are stored
+    this->base_rows = rows;
+    this->block_offsets = new uint64_t[rows+1];
+    this->block_cols = new uint64_t[rows*cols];
+    this->block_shifts = new uint64_t[rows*cols];
+    
+    int64_t *shifts = new int64_t[cols];
+    this->block_offsets[0] = 0;
+    for(size_t r=0; r<rows; r++) {
+        parse_shifts_from_file(shifts, f, "base matrix", cols);
+        
+        uint64_t num = this->block_offsets[r];
+        for(size_t c=0; c<cols; c++) {
+            if(shifts[c] < -1 || shifts[c] >= static_cast<int64_t>(this->Z)) {
+                fprintf(stderr, "Shift %ld in block row %lu is not in [-1,%lu].\n", shifts[c], r, this->Z-1);
+                exit( EXIT_FAILURE );
+            }
+            if(shifts[c] >= 0) {
+                this->block_cols[num] = c;
+                this->block_shifts[num] = static_cast<uint64_t>(shifts[c]);
+                num++;
+            }
+        }
+        this->block_offsets[r+1] = num;
+    }
+    delete[] shifts;
+    
+    this->parse_end_of_file(f, "base matrix file");
+    fclose(f);
+    
+    this->N = rows*this->Z;
+    this->M = cols*this->Z;
+    this->E = this->block_offsets[rows]*this->Z;
+    
+    // Expand the circulants into the edges of the Tanner graph
+    this->build_graph_from_blocks();
+}
+
+bool ldpc::code::is_base_matrix_file(const char* file) const {
+    FILE* f = fopen(file, "r");
+    
+    if(!f) {
+        fprintf(stderr, "Cannot open file %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    // alist files start with two dimensions, base matrix files with three
+    char *line = NULL;
+    size_t len = 0;
+    uint64_t num = 0;
+    if(getline(&line, &len, f) != -1) {
+        char *pos = line;
+        char *end;
+        while(true) {
+            strtoll(pos, &end, 10);
+            if(end == pos) {
+                break;
+            }
+            pos = end;
+            num++;
+        }
+    }
+    free(line);
+    fclose(f);
+    
+    return num == 3;
+}
+
+void ldpc::code::detect_quasi_cyclic(void) {
+    // Try the largest common divisor of both dimensions first
+    uint64_t a = this->N;
+    uint64_t b = this->M;
+    while(b != 0) {
+        const uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    
+    for(uint64_t z=a; z>1; z--) {
+        if(a % z == 0 && this->find_blocks(z)) {
+            break;
+        }
+    }
+}
+
+bool ldpc::code::find_blocks(uint64_t circulant_size) {
+    if(this->E % circulant_size != 0) {
+        return false;
+    }
+    
+    const uint64_t rows = this->N/circulant_size;
+    const uint64_t cols = this->M/circulant_size;
+    const uint64_t num_blocks = this->E/circulant_size;
+    
+    uint64_t *offsets = new uint64_t[rows+1];
+    uint64_t *bcols = new uint64_t[num_blocks];
+    uint64_t *bshifts = new uint64_t[num_blocks];
+    
+    // Shift plus one of the block in every block column of the current block row, zero for none
+    uint64_t *col_shift = new uint64_t[cols];
+    for(size_t c=0; c<cols; c++) {
+        col_shift[c] = 0;
+    }
+    
+    bool ok = true;
+    uint64_t num = 0;
+    offsets[0] = 0;
+    for(size_t r=0; r<rows && ok; r++) {
+        const uint64_t check0 = r*circulant_size;
+        const uint64_t degree = this->check_offsets[check0+1] - this->check_offsets[check0];
+        
+        // The first row of a block row defines the shifts
+        for(uint64_t e=this->check_offsets[check0]; e<this->check_offsets[check0+1] && ok; e++) {
+            const uint64_t c = this->check_edges[e]/circulant_size;
+            ok = (col_shift[c] == 0 && num < num_blocks);
+            if(ok) {
+                col_shift[c] = this->check_edges[e]%circulant_size + 1;
+                bcols[num] = c;
+                bshifts[num] = this->check_edges[e]%circulant_size;
+                num++;
+            }
+        }
+        offsets[r+1] = num;
+        
+        // All other rows are connected to the same bits, rotated by their position in the block row
+        for(uint64_t i=1; i<circulant_size && ok; i++) {
+            const uint64_t check_indx = check0+i;
+            ok = (this->check_offsets[check_indx+1] - this->check_offsets[check_indx] == degree);
+            
+            for(uint64_t e=this->check_offsets[check_indx]; e<this->check_offsets[check_indx+1] && ok; e++) {
+                const uint64_t c = this->check_edges[e]/circulant_size;
+                ok = (col_shift[c] != 0 && this->check_edges[e]%circulant_size == (i + col_shift[c]-1)%circulant_size);
+            }
+        }
+        
+        for(uint64_t k=offsets[r]; k<num; k++) {
+            col_shift[bcols[k]] = 0;
+        }
+    }
+    delete[] col_shift;
+    
+    if(!ok || num != num_blocks) {
+        delete[] offsets;
+        delete[] bcols;
+        delete[] bshifts;
+        return false;
+    }
+    
+    this->Z = circulant_size;
+    this->base_rows = rows;
+    this->block_offsets = offsets;
+    this->block_cols = bcols;
+    this->block_shifts = bshifts;
+    return true;
+}
+
+void ldpc::code::build_graph_from_blocks(void) {
+    this->check_offsets = new uint64_t[this->N+1];
+    this->check_edges = new uint64_t[this->E];
+    this->bit_offsets = new uint64_t[this->M+1];
+    this->bit_edges = new uint64_t[this->E];
+    
+    // Every bit has one edge per nonzero block in its block column
+    uint64_t *bit_pos = new uint64_t[this->M];
+    for(size_t i=0; i<this->M; i++) {
+        bit_pos[i] = 0;
+    }
+    for(size_t k=0; k<this->block_offsets[this->base_rows]; k++) {
+        for(size_t i=0; i<this->Z; i++) {
+            bit_pos[this->block_cols[k]*this->Z + i]++;
+        }
+    }
+    this->bit_offsets[0] = 0;
+    for(size_t i=0; i<this->M; i++) {
+        this->bit_offsets[i+1] = this->bit_offsets[i] + bit_pos[i];
+        bit_pos[i] = this->bit_offsets[i];
+    }
+    
+    this->max_check_degree = 0;
+    this->check_offsets[0] = 0;
+    for(size_t r=0; r<this->base_rows; r++) {
+        const uint64_t first = this->block_offsets[r];
+        const uint64_t degree = this->block_offsets[r+1] - first;
+        this->max_check_degree = (degree > this->max_check_degree) ? degree : this->max_check_degree;
+        
+        for(size_t i=0; i<this->Z; i++) {
+            const uint64_t check_indx = r*this->Z + i;
+            this->check_offsets[check_indx+1] = this->check_offsets[check_indx] + degree;
+            
+            for(size_t k=0; k<degree; k++) {
+                const uint64_t bit_indx = this->block_cols[first+k]*this->Z + (i + this->block_shifts[first+k])%this->Z;
+                this->check_edges[this->check_offsets[check_indx]+k] = bit_indx;
+                this->bit_edges[bit_pos[bit_indx]++] = check_indx;
+            }
+        }
+    }
+    delete[] bit_pos;
+    
+    // Compute K
+    this->K = this->M - this->N;
+}
+
+void ldpc::code::apply_column_order(const uint64_t *column_order) {
+    // New index of every column, M if it has not been seen yet
+    uint64_t *new_index = new uint64_t[this->M];
+    for(uint64_t i=0; i<this->M; i++) {
+        new_index[i] = this->M;
+    }
+    for(uint64_t i=0; i<this->M; i++) {
+        if(column_order[i] >= this->M || new_index[column_order[i]] != this->M) {
+            fprintf(stderr, "Column order is not a permutation of the %lu columns of the parity check matrix.\n", this->M);
+            exit( EXIT_FAILURE );
+        }
+        new_index[column_order[i]] = i;
+    }
+    
+    for(uint64_t e=0; e<this->E; e++) {
+        this->check_edges[e] = new_index[this->check_edges[e]];
+    }
+    
+    // Move the checks of every bit to its new position
+    uint64_t *offsets = new uint64_t[this->M+1];
+    uint64_t *edges = new uint64_t[this->E];
+    offsets[0] = 0;
+    for(uint64_t i=0; i<this->M; i++) {
+        const uint64_t *first = &this->bit_edges[this->bit_offsets[column_order[i]]];
+        const uint64_t *last = &this->bit_edges[this->bit_offsets[column_order[i]+1]];
+        offsets[i+1] = offsets[i] + static_cast<uint64_t>(last-first);
+        std::copy(first, last, &edges[offsets[i]]);
+    }
+    delete[] this->bit_offsets;
+    delete[] this->bit_edges;
+    this->bit_offsets = offsets;
+    this->bit_edges = edges;
+    
+    // Circulants of the old order do not apply anymore, the structure is detected again
+    delete[] this->block_offsets;
+    delete[] this->block_cols;
+    delete[] this->block_shifts;
+    this->Z = 0;
+    this->base_rows = 0;
+    this->block_offsets = NULL;
+    this->block_cols = NULL;
+    this->block_shifts = NULL;
+    
+    this->column_order = new uint64_t[this->M];
+    std::copy(column_order, column_order+this->M, this->column_order);
+    
+    delete[] new_index;
+}
+
+void ldpc::code::parse_numbers_from_file(uint64_t *ret, FILE *f, const char *line_descr, uint64_t num, bool ignore_zeros) {
+    char *line = NULL;
+    char *line_alloc;
+    char *end;
+    size_t len = 0;
+    ssize_t read;
+    
+    read = getline(&line, &len, f);
+    if(read == -1) {
+        fprintf(stderr, "EOF reached while reading %s.\n", line_descr);
+        exit( EXIT_FAILURE );
+    }
+    line_alloc = line;
+    
+    len = 0;
+    errno = 0;
+    //fprintf(stdout, "Parsing line: '%s'\n", line);
+    for (unsigned long long i = strtoull(line, &end, 10); line != end; i = strtoull(line, &end, 10)) {
+        //fprintf(stdout, "'%.*s' -> %lld", (int)(end-line), line, i);
+        line = end;
+        if (errno == ERANGE){
+            fprintf(stderr, "Read number is out of range.\n");
+            exit( EXIT_FAILURE );
+        } else {
+            // Value in range
+            
+            if(!ignore_zeros || i != 0) {
+                ret[len++] = (uint64_t) i;
+            }
+        }
+        errno = 0;
+    }
+    
+    free(line_alloc);
+    
+    if(len != num) {
+        fprintf(stderr, "%lu numbers read in %s line, but %lu were expected.\n", len, line_descr, num);
+        exit( EXIT_FAILURE );
+    }
+    
+    return;
+}
+
+void ldpc::code::parse_shifts_from_file(int64_t *ret, FILE *f, const char *line_descr, uint64_t num) {
+    char *line = NULL;
+    char *line_alloc;
+    char *end;
+    size_t len = 0;
+    ssize_t read;
+    
+    read = getline(&line, &len, f);
+    if(read == -1) {
+        fprintf(stderr, "EOF reached while reading %s.\n", line_descr);
+        exit( EXIT_FAILURE );
+    }
+    line_alloc = line;
+    
+    len = 0;
+    errno = 0;
+    for (long long i = strtoll(line, &end, 10); line != end; i = strtoll(line, &end, 10)) {
+        line = end;
+        if (errno == ERANGE){
+            fprintf(stderr, "Read number is out of range.\n");
+            exit( EXIT_FAILURE );
+        }
+        
+        if(len < num) {
+            ret[len] = static_cast<int64_t>(i);
+        }
+        len++;
+        errno = 0;
+    }
+    
+    free(line_alloc);
+    
+    if(len != num) {
+        fprintf(stderr, "%lu numbers read in %s line, but %lu were expected.\n", len, line_descr, num);
+        exit( EXIT_FAILURE );
+    }
+}
+
+void ldpc::code::parse_end_of_file(FILE *f, const char *file_descr) {
+    // Read until EOF, ignore spaces and newlines
+    int c;
+    while(true) {
+        c = getc(f);
+        
+        if(c == -1) {
+            // EOF
+            break;
+        } else if( c == ' ' || c == '\n' || c == '\r' ) {
+            continue;
+        } else {
+            fprintf(stderr, "%s contains illegal character '%c' after matrix is read in.\n", file_descr, c);
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+void ldpc::code::build_edge_permutation(void) {
+    this->edge_b2c = new uint64_t[this->E];
+    this->edge_c2b = new uint64_t[this->E];
+    
+    for(uint64_t check_indx=0; check_indx<this->N; check_indx++) {
+        for(uint64_t e=this->check_offsets[check_indx]; e<this->check_offsets[check_indx+1]; e++) {
+            const uint64_t bit_indx = this->check_edges[e];
+            
+            // Find the same edge in the list of the bit
+            uint64_t f;
+            for(f=this->bit_offsets[bit_indx]; f<this->bit_offsets[bit_indx+1]; f++) {
+                if(this->bit_edges[f] == check_indx) {
+                    break;
+                }
+            }
+            
+            if(f == this->bit_offsets[bit_indx+1]) {
+                fprintf(stderr, "Check %lu is connected to bit %lu, but bit is not connected to check.\n", check_indx, bit_indx);
+                exit( EXIT_FAILURE );
+            }
+            
+            this->edge_c2b[e] = f;
+            this->edge_b2c[f] = e;
+        }
+    }
+}
+
+ldpc::code::code(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, const uint64_t *column_order) {
+    
+    // Store systematics configuration
+    this->systype = systype;
+    
+    // Store puncturing configuration
+    this->punctconf = punctconf;
+    
+    // A compiled code is used in place, only its puncturing maps might not fit
+    this->mapping = NULL;
+    this->column_order = NULL;
+    if(this->is_compiled_file(alist_file)) {
+        if(column_order) {
+            fprintf(stderr, "Compiled code %s cannot be reordered, compile the parity check matrix with ldpc_compile_code -o generator_file instead.\n", alist_file);
+            exit( EXIT_FAILURE );
+        }
+        if(!this->map_compiled(alist_file)) {
+            this->build_puncturing_maps();
+        }
+        return;
+    }
+    
+    // Read in N, M, K, E and the edges in check-major and bit-major order
+    this->Z = 0;
+    this->base_rows = 0;
+    this->block_offsets = NULL;
+    this->block_cols = NULL;
+    this->block_shifts = NULL;
+    if(this->is_base_matrix_file(alist_file)) {
+        this->parse_base_matrix(alist_file);
+    } else {
+        this->parse_alist(alist_file);
+    }
+    
+    if(column_order) {
+        this->apply_column_order(column_order);
+    }
+    if(this->Z == 0) {
+        this->detect_quasi_cyclic();
+    }
+    
+    // Link both edge orders
+    this->build_edge_permutation();
+    
+    this->build_puncturing_maps();
+}
+
+void ldpc::code::build_puncturing_maps(void) {
+    if(this->punctconf->num_punct > this->M) {
+        fprintf(stderr, "Cannot puncture %lu of %lu bits.\n", this->punctconf->num_punct, this->M);
+        exit( EXIT_FAILURE );
+    }
+    
+    this->punctured = new uint8_t[this->M];
+    this->input_bits = new uint64_t[this->M - this->punctconf->num_punct];
+    this->own_puncturing_maps = true;
+    
+    uint64_t num_punct = 0;
+    for(uint64_t i=0; i<this->M; i++) {
+        this->punctured[i] = this->punctconf->is_punctured(i, this->M) ? 1u : 0u;
+        num_punct += this->punctured[i];
+    }
+    
+    // Positions out of range or given twice would change the number of input LLRs
+    if(num_punct != this->punctconf->num_punct) {
+        fprintf(stderr, "Puncturing configuration of %lu positions punctures %lu of the %lu bits.\n", this->punctconf->num_punct, num_punct, this->M);
+        exit( EXIT_FAILURE );
+    }
+    
+    uint64_t j = 0;
+    for(uint64_t i=0; i<this->M; i++) {
+        if(!this->punctured[i]) {
+            this->input_bits[j++] = i;
+        }
+    }
+}
+
+ldpc::code::~code() {
+    if(this->own_puncturing_maps) {
+        delete[] this->punctured;
+        delete[] this->input_bits;
+    }
+    delete[] this->column_order;
+    
+    if(this->mapping) {
+        delete this->mapping;
+    } else {
+        delete[] this->check_offsets;
+        delete[] this->check_edges;
+        delete[] this->bit_offsets;
+        delete[] this->bit_edges;
+        delete[] this->edge_b2c;
+        delete[] this->edge_c2b;
+        delete[] this->block_offsets;
+        delete[] this->block_cols;
+        delete[] this->block_shifts;
+    }
+}
+
+uint64_t ldpc::code::get_num_input(void) const {
+    return this->M - this->punctconf->num_punct;
+}
+
+uint64_t ldpc::code::get_num_output(void) const {
+    return (this->systype == systematic::NONE) ? this->M : this->K;
+}
+
+uint64_t ldpc::code::get_circulant_size(void) const {
+    return this->Z;
+}
+
+const uint64_t* ldpc::code::get_check_bits(uint64_t check_indx, uint64_t *num) const {
+    *num = this->check_offsets[check_indx+1] - this->check_offsets[check_indx];
+    return &this->check_edges[this->check_offsets[check_indx]];
+}
+
+uint64_t ldpc::code::get_num_bits(void) const {
+    return this->M;
+}
+
+uint64_t ldpc::code::get_num_checks(void) const {
+    return this->N;
+}
+
+void ldpc::code::get_output_range(uint64_t *first, uint64_t *last) const {
+    switch(this->systype) {
+        case systematic::NONE:
+            // Output all M bits
+            *first = 0;
+            *last = this->M;
+            break;
+        case systematic::FRONT:
+            // Output first K bits
+            *first = 0;
+            *last = this->K;
+            break;
+        case systematic::BACK:
+            // Output last K bits
+            *first = this->M-this->K;
+            *last = this->M;
+            break;
+        default:
+            fprintf(stderr, "State machine error.\n");
+            exit( EXIT_FAILURE );
+    }
+}
+
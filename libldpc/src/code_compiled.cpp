@@ -0,0 +1,312 @@
+#include <ldpc/code.h>
+#include "checksum.h"
+#include "mapped_file.h"
+#include <stdlib.h>
+#include <cstring>
+
+/*
+ * Compiled code format, version 1
+ *
+ * A compiled code consists of 64 bit words in the byte order of the machine that wrote it, so it can be mapped
+ * and used in place. It starts with a header of COMPILED_HEADER_WORDS words:
+ *
+ *    0  magic "LDPCCODE"
+ *    1  format version
+ *    2  N           3  M           4  E           5  max_check_degree
+ *    6  Z           7  base_rows   8  number of nonzero blocks (zero if Z is zero)
+ *    9  puncturing type the maps have been computed for
+ *   10  number of punctured bits
+ *   11  number of payload words
+ *   12  checksum of the payload
+ *   13  checksum of words 0 to 12
+ *
+ * The payload holds the arrays of ldpc::code one after the other:
+ *
+ *   check_offsets (N+1), check_edges (E), bit_offsets (M+1), bit_edges (E), edge_b2c (E), edge_c2b (E),
+ *   block_offsets (base_rows+1 if Z is not zero), block_cols and block_shifts (one per nonzero block),
+ *   input_bits (M minus punctured bits), the punctured bits in ascending order, and the punctured flags
+ *   (M bytes, padded to full words).
+ *
+ * Checksums are FNV-1a over words. A file written with the other byte order fails the version check. Since the
+ * checksums only detect damage, the ranges and the consistency of the arrays are checked as well when mapping.
+ */
+
+namespace {
+    const char COMPILED_MAGIC[8] = {'L', 'D', 'P', 'C', 'C', 'O', 'D', 'E'};
+    const uint64_t COMPILED_VERSION = 1;
+    const uint64_t COMPILED_HEADER_WORDS = 14;
+    
+    /** Payload words of a code with the dimensions given in a header */
+    uint64_t compiled_payload_words(const uint64_t *h) {
+        const uint64_t N = h[2];
+        const uint64_t M = h[3];
+        const uint64_t E = h[4];
+        const uint64_t Z = h[6];
+        const uint64_t base_rows = h[7];
+        const uint64_t num_blocks = h[8];
+        
+        return (N+1) + (M+1) + 4*E + ((Z > 0) ? base_rows+1 : 0) + 2*num_blocks + M + (M+7)/8;
+    }
+    
+    /** Offsets have to start at zero, never decrease and end at the length of the array they index */
+    bool valid_offsets(const uint64_t *offsets, uint64_t num, uint64_t total) {
+        if(offsets[0] != 0 || offsets[num] != total) {
+            return false;
+        }
+        for(uint64_t i=0; i<num; i++) {
+            if(offsets[i] > offsets[i+1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    /** Positions have to be below bound and, if ascending is set, strictly ascending */
+    bool valid_positions(const uint64_t *pos, uint64_t num, uint64_t bound, bool ascending) {
+        for(uint64_t i=0; i<num; i++) {
+            if(pos[i] >= bound || (ascending && i > 0 && pos[i] <= pos[i-1])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    void write_words(FILE *f, const uint64_t *words, uint64_t num, const char *file) {
+        if(fwrite(words, sizeof(uint64_t), num, f) != num) {
+            fprintf(stderr, "Cannot write compiled code to %s\n", file);
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+bool ldpc::code::is_compiled_file(const char* file) const {
+    FILE* f = fopen(file, "rb");
+    
+    if(!f) {
+        fprintf(stderr, "Cannot open file %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    char magic[sizeof(COMPILED_MAGIC)];
+    const bool ret = (fread(magic, 1, sizeof(magic), f) == sizeof(magic) && std::memcmp(magic, COMPILED_MAGIC, sizeof(magic)) == 0);
+    fclose(f);
+    
+    return ret;
+}
+
+void ldpc::code::write_compiled(const char *file) const {
+    const uint64_t num_punct = this->punctconf->num_punct;
+    const uint64_t num_blocks = (this->Z > 0) ? this->block_offsets[this->base_rows] : 0;
+    
+    // Punctured bits in ascending order and their flags, padded to full words
+    uint64_t *punct_pos = new uint64_t[num_punct];
+    for(uint64_t i=0, j=0; i<this->M; i++) {
+        if(this->punctured[i]) {
+            punct_pos[j++] = i;
+        }
+    }
+    const uint64_t flag_words = (this->M+7)/8;
+    uint64_t *flags = new uint64_t[flag_words];
+    std::memset(flags, 0, flag_words*sizeof(uint64_t));
+    std::memcpy(flags, this->punctured, this->M);
+    
+    struct {
+        const uint64_t *words;
+        uint64_t num;
+    } arrays[] = {
+        {this->check_offsets, this->N+1},
+        {this->check_edges, this->E},
+        {this->bit_offsets, this->M+1},
+        {this->bit_edges, this->E},
+        {this->edge_b2c, this->E},
+        {this->edge_c2b, this->E},
+        {this->block_offsets, (this->Z > 0) ? this->base_rows+1 : 0},
+        {this->block_cols, num_blocks},
+        {this->block_shifts, num_blocks},
+        {this->input_bits, this->M - num_punct},
+        {punct_pos, num_punct},
+        {flags, flag_words}
+    };
+    const uint64_t num_arrays = sizeof(arrays)/sizeof(arrays[0]);
+    
+    uint64_t h[COMPILED_HEADER_WORDS];
+    std::memcpy(&h[0], COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+    h[1] = COMPILED_VERSION;
+    h[2] = this->N;
+    h[3] = this->M;
+    h[4] = this->E;
+    h[5] = this->max_check_degree;
+    h[6] = this->Z;
+    h[7] = this->base_rows;
+    h[8] = num_blocks;
+    h[9] = static_cast<uint64_t>(this->punctconf->type);
+    h[10] = num_punct;
+    h[11] = compiled_payload_words(h);
+    
+    h[12] = checksum::INIT;
+    for(uint64_t a=0; a<num_arrays; a++) {
+        h[12] = checksum::add(h[12], arrays[a].words, arrays[a].num);
+    }
+    h[13] = checksum::add(checksum::INIT, h, 13);
+    
+    FILE *f = fopen(file, "wb");
+    if(!f) {
+        fprintf(stderr, "Cannot open file %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    write_words(f, h, COMPILED_HEADER_WORDS, file);
+    for(uint64_t a=0; a<num_arrays; a++) {
+        write_words(f, arrays[a].words, arrays[a].num, file);
+    }
+    
+    if(fclose(f) != 0) {
+        fprintf(stderr, "Cannot write compiled code to %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    delete[] punct_pos;
+    delete[] flags;
+}
+
+bool ldpc::code::map_compiled(const char* file) {
+    this->mapping = new mapped_file(file);
+    const uint64_t size = this->mapping->get_size();
+    
+    if(size % sizeof(uint64_t) != 0 || size < COMPILED_HEADER_WORDS*sizeof(uint64_t)) {
+        fprintf(stderr, "%s is not a complete compiled code.\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    // The mapping is page aligned and never written to, the arrays of the code just point into it
+    uint64_t *h = reinterpret_cast<uint64_t*>(const_cast<char*>(this->mapping->get_data()));
+    
+    if(h[1] != COMPILED_VERSION) {
+        fprintf(stderr, "Compiled code %s has format version %lu, but only version %lu is supported.\n", file, h[1], COMPILED_VERSION);
+        exit( EXIT_FAILURE );
+    }
+    if(checksum::add(checksum::INIT, h, 13) != h[13]) {
+        fprintf(stderr, "Header of compiled code %s is corrupt.\n", file);
+        exit( EXIT_FAILURE );
+    }
+    if(h[10] > h[3] || h[11] != compiled_payload_words(h) || size != (COMPILED_HEADER_WORDS + h[11])*sizeof(uint64_t)) {
+        fprintf(stderr, "%s is not a complete compiled code.\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    uint64_t *p = &h[COMPILED_HEADER_WORDS];
+    if(checksum::add(checksum::INIT, p, h[11]) != h[12]) {
+        fprintf(stderr, "Compiled code %s is corrupt.\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    this->N = h[2];
+    this->M = h[3];
+    this->K = this->M - this->N;
+    this->E = h[4];
+    this->max_check_degree = h[5];
+    this->Z = h[6];
+    this->base_rows = h[7];
+    const uint64_t num_blocks = h[8];
+    const uint64_t num_punct = h[10];
+    
+    this->check_offsets = p;
+    p += this->N+1;
+    this->check_edges = p;
+    p += this->E;
+    this->bit_offsets = p;
+    p += this->M+1;
+    this->bit_edges = p;
+    p += this->E;
+    this->edge_b2c = p;
+    p += this->E;
+    this->edge_c2b = p;
+    p += this->E;
+    
+    this->block_offsets = NULL;
+    this->block_cols = NULL;
+    this->block_shifts = NULL;
+    if(this->Z > 0) {
+        this->block_offsets = p;
+        p += this->base_rows+1;
+        this->block_cols = p;
+        p += num_blocks;
+        this->block_shifts = p;
+        p += num_blocks;
+    }
+    
+    uint64_t *input_bits = p;
+    p += this->M - num_punct;
+    const uint64_t *punct_pos = p;
+    p += num_punct;
+    uint8_t *flags = reinterpret_cast<uint8_t*>(p);
+    
+    // The checksums only detect damage, a file that is consistent but malformed would make every decoder read out of bounds
+    if(!this->valid_compiled(num_blocks, num_punct, input_bits, punct_pos, flags)) {
+        fprintf(stderr, "Compiled code %s is malformed.\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    // The compiled puncturing maps only apply to the same puncturing configuration
+    const bool same = (static_cast<uint64_t>(this->punctconf->type) == h[9] && this->punctconf->num_punct == num_punct &&
+        (this->punctconf->type != puncturing::CUSTOM || std::memcmp(this->punctconf->punct_pos, punct_pos, num_punct*sizeof(uint64_t)) == 0));
+    if(!same) {
+        return false;
+    }
+    
+    this->punctured = flags;
+    this->input_bits = input_bits;
+    this->own_puncturing_maps = false;
+    return true;
+}
+
+bool ldpc::code::valid_compiled(uint64_t num_blocks, uint64_t num_punct, const uint64_t *input_bits, const uint64_t *punct_pos, const uint8_t *flags) const {
+    if(!valid_offsets(this->check_offsets, this->N, this->E) || !valid_offsets(this->bit_offsets, this->M, this->E) ||
+        !valid_positions(this->check_edges, this->E, this->M, false) || !valid_positions(this->bit_edges, this->E, this->N, false)) {
+        return false;
+    }
+    
+    uint64_t max_check_degree = 0;
+    for(uint64_t check_indx=0; check_indx<this->N; check_indx++) {
+        const uint64_t degree = this->check_offsets[check_indx+1] - this->check_offsets[check_indx];
+        max_check_degree = (degree > max_check_degree) ? degree : max_check_degree;
+        
+        // Every edge of the check has to be an edge of its bit, and no other edge may map to the same one
+        for(uint64_t e=this->check_offsets[check_indx]; e<this->check_offsets[check_indx+1]; e++) {
+            const uint64_t f = this->edge_c2b[e];
+            const uint64_t bit_indx = this->check_edges[e];
+            if(f < this->bit_offsets[bit_indx] || f >= this->bit_offsets[bit_indx+1] || this->bit_edges[f] != check_indx || this->edge_b2c[f] != e) {
+                return false;
+            }
+        }
+    }
+    if(max_check_degree != this->max_check_degree) {
+        return false;
+    }
+    
+    if(this->Z > 0) {
+        if(this->N != this->base_rows*this->Z || this->M % this->Z != 0 || this->E != num_blocks*this->Z ||
+            !valid_offsets(this->block_offsets, this->base_rows, num_blocks) ||
+            !valid_positions(this->block_cols, num_blocks, this->M/this->Z, false) || !valid_positions(this->block_shifts, num_blocks, this->Z, false)) {
+            return false;
+        }
+    }
+    
+    // Input and punctured bits have to be ascending and agree with the flags, which makes them the M bits together
+    if(!valid_positions(input_bits, this->M - num_punct, this->M, true) || !valid_positions(punct_pos, num_punct, this->M, true)) {
+        return false;
+    }
+    uint64_t num_flagged = 0;
+    for(uint64_t i=0; i<this->M; i++) {
+        if(flags[i] > 1) {
+            return false;
+        }
+        num_flagged += flags[i];
+    }
+    for(uint64_t i=0; i<this->M - num_punct; i++) {
+        if(flags[input_bits[i]]) {
+            return false;
+        }
+    }
+    return num_flagged == num_punct;
+}
@@ -1,204 +1,280 @@
 #include <ldpc/decoder.h>
+#include "decoder_batch.h"
+#include "llr_approx.h"
+#include "timing.h"
 #include <unistd.h>
 #include <stdlib.h>
 #include <errno.h>
 #include <cmath>
 #include <cassert>
 #include <limits>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
-void ldpc::decoder::parse_alist(const char* alist_file) {
-    FILE* f = fopen(alist_file, "r");
+struct ldpc::decoder::guess_task_t {
+    /** Node of the guessed bit and the result index of the guessed sign */
+    guess_tree *node;
+    uint8_t value;
     
-    if(!f) {
-        fprintf(stderr, "Cannot open file %s\n", alist_file);
-        exit( EXIT_FAILURE );
-    }
-    
-    uint64_t buf[2];
-    
-    // Read N M
-    parse_numbers_from_file(buf, f, "dimensions", 2, false);
-    this->N = buf[0];
-    this->M = buf[1];
-    
-    // Read biggest_num_n biggest_num_m (ignored)
-    parse_numbers_from_file(buf, f, "maximum elements", 2, false);
-    
-    // Read num_n
-    this->nlist_num = new uint64_t[this->N];
-    parse_numbers_from_file(this->nlist_num, f, "nlist count", this->N , false);
-    
-    // Read num_m
-    this->mlist_num = new uint64_t[this->M];
-    parse_numbers_from_file(this->mlist_num, f, "mlist count", this->M , false);
-    
-    // Read nlist
-    this->nlist = new uint64_t*[this->N];
-    for(size_t i=0; i<N ;i++) {
-        this->nlist[i] = new uint64_t[this->nlist_num[i]];
-        
-        parse_numbers_from_file(this->nlist[i], f, "n-list", this->nlist_num[i], true);
-    }
+    /** Output and result of decoding the guess */
+    softbit_t *out;
+    metadata_t meta;
+    bool success;
+};
 
-    // Read mlist
-    this->mlist = new uint64_t*[this->M];
-    for(size_t i=0; i<M ;i++) {
-        this->mlist[i] = new uint64_t[this->mlist_num[i]];
-        
-        parse_numbers_from_file(this->mlist[i], f, "m-list", this->mlist_num[i], true);
+uint64_t ldpc::decoder::get_num_input(void) const {
+    return this->graph->get_num_input();
+}
+
+uint64_t ldpc::decoder::get_num_output(void) const {
+    return this->graph->get_num_output();
+}
+
+uint64_t ldpc::decoder::get_circulant_size(void) const {
+    return this->graph->get_circulant_size();
+}
+
+uint64_t ldpc::decoder::get_batch_lanes(void) const {
+    uint64_t lanes;
+    switch(this->quant) {
+        case quantization::INT16:
+            batch::select_kernel_i16(&lanes);
+            break;
+        case quantization::INT8:
+            batch::select_kernel_i8(&lanes);
+            break;
+        default:
+            batch::select_kernel(&lanes);
     }
+    return lanes;
+}
 
-    // Read until EOF, ignore spaces and newlines
-    int c;
-    while(true) {
-        c = getc(f);
-        
-        if(c == -1) {
-            // EOF
+void ldpc::decoder::set_algorithm(checknode::algorithm_t algorithm) {
+    switch(algorithm) {
+        case checknode::NORMALIZED_MIN_SUM:
+            this->set_algorithm(algorithm, DECODER_MINSUM_SCALE);
             break;
-        } else if( c == ' ' || c == '\n' || c == '\r' ) {
-            continue;
-        } else {
-            fprintf(stderr, "alist file contains illegal character '%c' after matrix is read in.\n", c);
+        case checknode::OFFSET_MIN_SUM:
+            this->set_algorithm(algorithm, DECODER_MINSUM_OFFSET);
+            break;
+        case checknode::SUM_PRODUCT_PHI:
+            this->set_algorithm(algorithm, DECODER_PHI_STEPS);
+            break;
+        default:
+            this->set_algorithm(algorithm, 0.0f);
+    }
+}
+
+void ldpc::decoder::set_algorithm(checknode::algorithm_t algorithm, softbit_t param) {
+    if(algorithm == checknode::NORMALIZED_MIN_SUM && (param <= 0.0f || param > 1.0f)) {
+        fprintf(stderr, "Scaling factor %f of normalized min-sum is not in (0,1].\n", static_cast<double>(param));
+        exit( EXIT_FAILURE );
+    }
+    if(algorithm == checknode::OFFSET_MIN_SUM && param < 0.0f) {
+        fprintf(stderr, "Offset %f of offset min-sum is negative.\n", static_cast<double>(param));
+        exit( EXIT_FAILURE );
+    }
+    if(algorithm == checknode::SUM_PRODUCT_PHI) {
+        int exponent;
+        if(!(param >= 1.0f && param <= DECODER_PHI_MAX_STEPS) || std::frexp(param, &exponent) != 0.5f) {
+            fprintf(stderr, "Resolution %f of the phi table is not a power of two in [1,%f].\n", static_cast<double>(param), static_cast<double>(DECODER_PHI_MAX_STEPS));
             exit( EXIT_FAILURE );
         }
     }
-    fclose(f);
     
-    //// Alist read, transpose if necessary
+    this->algorithm = algorithm;
+    this->algorithm_param = param;
     
-    if(this->N > this->M) {
-        // Swap N and M
-        uint64_t tmp = this->N;
-        this->N = this->M;
-        this->M =tmp;
-        
-        // Swap nlist_num and mlist_num
-        uint64_t *tmpp = this->nlist_num;
-        this->nlist_num = this->mlist_num;
-        this->mlist_num = tmpp;
-        
-        // Swap nlist and mlist
-        uint64_t **tmppp = this->nlist;
-        this->nlist = this->mlist;
-        this->mlist = tmppp;
+    // The table is only kept for the algorithm that reads it
+    delete this->phi_table;
+    this->phi_table = NULL;
+    if(algorithm == checknode::SUM_PRODUCT_PHI) {
+        this->phi_table = new approx::phi_table_t(static_cast<uint64_t>(param));
     }
-    
-    // Compute K
-    this->K = M-N;
-    
 }
 
+void ldpc::decoder::set_schedule(schedule::schedule_t sched) {
+    this->sched = sched;
+}
 
-void ldpc::decoder::parse_numbers_from_file(uint64_t *ret, FILE *f, const char *line_descr, uint64_t num, bool ignore_zeros) {
-    char *line = NULL;
-    char *line_alloc;
-    char *end;
-    size_t len = 0;
-    ssize_t read;
-    
-    read = getline(&line, &len, f);
-    if(read == -1) {
-        fprintf(stderr, "EOF reached while reading %s.\n", line_descr);
+void ldpc::decoder::set_domain(llr::domain_t domain) {
+    this->domain = domain;
+    this->llr_nats = get_llr_nats(domain);
+}
+
+ldpc::llr::domain_t ldpc::decoder::get_domain(void) const {
+    return this->domain;
+}
+
+ldpc::stopping::conf_t::conf_t(void)
+    : max_iterations(DECODER_MAX_ITERATIONS), max_awrm_iterations(DECODER_MAX_AWRM_ITERATIONS), min_llr_mag(DECODER_MIN_LLR_MAG),
+      min_llr_delta(0.0f), syndrome_only(false), max_time_us(0) {}
+
+void ldpc::decoder::set_stopping(const stopping::conf_t &stop) {
+    check_stopping(stop);
+    this->stop = stop;
+}
+
+const ldpc::stopping::conf_t& ldpc::decoder::get_stopping(void) const {
+    return this->stop;
+}
+
+void ldpc::decoder::check_stopping(const stopping::conf_t &stop) {
+    if(stop.max_iterations == 0) {
+        fprintf(stderr, "At least one decoding iteration is required.\n");
+        exit( EXIT_FAILURE );
+    }
+    if(!(stop.min_llr_mag >= 0.0f)) {
+        fprintf(stderr, "Minimum LLR magnitude %f is negative.\n", static_cast<double>(stop.min_llr_mag));
         exit( EXIT_FAILURE );
     }
-    line_alloc = line;
+}
+
+void ldpc::decoder::set_quantization(quantization::type_t type) {
+    switch(type) {
+        case quantization::INT16:
+            this->set_quantization(type, DECODER_QUANT_INT16_SCALE, DECODER_QUANT_INT16_CLIP);
+            break;
+        case quantization::INT8:
+            this->set_quantization(type, DECODER_QUANT_INT8_SCALE, DECODER_QUANT_INT8_CLIP);
+            break;
+        default:
+            this->set_quantization(type, 1.0f, 0);
+    }
+}
+
+void ldpc::decoder::set_quantization(quantization::type_t type, softbit_t scale, uint64_t clip) {
+    const uint64_t clip_max = (type == quantization::INT16) ? INT16_MAX : ((type == quantization::INT8) ? INT8_MAX : 0);
     
-    len = 0;
-    errno = 0;
-    //fprintf(stdout, "Parsing line: '%s'\n", line);
-    for (unsigned long long i = strtoull(line, &end, 10); line != end; i = strtoull(line, &end, 10)) {
-        //fprintf(stdout, "'%.*s' -> %lld", (int)(end-line), line, i);
-        line = end;
-        if (errno == ERANGE){
-            fprintf(stderr, "Read number is out of range.\n");
+    if(type != quantization::FLOAT) {
+        if(!(scale > 0.0f)) {
+            fprintf(stderr, "Quantization scale %f is not positive.\n", static_cast<double>(scale));
+            exit( EXIT_FAILURE );
+        }
+        if(clip == 0 || clip > clip_max) {
+            fprintf(stderr, "Quantization clipping %lu is not in [1,%lu].\n", clip, clip_max);
             exit( EXIT_FAILURE );
-        } else {
-            // Value in range
-            
-            if(!ignore_zeros || i != 0) {
-                ret[len++] = (uint64_t) i;
-            }
         }
-        errno = 0;
-    }
-    
-    free(line_alloc);
-    
-    if(len != num) {
-        fprintf(stderr, "%lu numbers read in %s line, but %lu were expected.\n", len, line_descr, num);
-        exit( EXIT_FAILURE );
     }
     
-    return;
+    this->quant = type;
+    this->quant_scale = scale;
+    this->quant_clip = clip;
 }
 
-uint64_t ldpc::decoder::get_num_input(void) const {
-    return this->M - this->punctconf->num_punct;
+ldpc::decoder::decoder(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, const uint64_t *column_order) {
+    this->graph = new code(alist_file, systype, punctconf, column_order);
+    this->own_graph = true;
+    
+    this->init_workspace();
 }
 
-uint64_t ldpc::decoder::get_num_output(void) const {
-    return (this->systype == systematic::NONE) ? this->M : this->K;
-}
-        
-ldpc::decoder::decoder(const char* alist_file, systematic::systematic_t systype, puncturing::conf_t *punctconf) {
+ldpc::decoder::decoder(const code *c) {
+    this->graph = c;
+    this->own_graph = false;
     
-    // Read in N, M, K, nlist, mlist, nlist_num, mlist_num
-    this->parse_alist(alist_file);
+    this->init_workspace();
+}
+
+void ldpc::decoder::init_workspace(void) {
+    // Allocate node and message memory
+    this->channel = new softbit_t[this->graph->M];
+    this->posterior = new softbit_t[this->graph->M];
+    this->msg_b2c = new softbit_t[this->graph->E];
+    this->msg_c2b = new softbit_t[this->graph->E];
+    this->posterior_sum = new llrsum_t[this->graph->M];
+    this->check_buf = new softbit_t[2*this->graph->max_check_degree];
     
-    // Store systematics configuration
-    this->systype = systype;
+    bits_last_it = new softbit_t[this->graph->M];
+    this->best_posterior = new softbit_t[this->graph->M];
+    this->deadline = 0;
     
-    // Store puncturing configuration
-    this->punctconf = punctconf;
+    this->bit_hard = new uint8_t[this->graph->M];
+    this->check_parity = new uint8_t[this->graph->N];
+    this->check_undef = new uint64_t[this->graph->N];
+    this->check_weight = new int64_t[this->graph->N];
+    this->bit_weight = new softbit_t[this->graph->M];
     
-    // Initialize parity check nodes
-    this->check_nodes = new check_node*[this->N];
-    for(size_t i=0; i<this->N; i++) {
-        this->check_nodes[i] = new check_node(this->nlist_num[i]);
-    }
+    this->phi_table = NULL;
+    this->set_algorithm(checknode::SUM_PRODUCT);
+    this->set_schedule(schedule::FLOODING);
+    this->set_domain(llr::LOG10);
+    this->set_quantization(quantization::FLOAT);
+    this->set_stopping(stopping::conf_t());
     
-    // Initialize bit nodes
-    this->bit_nodes = new bit_node*[this->M];
-    for(size_t i=0; i<this->M; i++) {
-        this->bit_nodes[i] = new bit_node(this->mlist_num[i]);
-    }
+    this->batch_work = NULL;
+    this->batch_work_i16 = NULL;
+    this->batch_work_i8 = NULL;
+    this->single_work_i16 = NULL;
+    this->single_work_i8 = NULL;
     
-    bits_last_it = new softbit_t[this->M];
+    this->guess_decoders = NULL;
+    this->num_guess_decoders = 0;
 }
 
 ldpc::decoder::~decoder() {
-    for(size_t i=0; i<this->N ;i++) {
-        delete[] this->nlist[i];
+    delete[] this->channel;
+    delete[] this->posterior;
+    delete[] this->msg_b2c;
+    delete[] this->msg_c2b;
+    delete[] this->posterior_sum;
+    delete[] this->check_buf;
+    
+    delete[] bits_last_it;
+    delete[] this->best_posterior;
+    
+    delete[] this->bit_hard;
+    delete[] this->check_parity;
+    delete[] this->check_undef;
+    delete[] this->check_weight;
+    delete[] this->bit_weight;
+    delete this->phi_table;
+    
+    batch::free_work(this->batch_work);
+    batch::free_work(this->batch_work_i16);
+    batch::free_work(this->batch_work_i8);
+    batch::free_work(this->single_work_i16);
+    batch::free_work(this->single_work_i8);
+    
+    for(uint64_t i=0; i<this->num_guess_decoders; i++) {
+        delete this->guess_decoders[i];
     }
-    delete[] this->nlist;
-    delete[] this->nlist_num;
+    delete[] this->guess_decoders;
     
-    for(size_t i=0; i<this->M ;i++) {
-        delete[] this->mlist[i];
+    if(this->own_graph) {
+        delete this->graph;
     }
-    delete[] this->mlist;
-    delete[] this->mlist_num;
+}
+
+ldpc::softbit_t ldpc::decoder::get_final_value(const uint64_t bit_indx) const {
+#if LDPC_DO_SANITY_CHECKS
+    if(isnan(this->posterior[bit_indx])) {
+        fprintf(stderr, "ERROR: Access to bits final estimate, before it is computed.\n");
+        exit( EXIT_FAILURE );
+    }
+#endif
     
-    delete[] bits_last_it;
+    return this->posterior[bit_indx];
 }
 
 bool ldpc::decoder::get_syndrome(const uint64_t check_indx, bool *defined) const {
     softbit_t tmp_bit;
     bool s_i = false;
-    
+
 #if LDPC_DO_SANITY_CHECKS
-    if(check_indx >= this->N) {
+    if(check_indx >= this->graph->N) {
         fprintf(stderr, "ERROR: Check index too large in ldpc::decoder::get_syndrome(%lu)\n", check_indx);
         exit( EXIT_FAILURE );
     }
 #endif
-
-    for(uint64_t j=0; j<this->nlist_num[check_indx]; j++) {
+    
+    for(uint64_t e=this->graph->check_offsets[check_indx]; e<this->graph->check_offsets[check_indx+1]; e++) {
         
-        tmp_bit = this->bit_nodes[this->nlist[check_indx][j]-1]->get_buffered_final_value();
+        tmp_bit = this->get_final_value(this->graph->check_edges[e]);
         
-        if(my_abs(tmp_bit) < DECODER_MIN_LLR_MAG) {
+        if(my_abs(tmp_bit) < this->stop.min_llr_mag) {
             // bit undefined, set syndrome to false
             if(defined) {
                 *defined = false;
@@ -215,60 +291,132 @@ bool ldpc::decoder::get_syndrome(const uint64_t check_indx, bool *defined) const
     return s_i;
 }
 
-uint64_t ldpc::decoder::get_syndrome_count(void) const {
-    uint64_t count=0;
-    for(size_t i=0; i<this->N; i++) {
-        // do not trust check nodes syndrome, because they do not contain the final bit falue estmates
-        //count += (this->check_nodes[i]->isFullfilled()) ? 0 : 1;
+void ldpc::decoder::reset_syndrome(void) {
+    const double one = static_cast<double>(static_cast<int64_t>(1) << DECODER_AWRM_FRAC_BITS);
+    
+    // Before the first iteration all bits are undefined
+    this->awrm_sum = 0;
+    for(uint64_t i=0; i<this->graph->M; i++) {
+        this->bit_hard[i] = 2;
+        this->bit_weight[i] = my_abs(std::tanh(this->channel[i]*this->llr_nats/2.0f));
+        this->awrm_sum -= std::llround(this->bit_weight[i]*one);
+    }
+    
+    this->num_unsatisfied = 0;
+    for(uint64_t j=0; j<this->graph->N; j++) {
+        const uint64_t first = this->graph->check_offsets[j];
+        const uint64_t last = this->graph->check_offsets[j+1];
+        
+        this->check_parity[j] = 0;
+        this->check_undef[j] = last - first;
+        this->num_unsatisfied += (this->check_undef[j] > 0) ? 1u : 0u;
+        
+        // Every bit gets the smallest reliability of all other bits, which is the second smallest one for the
+        // least reliable bit. Without other bits there is no reliability below the largest one.
+        softbit_t min1 = 1.0f;
+        softbit_t min2 = 1.0f;
+        for(uint64_t e=first; e<last; e++) {
+            const softbit_t w = this->bit_weight[this->graph->check_edges[e]];
+            if(w < min1) {
+                min2 = min1;
+                min1 = w;
+            } else if(w < min2) {
+                min2 = w;
+            }
+        }
+        const double weight = (last > first) ? static_cast<double>(last-first-1)*static_cast<double>(min1) + static_cast<double>(min2) : 0.0;
+        this->check_weight[j] = std::llround(weight*one);
         
-        count += (this->get_syndrome(i)) ? 1u : 0u;
+        // A check contributes its weight if satisfied and subtracts it otherwise
+        this->awrm_sum += this->is_unsatisfied(j) ? -this->check_weight[j] : this->check_weight[j];
+    }
+}
+
+void ldpc::decoder::update_syndrome(const uint64_t bit_indx, const softbit_t value) {
+    // 0 for positive, 1 for negative and 2 for undefined LLRs, like in get_syndrome()
+    const uint8_t hard = (my_abs(value) < this->stop.min_llr_mag) ? 2 : ((value < 0.0f) ? 1 : 0);
+    const uint8_t old_hard = this->bit_hard[bit_indx];
+    
+    if(hard == old_hard) {
+        return;
     }
+    this->bit_hard[bit_indx] = hard;
     
-    return count;
+    // Only the checks of a flipped bit change
+    for(uint64_t f=this->graph->bit_offsets[bit_indx]; f<this->graph->bit_offsets[bit_indx+1]; f++) {
+        const uint64_t j = this->graph->bit_edges[f];
+        const bool was_unsatisfied = this->is_unsatisfied(j);
+        
+        this->check_undef[j] -= (old_hard == 2) ? 1u : 0u;
+        this->check_undef[j] += (hard == 2) ? 1u : 0u;
+        this->check_parity[j] ^= static_cast<uint8_t>((old_hard == 1) != (hard == 1));
+        
+        const bool unsatisfied = this->is_unsatisfied(j);
+        if(unsatisfied != was_unsatisfied) {
+            this->num_unsatisfied = unsatisfied ? this->num_unsatisfied+1 : this->num_unsatisfied-1;
+            this->awrm_sum += unsatisfied ? -2*this->check_weight[j] : 2*this->check_weight[j];
+        }
+    }
 }
 
-double ldpc::decoder::get_awrm(void) const {
-    //Asserts floating point compatibility at compile time
-    static_assert(std::numeric_limits<float>::is_iec559, "IEEE 754 required to support +/- infinity floats");
-
-    double ret=0.0;
-    double e_i;
-    double s_j;
-    double abs_yi;
-    double w_ij_tmp;
-    double w_ij = std::numeric_limits<float>::infinity();
-    uint64_t j_indx, j;
-    uint64_t k_indx, k;
-    
-    for(uint64_t i=0; i<this->M; i++) {
-        //printf("Computing AWRM for bit %lu\n", i);
-        abs_yi = my_abs(tanh(this->bit_nodes[i]->channel_value));
-        //printf("  |y_i| = %lf\n", abs_yi);
-        
-        e_i = 0.0;
-        for(j_indx=0; j_indx<this->mlist_num[i]; j_indx++) {
-            j=this->mlist[i][j_indx]-1;
-            s_j = (this->get_syndrome(j)) ? 0.0 : 1.0;
-            
-            w_ij = std::numeric_limits<float>::infinity();
-            for(k_indx=0; k_indx<this->nlist_num[j]; k_indx++) {
-                k = this->nlist[j][k_indx]-1;
-                if(k==i) {
-                    continue;
-                }
-                w_ij_tmp = my_abs(tanh(this->bit_nodes[k]->channel_value));
-                w_ij = (w_ij <= w_ij_tmp) ? w_ij : w_ij_tmp;
-            }
-            //printf("  j=%4lu: s_j=%3lf w_ij=%12lf, ()=%12lf\n", j, s_j, w_ij, (2.0*s_j-1.0)*w_ij);
-            e_i += (2.0*s_j-1.0)*w_ij;
+bool ldpc::decoder::is_unsatisfied(const uint64_t check_indx) const {
+    return this->check_undef[check_indx] > 0 || this->check_parity[check_indx] != 0;
+}
+
+void ldpc::decoder::verify_syndrome(void) const {
+    const double one = static_cast<double>(static_cast<int64_t>(1) << DECODER_AWRM_FRAC_BITS);
+    
+    uint64_t num_unsatisfied = 0;
+    int64_t awrm_sum = 0;
+    for(uint64_t i=0; i<this->graph->M; i++) {
+        const softbit_t value = this->get_final_value(i);
+        const uint8_t hard = (my_abs(value) < this->stop.min_llr_mag) ? 2 : ((value < 0.0f) ? 1 : 0);
+        if(hard != this->bit_hard[i]) {
+            fprintf(stderr, "ERROR: Hard decision of bit %lu is %u, tracked as %u.\n", i, hard, this->bit_hard[i]);
+            exit( EXIT_FAILURE );
         }
-        //printf("sum(.) = %12lf, e_{%4lu} = %12lf\n", e_i, i, e_i-abs_yi);
-        e_i -= abs_yi;
+        awrm_sum -= std::llround(this->bit_weight[i]*one);
+    }
+    
+    for(uint64_t j=0; j<this->graph->N; j++) {
+        const uint64_t first = this->graph->check_offsets[j];
+        const uint64_t last = this->graph->check_offsets[j+1];
+        
+        const bool unsatisfied = this->get_syndrome(j);
+        if(unsatisfied != this->is_unsatisfied(j)) {
+            fprintf(stderr, "ERROR: Check %lu is %s, tracked as %s.\n", j, unsatisfied ? "unsatisfied" : "satisfied", unsatisfied ? "satisfied" : "unsatisfied");
+            exit( EXIT_FAILURE );
+        }
+        num_unsatisfied += unsatisfied ? 1u : 0u;
         
-        ret += e_i;
+        // Weights w_ij of the other bits, which may differ in the last fixed point digit from the two minima
+        double weight = 0.0;
+        for(uint64_t e=first; e<last; e++) {
+            softbit_t w = 1.0f;
+            for(uint64_t f=first; f<last; f++) {
+                const softbit_t wf = this->bit_weight[this->graph->check_edges[f]];
+                w = (f != e && wf < w) ? wf : w;
+            }
+            weight += static_cast<double>(w);
+        }
+        if(std::llabs(std::llround(weight*one) - this->check_weight[j]) > 1) {
+            fprintf(stderr, "ERROR: Weight of check %lu is %f, computed as %f.\n", j, weight, static_cast<double>(this->check_weight[j])/one);
+            exit( EXIT_FAILURE );
+        }
+        awrm_sum += unsatisfied ? -this->check_weight[j] : this->check_weight[j];
     }
     
-    return ret/static_cast<double>(this->M);
+    if(num_unsatisfied != this->num_unsatisfied || awrm_sum != this->awrm_sum) {
+        fprintf(stderr, "ERROR: %lu unsatisfied checks and AWRM sum %ld, tracked as %lu and %ld.\n", num_unsatisfied, awrm_sum, this->num_unsatisfied, this->awrm_sum);
+        exit( EXIT_FAILURE );
+    }
+}
+
+double ldpc::decoder::get_awrm(void) const {
+    // sum_i ( sum_j (2*s_j-1)*w_ij - |y_i| ) over all bits i and their checks j, with s_j=1 for satisfied
+    // checks, is tracked per check by reset_syndrome() and update_syndrome()
+    const double one = static_cast<double>(static_cast<int64_t>(1) << DECODER_AWRM_FRAC_BITS);
+    return static_cast<double>(this->awrm_sum)/one/static_cast<double>(this->graph->M);
 }
 
 ldpc::softbit_t ldpc::decoder::llrdiff(const ldpc::softbit_t a, const ldpc::softbit_t b) const {
@@ -301,36 +449,228 @@ void ldpc::decoder::debug_check(const uint64_t check_indx) {
     bool tmp_syn_def;
     bool tmp_syn = this->get_syndrome(check_indx, &tmp_syn_def);
     printf("Debug check node %lu\n", check_indx);
-    for(uint64_t i=0; i<this->nlist_num[check_indx]; i++) {
-        uint64_t j=this->nlist[check_indx][i]-1;
-        
-	bool flag = false;
-        uint64_t check_number=0;
-        for(size_t k=0; k<this->mlist_num[j]; k++) {
-            if(this->mlist[j][k]-1 == check_indx) {
-                check_number = k;
-		flag = true;
-                break;
-            }
-        }
-        if(flag) {
-	    printf("  no check number found.\n");
-	} else {
-            printf("  connected to bit %lu: %12f final: %12f\n", j, this->bit_nodes[j]->computeValForCheck(check_number, false), this->bit_nodes[j]->get_buffered_final_value());
-	}
+    for(uint64_t e=this->graph->check_offsets[check_indx]; e<this->graph->check_offsets[check_indx+1]; e++) {
+        uint64_t j=this->graph->check_edges[e];
+        
+        printf("  connected to bit %lu: %12f final: %12f\n", j, this->msg_b2c[e], this->get_final_value(j));
     }
     printf("  syndrome: %s%1u%s\n", tmp_syn_def ? " " : "(", tmp_syn ? 1u : 0u, tmp_syn_def ? " " : ")");
 }
 
+void ldpc::decoder::update_bits(void) {
+    llrsum_t sum;
+    llrsum_t sum_extr;
+    
+    for(uint64_t bit_indx=0; bit_indx<this->graph->M; bit_indx++) {
+        const uint64_t first = this->graph->bit_offsets[bit_indx];
+        const uint64_t last = this->graph->bit_offsets[bit_indx+1];
+        
+        // Sum up channel value and all check messages
+        llrsum_reset(&sum);
+        llrsum_add(&sum, this->channel[bit_indx]);
+        for(uint64_t f=first; f<last; f++) {
+            llrsum_add(&sum, this->msg_c2b[f]);
+        }
+        
+        // Final estimate includes all check messages
+        this->posterior[bit_indx] = llrsum_get(&sum);
+        
+        // Message to a check includes all check messages, but the one of the receiving check
+        for(uint64_t f=first; f<last; f++) {
+            sum_extr = sum;
+            llrsum_sub(&sum_extr, this->msg_c2b[f]);
+            this->msg_b2c[this->graph->edge_b2c[f]] = llrsum_get(&sum_extr);
+        }
+    }
+}
+
+void ldpc::decoder::update_checks(void) {
+    for(uint64_t check_indx=0; check_indx<this->graph->N; check_indx++) {
+        this->update_check(check_indx);
+    }
+}
+
+void ldpc::decoder::update_check(const uint64_t check_indx) {
+    if(this->algorithm == checknode::SUM_PRODUCT) {
+        this->update_check_sum_product(check_indx);
+    } else if(this->algorithm == checknode::SUM_PRODUCT_PHI) {
+        this->update_check_phi(check_indx);
+    } else {
+        this->update_check_min_sum(check_indx);
+    }
+}
+
+void ldpc::decoder::update_layered(void) {
+    for(uint64_t check_indx=0; check_indx<this->graph->N; check_indx++) {
+        // Leave the rest of the iteration once the time is up, the posterior stays consistent between checks
+        if(check_indx % DECODER_DEADLINE_CHECKS == 0 && timing::passed(this->deadline)) {
+            break;
+        }
+        
+        const uint64_t first = this->graph->check_offsets[check_indx];
+        const uint64_t last = this->graph->check_offsets[check_indx+1];
+        
+        // Remove the old message of this check from the posterior to get the message to the check
+        for(uint64_t e=first; e<last; e++) {
+            llrsum_t *sum = &this->posterior_sum[this->graph->check_edges[e]];
+            llrsum_sub(sum, this->msg_c2b[this->graph->edge_c2b[e]]);
+            this->msg_b2c[e] = llrsum_get(sum);
+        }
+        
+        this->update_check(check_indx);
+        
+        // Add the new message of this check to the posterior
+        for(uint64_t e=first; e<last; e++) {
+            llrsum_add(&this->posterior_sum[this->graph->check_edges[e]], this->msg_c2b[this->graph->edge_c2b[e]]);
+        }
+    }
+    
+    for(uint64_t bit_indx=0; bit_indx<this->graph->M; bit_indx++) {
+        this->posterior[bit_indx] = llrsum_get(&this->posterior_sum[bit_indx]);
+    }
+}
+
+void ldpc::decoder::update_check_sum_product(const uint64_t check_indx) {
+    const uint64_t first = this->graph->check_offsets[check_indx];
+    const uint64_t num = this->graph->check_offsets[check_indx+1] - first;
+    
+    softbit_t *bit_values = this->check_buf;
+    softbit_t *sum_front = &this->check_buf[this->graph->max_check_degree];
+    softbit_t tmp_sum;
+    
+    // Convert all incoming messages to natural LLRs and compute the box-plus sums of all values in front of each one
+    tmp_sum = std::numeric_limits<softbit_t>::infinity();
+    for(uint64_t i=0; i<num; i++) {
+        bit_values[i] = this->msg_b2c[first+i]*this->llr_nats;
+        sum_front[i] = tmp_sum;
+        tmp_sum = approx::boxplus(tmp_sum, bit_values[i]);
+    }
+    
+    // combine with the sum of all values behind, to get the sum of all values but the own one
+    tmp_sum = std::numeric_limits<softbit_t>::infinity();
+    for(uint64_t i=num; i-- > 0;) {
+        this->msg_c2b[this->graph->edge_c2b[first+i]] = approx::boxplus(sum_front[i], tmp_sum)/this->llr_nats;
+        tmp_sum = approx::boxplus(tmp_sum, bit_values[i]);
+    }
+}
+
+void ldpc::decoder::update_check_min_sum(const uint64_t check_indx) {
+    const uint64_t first = this->graph->check_offsets[check_indx];
+    const uint64_t last = this->graph->check_offsets[check_indx+1];
+    
+    // Find the two smallest magnitudes and the parity of all signs
+    softbit_t min1 = std::numeric_limits<softbit_t>::infinity();
+    softbit_t min2 = std::numeric_limits<softbit_t>::infinity();
+    uint64_t min1_indx = first;
+    bool sign = false;
+    
+    for(uint64_t e=first; e<last; e++) {
+        const softbit_t val = this->msg_b2c[e];
+        const softbit_t mag = my_abs(val);
+        
+        sign ^= (val < 0.0f);
+        
+        if(mag < min1) {
+            min2 = min1;
+            min1 = mag;
+            min1_indx = e;
+        } else if(mag < min2) {
+            min2 = mag;
+        }
+    }
+    
+    // Apply correction to both magnitudes
+    if(this->algorithm == checknode::NORMALIZED_MIN_SUM) {
+        min1 *= this->algorithm_param;
+        min2 *= this->algorithm_param;
+    } else if(this->algorithm == checknode::OFFSET_MIN_SUM) {
+        min1 = (min1 > this->algorithm_param) ? min1-this->algorithm_param : 0.0f;
+        min2 = (min2 > this->algorithm_param) ? min2-this->algorithm_param : 0.0f;
+    }
+    
+    // Every edge gets the smallest magnitude of all other edges and the parity of all other signs
+    for(uint64_t e=first; e<last; e++) {
+        const softbit_t mag = (e == min1_indx) ? min2 : min1;
+        this->msg_c2b[this->graph->edge_c2b[e]] = (sign ^ (this->msg_b2c[e] < 0.0f)) ? -mag : mag;
+    }
+}
+
+void ldpc::decoder::update_check_phi(const uint64_t check_indx) {
+    const uint64_t first = this->graph->check_offsets[check_indx];
+    const uint64_t num = this->graph->check_offsets[check_indx+1] - first;
+    
+    // phi takes and returns natural LLRs
+    const softbit_t out_scale = 1.0f/this->llr_nats;
+    
+    softbit_t *bit_phi = this->check_buf;
+    softbit_t sum = 0.0f;
+    bool sign = false;
+    
+    // Sum phi of all incoming magnitudes and the parity of all signs
+    for(uint64_t i=0; i<num; i++) {
+        const softbit_t val = this->msg_b2c[first+i];
+        sign ^= (val < 0.0f);
+        bit_phi[i] = this->phi_table->lookup(my_abs(val)*this->llr_nats);
+        sum += bit_phi[i];
+    }
+    
+    // Every edge gets phi of the sum of all other phi values and the parity of all other signs
+    for(uint64_t i=0; i<num; i++) {
+        const softbit_t mag = this->phi_table->lookup(sum - bit_phi[i])*out_scale;
+        this->msg_c2b[this->graph->edge_c2b[first+i]] = (sign ^ (this->msg_b2c[first+i] < 0.0f)) ? -mag : mag;
+    }
+}
+
+bool ldpc::decoder::is_sum_product(void) const {
+    return this->algorithm == checknode::SUM_PRODUCT || this->algorithm == checknode::SUM_PRODUCT_PHI;
+}
+
 bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *meta, const char *debugout) {
+    // Fixed point decoding of a single frame
+    if(!this->is_sum_product()) {
+        if(this->quant == quantization::INT16) {
+            return this->decode_lanes<int16_t>(&out, &input, 1, meta, batch::decode_single_i16, 1, &this->single_work_i16);
+        }
+        if(this->quant == quantization::INT8) {
+            return this->decode_lanes<int8_t>(&out, &input, 1, meta, batch::decode_single_i8, 1, &this->single_work_i8);
+        }
+    }
+    
+    this->load_channel(input);
+    return this->decode_channel(out, meta, debugout);
+}
+
+void ldpc::decoder::load_channel(const softbit_t *input) {
+    const uint64_t num_input = this->graph->get_num_input();
+    
+    // Punctured bits stay at zero
+    std::memset(this->channel, 0, this->graph->M*sizeof(softbit_t));
+    for(uint64_t j=0; j<num_input; j++) {
+        this->channel[this->graph->input_bits[j]] = input[j];
+    }
+}
+
+bool ldpc::decoder::decode_channel(softbit_t *out, metadata_t *meta, const char *debugout) {
     uint64_t i, j;
     
-    j=0;
-    for(i=0; i<this->M; i++) {
-        if(this->punctconf->is_punctured(i, this->M)) {
-            this->bit_nodes[i]->reset(0.0f);
-        } else {
-            this->bit_nodes[i]->reset(input[j++]);
+    for(i=0; i<this->graph->M; i++) {
+        this->posterior[i] = static_cast<softbit_t>(nan("")); // mark value as unset
+        
+        // No previous iteration to compare against
+        this->bits_last_it[i] = static_cast<softbit_t>(nan(""));
+    }
+    
+    // Reset check messages
+    for(i=0; i<this->graph->E; i++) {
+        this->msg_c2b[i] = 0.0f;
+    }
+    this->reset_syndrome();
+    
+    // Posterior of the layered schedule starts with the channel information only
+    if(this->sched == schedule::LAYERED) {
+        for(i=0; i<this->graph->M; i++) {
+            llrsum_reset(&this->posterior_sum[i]);
+            llrsum_add(&this->posterior_sum[i], this->channel[i]);
         }
     }
     
@@ -356,30 +696,23 @@ bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *m
     
     uint64_t awrm_counter = 0;
     double awrm_tmp = nan("");
-#if DECODER_MAX_AWRM_ITERATIONS<DECODER_MAX_ITERATIONS
     double awrm_min = 0.0;
-#endif
+    const bool use_awrm = !this->stop.syndrome_only && this->stop.max_awrm_iterations < this->stop.max_iterations;
+    const bool use_delta = !this->stop.syndrome_only && this->stop.min_llr_delta >= 0.0f;
+    
+    this->deadline = timing::deadline(this->stop.max_time_us);
+    bool deadline_passed = false;
+    uint64_t best_count = this->graph->N+1;
     
-    std::memcpy(bits_last_it, input, this->M*sizeof(softbit_t));
     softbit_t tmp_softbit, delta_bits_sum;
     
     do {
-        // Propagate new round
-        for(i=0;i<this->N;i++) {
-            this->check_nodes[i]->new_round();
-        }
-        for(i=0;i<this->M;i++) {
-            this->bit_nodes[i]->new_round();
-        }
-        
-        // propagate values from bit nodes to check nodes
-        for(bit_indx=0; bit_indx<this->M; bit_indx++) {
-            for(i=0; i<this->mlist_num[bit_indx]; i++) {
-                check_indx = this->mlist[bit_indx][i]-1;
-                this->check_nodes[check_indx]->set_bit_value(this->bit_nodes[bit_indx]->computeValForCheck(i, false));
-            }
-            // Compute final estimate
-            this->bit_nodes[bit_indx]->computeValForCheck(0, true);
+        if(this->sched == schedule::LAYERED) {
+            // process all checks and compute final estimates
+            this->update_layered();
+        } else {
+            // propagate values from bit nodes to check nodes and compute final estimates
+            this->update_bits();
         }
         
         // Evaluate syndromes at first iteration
@@ -388,10 +721,10 @@ bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *m
             bool tmp_syndrome;
             bool tmp_syndrome_def;
             
-            for(check_indx=0; check_indx<this->N; check_indx++) {
-                for(i=0; i<this->nlist_num[check_indx]; i++) {
-                    bit_indx = this->nlist[check_indx][i]-1;
-                    contains_punct = this->punctconf->is_punctured(bit_indx, this->M) ? true : contains_punct;
+            for(check_indx=0; check_indx<this->graph->N; check_indx++) {
+                for(i=this->graph->check_offsets[check_indx]; i<this->graph->check_offsets[check_indx+1]; i++) {
+                    bit_indx = this->graph->check_edges[i];
+                    contains_punct = this->graph->punctured[bit_indx] ? true : contains_punct;
                 }
                 
                 if(debugout) {
@@ -411,7 +744,7 @@ bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *m
                     }
                 }
             }
-	    
+            
             if(debugout) {
                     printf("== Check results: ==\n");
                     printf("  %4lu checks SUCCEDED\n", syndrome_num_fulfilled);
@@ -421,65 +754,76 @@ bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *m
                     printf("====================\n");
             }
         }
-
-        // propagate check values back to bit nodes
-        for(check_indx=0; check_indx<this->N; check_indx++) {
-            for(i=0; i<this->nlist_num[check_indx]; i++) {
-                bit_indx = this->nlist[check_indx][i]-1;
-                this->bit_nodes[bit_indx]->set_check_value(this->check_nodes[check_indx]->computeValForMessage(i));
-            }
-        }
-        
-        // Compute number of unfulfilled syndromes
-        syndrome_count = this->get_syndrome_count();
         
-        // AWRM stopping criterion
-#if DECODER_MAX_AWRM_ITERATIONS<DECODER_MAX_ITERATIONS
-        awrm_tmp = this->get_awrm();
-        if(awrm_tmp < awrm_min) {
-            awrm_min = awrm_tmp;
-            awrm_counter = 0;
-        } else {
-            awrm_counter++;
+        // propagate check values back to bit nodes
+        if(this->sched == schedule::FLOODING) {
+            this->update_checks();
         }
-#endif
-
-        //printf("  Decoding round gave %u syndrome errors.\n", syndrome_count);
-        iteration_counter++;
         
-        // See if bits have settled
+        // See if bits have settled and track the checks of bits whose hard decision flipped
         //printf("Compute LLR delta sum\n");
         delta_bits_sum = 0.0f;
-        for(bit_indx=0; bit_indx<this->M; bit_indx++) {
-            tmp_softbit = this->bit_nodes[bit_indx]->get_buffered_final_value();
+        for(bit_indx=0; bit_indx<this->graph->M; bit_indx++) {
+            tmp_softbit = this->get_final_value(bit_indx);
             //printf(" %4lu: old %12f => new %12f => |diff| %12f\n", bit_indx, bits_last_it[bit_indx], tmp_softbit, my_abs(llrdiff(bits_last_it[bit_indx],tmp_softbit)));
             //printf("%12.4f + %12.4f = %12.4f\n", delta_bits_sum, my_abs(llrdiff(bits_last_it[bit_indx],tmp_softbit)), delta_bits_sum+my_abs(llrdiff(bits_last_it[bit_indx],tmp_softbit)) );
             delta_bits_sum += my_abs(llrdiff(bits_last_it[bit_indx],tmp_softbit));
             bits_last_it[bit_indx] = tmp_softbit;
+            this->update_syndrome(bit_indx, tmp_softbit);
         }
-        //printf("%12.4f / %12.4f = %12.4f\n", delta_bits_sum, (softbit_t)this->M, delta_bits_sum / (softbit_t)this->M );
-        delta_bits_sum /= (softbit_t)this->M;
+        //printf("%12.4f / %12.4f = %12.4f\n", delta_bits_sum, (softbit_t)this->graph->M, delta_bits_sum / (softbit_t)this->graph->M );
+        delta_bits_sum /= (softbit_t)this->graph->M;
+        
+        // Compute number of unfulfilled syndromes
+        syndrome_count = this->num_unsatisfied;
+#ifndef NDEBUG
+        // Builds with assertions recompute the tracked state after every iteration
+        this->verify_syndrome();
+#endif
+        
+        // AWRM stopping criterion
+        if(use_awrm) {
+            awrm_tmp = this->get_awrm();
+            if(awrm_tmp < awrm_min) {
+                awrm_min = awrm_tmp;
+                awrm_counter = 0;
+            } else {
+                awrm_counter++;
+            }
+        }
+        
+        // Time limit of the frame, keep the best estimate in case it is reached before convergence
+        if(this->deadline != 0) {
+            if(syndrome_count < best_count) {
+                best_count = syndrome_count;
+                std::memcpy(this->best_posterior, this->posterior, this->graph->M*sizeof(softbit_t));
+            }
+            deadline_passed = timing::passed(this->deadline);
+        }
+        
+        //printf("  Decoding round gave %u syndrome errors.\n", syndrome_count);
+        iteration_counter++;
         
         
         // Print probability of ones to debug file
         if(debugf) {
-            for(bit_indx=0; bit_indx<this->M; bit_indx++) {
-                fprintf(debugf, "%f ", ldpc::llr2prob(this->bit_nodes[bit_indx]->get_buffered_final_value()));
+            for(bit_indx=0; bit_indx<this->graph->M; bit_indx++) {
+                fprintf(debugf, "%f ", ldpc::llr2prob(this->get_final_value(bit_indx), this->domain));
             }
             fprintf(debugf, "\n");
-            printf("  decoding round %4lu/%4u, %4lu syndrome errors, AWRM = %12lf (%4lu/%4u), delta LLRs=%12le.\n", iteration_counter, DECODER_MAX_ITERATIONS, syndrome_count, awrm_tmp, awrm_counter, DECODER_MAX_AWRM_ITERATIONS, delta_bits_sum);
+            printf("  decoding round %4lu/%4lu, %4lu syndrome errors, AWRM = %12lf (%4lu/%4lu), delta LLRs=%12le.\n", iteration_counter, this->stop.max_iterations, syndrome_count, awrm_tmp, awrm_counter, this->stop.max_awrm_iterations, delta_bits_sum);
             
             /*
             if(syndrome_count > 0) {
                 if(syndrome_count < 5) {
-                    for(size_t i=0; i<this->N; i++) {
+                    for(size_t i=0; i<this->graph->N; i++) {
                         if(this->get_syndrome(i)) {
                             this->debug_check(i);
                         }
                     }
                 } else {
                     printf("  unfulfilled syndromes are: ");
-                    for(size_t i=0; i<this->N; i++) {
+                    for(size_t i=0; i<this->graph->N; i++) {
                         if(this->get_syndrome(i)) {
                             printf("%lu ", i);
                         }
@@ -490,231 +834,391 @@ bool ldpc::decoder::decode(softbit_t *out, const softbit_t *input, metadata_t *m
             //*/
             
             /*
-            const uint64_t debug_check = 227;
-            bool tmp_syn_def;
-            bool tmp_syn = this->get_syndrome(debug_check, &tmp_syn_def);
-            printf("Tracking check node %lu\n", debug_check);
-            for(uint64_t i=0; i<this->nlist_num[debug_check]; i++) {
-                uint64_t j=this->nlist[debug_check][i]-1;
-                
-                uint64_t check_number;
-                for(size_t k=0; k<this->mlist_num[j]; k++) {
-                    if(this->mlist[j][k]-1 == debug_check) {
-                        check_number = k;
-                        break;
-                    }
-                }
-                
-                printf("  connected to bit %lu: %12f final: %12f\n", j, this->bit_nodes[j]->computeValForCheck(check_number, false), this->bit_nodes[j]->get_buffered_final_value());
-            }
-            printf("  syndrome: %s%1u%s\n", tmp_syn_def ? " " : "(", tmp_syn ? 1u : 0u, tmp_syn_def ? " " : ")");
+            this->debug_check(227);
             //*/
-            
-        }
         
-    } while(syndrome_count > 0 && iteration_counter < DECODER_MAX_ITERATIONS && awrm_counter < DECODER_MAX_AWRM_ITERATIONS && (isnan(delta_bits_sum) || delta_bits_sum>0.0f));
+        }
+    
+    } while(syndrome_count > 0 && iteration_counter < this->stop.max_iterations && (!use_awrm || awrm_counter < this->stop.max_awrm_iterations) && (!use_delta || isnan(delta_bits_sum) || delta_bits_sum>this->stop.min_llr_delta) && !deadline_passed);
     
     if(debugf) {
         fclose(debugf);
     }
     
+    // Degrade gracefully if the time ran out, an earlier iteration may have been closer to a codeword
+    if(deadline_passed && best_count < syndrome_count) {
+        std::memcpy(this->posterior, this->best_posterior, this->graph->M*sizeof(softbit_t));
+        syndrome_count = best_count;
+    }
+    this->deadline = 0;
+    
     uint64_t index_out_first;
     uint64_t index_out_last;
-    switch(this->systype) {
-        case systematic::NONE:
-            // Output all M bits
-            index_out_first = 0;
-            index_out_last = this->M;
-            break;
-        case systematic::FRONT:
-            // Output first K bits
-            index_out_first = 0;
-            index_out_last = this->K;
-            break;
-        case systematic::BACK:
-            // Output last K bits
-            index_out_first = this->M-this->K;
-            index_out_last = this->M;
-            break;
-        default:
-            fprintf(stderr, "State machine error.\n");
-            exit( EXIT_FAILURE );
-    }
+    this->graph->get_output_range(&index_out_first, &index_out_last);
     
     // Final iteration
     uint64_t ber_counter = 0;
     softbit_t tmp_bit;
     j=0;
-    for(i=0; i<this->M; i++) {
-        tmp_bit = this->bit_nodes[i]->get_buffered_final_value();
+    for(i=0; i<this->graph->M; i++) {
+        tmp_bit = this->get_final_value(i);
         
         if(i>=index_out_first && i<index_out_last) {
             out[j++] = tmp_bit;
         }
         
-        ber_counter += (!this->punctconf->is_punctured(i,this->M) && input[i]*tmp_bit<0.0f) ? 1u : 0u;
+        ber_counter += (!this->graph->punctured[i] && this->channel[i]*tmp_bit<0.0f) ? 1u : 0u;
     }
     
+    // A frame whose checks are all satisfied in the last iteration has been decoded, like in decode_batch()
     uint8_t fail_flags = NONE;
-    fail_flags |= (iteration_counter>=DECODER_MAX_ITERATIONS) ? MAX_ITERATIONS     : NONE;
-    fail_flags |= (awrm_counter>=DECODER_MAX_AWRM_ITERATIONS) ? AWRM_STOP          : NONE;
-    fail_flags |= (delta_bits_sum==0.0f)                      ? NO_SOFTBITS_CHANGE : NONE;
+    if(syndrome_count>0) {
+        fail_flags |= (iteration_counter>=this->stop.max_iterations)               ? MAX_ITERATIONS     : NONE;
+        fail_flags |= (use_awrm && awrm_counter>=this->stop.max_awrm_iterations)   ? AWRM_STOP          : NONE;
+        fail_flags |= (use_delta && delta_bits_sum<=this->stop.min_llr_delta)      ? NO_SOFTBITS_CHANGE : NONE;
+        fail_flags |= (deadline_passed)                                            ? DEADLINE           : NONE;
+    }
     
     bool success = (syndrome_count==0 && fail_flags==NONE);
     
     if(meta) {
         meta->num_iterations = iteration_counter;
-        meta->num_iterations_max = DECODER_MAX_ITERATIONS;
+        meta->num_iterations_max = this->stop.max_iterations;
         meta->success = success;
         meta->failure_flags = fail_flags;
         meta->syndrome_count = syndrome_count;
         meta->num_corrected = ber_counter;
-        meta->num_bits_total = this->M;
+        meta->num_bits_total = this->graph->M;
         meta->num_guesses = 0;
     }
     
     return success;
 }
 
-////
-//////  Parity check node
-////
-ldpc::decoder::check_node::check_node(const uint64_t NUM_BITS) : NUM_BITS(NUM_BITS) {
-    this->bit_values_tanh = new softbit_t[NUM_BITS];
-    this->tmp_indx = 0;
-    this->new_round();
-}
-
-ldpc::decoder::check_node::~check_node(void) {
-    delete[] this->bit_values_tanh;
-}
-
-void ldpc::decoder::check_node::new_round(void) {
-#if LDPC_DO_SANITY_CHECKS
-    if(this->tmp_indx != 0 && this->tmp_indx != this->NUM_BITS) {
-        fprintf(stderr, "Resetting parity check node, although not all values are read out (%lu/%lu)",this->tmp_indx, this->NUM_BITS );
-        exit( EXIT_FAILURE );
+bool ldpc::decoder::decode_batch(softbit_t **out, const softbit_t * const *input, uint64_t num_frames, metadata_t *meta) {
+    bool success = true;
+    uint64_t L;
+    
+    // Only the min-sum variants are vectorized
+    if(this->is_sum_product()) {
+        for(uint64_t f=0; f<num_frames; f++) {
+            success = this->decode(out[f], input[f], meta ? &meta[f] : NULL) && success;
+        }
+        return success;
     }
-#endif
-
-    this->tmp_indx = 0;
-}
-
-void ldpc::decoder::check_node::set_bit_value(softbit_t val) {
-    // compute tanh(LLR/2) and store it
-    this->bit_values_tanh[this->tmp_indx] = tanh(val/2.0f);
     
-    // increase counter
-    this->tmp_indx++;
+    switch(this->quant) {
+        case quantization::INT16: {
+            batch::kernel_i16_t kernel = batch::select_kernel_i16(&L);
+            return this->decode_lanes<int16_t>(out, input, num_frames, meta, kernel, L, &this->batch_work_i16);
+        }
+        case quantization::INT8: {
+            batch::kernel_i8_t kernel = batch::select_kernel_i8(&L);
+            return this->decode_lanes<int8_t>(out, input, num_frames, meta, kernel, L, &this->batch_work_i8);
+        }
+        default: {
+            batch::kernel_t kernel = batch::select_kernel(&L);
+            return this->decode_lanes<softbit_t>(out, input, num_frames, meta, kernel, L, &this->batch_work);
+        }
+    }
 }
 
-ldpc::softbit_t ldpc::decoder::check_node::computeValForMessage(uint64_t indx) const {
-    softbit_t tmp_prod = 1.0f;
+template<typename T> bool ldpc::decoder::decode_lanes(softbit_t **out, const softbit_t * const *input, uint64_t num_frames, metadata_t *meta, void (*kernel)(const batch::graph_t*, const batch::conf_t*, batch::work_t<T>*), uint64_t L, batch::work_t<T> **work) {
+    bool success = true;
+    
+    const batch::graph_t batch_graph = { this->graph->N, this->graph->M, this->graph->E, this->graph->max_check_degree, this->graph->check_offsets, this->graph->check_edges, this->graph->bit_offsets, this->graph->edge_b2c, this->graph->edge_c2b,
+        this->graph->Z, this->graph->base_rows, this->graph->block_offsets, this->graph->block_cols, this->graph->block_shifts };
     
-    for(size_t i=0; i<this->NUM_BITS; i++) {
-        if(i==indx) {
-            continue;
+    // Fixed point LLRs are scaled and rounded, floating point LLRs are only clipped
+    const bool fixed = !std::numeric_limits<T>::is_iec559;
+    const softbit_t scale = fixed ? this->quant_scale : 1.0f;
+    const softbit_t clip = fixed ? static_cast<softbit_t>(this->quant_clip) : DECODER_BATCH_LLR_MAX;
+    
+    const bool stop_unchanged = !this->stop.syndrome_only && this->stop.min_llr_delta >= 0.0f;
+    batch::conf_t conf = { this->algorithm, this->algorithm_param, this->sched, this->stop.max_iterations, this->stop.min_llr_mag, stop_unchanged, this->stop.max_time_us };
+    if(fixed) {
+        conf.algorithm_param = (this->algorithm == checknode::OFFSET_MIN_SUM) ? std::round(this->algorithm_param*scale) : this->algorithm_param;
+        conf.min_llr_mag = 1.0f;
+    }
+    
+    // The kernel only changes with the LDPC_SIMD environment variable, see batch::isa_enabled()
+    if(*work && (*work)->lanes != L) {
+        batch::free_work<T>(*work);
+        *work = NULL;
+    }
+    if(!*work) {
+        *work = batch::alloc_work<T>(&batch_graph, L);
+    }
+    batch::work_t<T> *w = *work;
+    
+    const uint64_t num_input = this->graph->get_num_input();
+    uint64_t index_out_first;
+    uint64_t index_out_last;
+    this->graph->get_output_range(&index_out_first, &index_out_last);
+    
+    for(uint64_t group=0; group<num_frames; group+=L) {
+        const uint64_t num_lanes = (num_frames-group < L) ? num_frames-group : L;
+        
+        // Interleave input, punctured bits and unused lanes are all zero and unused lanes inactive
+        std::memset(w->channel, 0, this->graph->M*L*sizeof(T));
+        for(uint64_t l=0; l<L; l++) {
+            w->active[l] = (l < num_lanes);
+            if(l >= num_lanes) {
+                continue;
+            }
+            
+            for(uint64_t j=0; j<num_input; j++) {
+                softbit_t val = input[group+l][j]*scale;
+                val = isnan(val) ? 0.0f : val;
+                val = (val >  clip) ?  clip : val;
+                val = (val < -clip) ? -clip : val;
+                val = fixed ? std::round(val) : val;
+                w->channel[this->graph->input_bits[j]*L+l] = static_cast<T>(val);
+            }
         }
         
-        tmp_prod *= this->bit_values_tanh[i];
+        kernel(&batch_graph, &conf, w);
+        
+        // De-interleave output
+        for(uint64_t l=0; l<num_lanes; l++) {
+            uint64_t ber_counter = 0;
+            uint64_t j=0;
+            for(uint64_t i=0; i<this->graph->M; i++) {
+                const softbit_t tmp_bit = static_cast<softbit_t>(w->posterior[i*L+l])/scale;
+                
+                if(i>=index_out_first && i<index_out_last) {
+                    out[group+l][j++] = tmp_bit;
+                }
+                
+                ber_counter += (static_cast<softbit_t>(w->channel[i*L+l])*tmp_bit<0.0f) ? 1u : 0u;
+            }
+            
+            const bool frame_success = (w->syndrome_count[l]==0 && w->failure_flags[l]==NONE);
+            success = success && frame_success;
+            
+            if(meta) {
+                meta[group+l].num_iterations = w->num_iterations[l];
+                meta[group+l].num_iterations_max = this->stop.max_iterations;
+                meta[group+l].success = frame_success;
+                meta[group+l].failure_flags = w->failure_flags[l];
+                meta[group+l].syndrome_count = w->syndrome_count[l];
+                meta[group+l].num_corrected = ber_counter;
+                meta[group+l].num_bits_total = this->graph->M;
+                meta[group+l].num_guesses = 0;
+            }
+        }
     }
     
-    return log10( (1.0f+tmp_prod) / (1.0f-tmp_prod) );
-}
-
-
-////
-//////  Bit node
-////
-ldpc::decoder::bit_node::bit_node(const uint64_t NUM_CHECKS) : NUM_CHECKS(NUM_CHECKS){
-    this->check_values = new softbit_t[NUM_CHECKS];
-    this->tmp_indx = 0;
-    this->new_round();
-}
-
-ldpc::decoder::bit_node::~bit_node(void){
-    delete[] this->check_values;
+    return success;
 }
 
-void ldpc::decoder::bit_node::reset(softbit_t channel_val) {
-    this->channel_value = channel_val;
+bool ldpc::decoder::decode_guess(softbit_t *out, const softbit_t *input, metadata_t *meta, const char *debugprefix) {
+    const uint64_t num_output = this->get_num_output();
+    std::string debugout;
     
-    for(size_t i=0; i<this->NUM_CHECKS; i++) {
-        this->check_values[i] = 0.0f;
+    // Plain belief propagation first
+    metadata_t result;
+    if(debugprefix) {
+        debugout = std::string(debugprefix) + std::to_string(0);
+    }
+    this->load_channel(input);
+    if(this->decode_channel(out, &result, debugprefix ? debugout.c_str() : NULL) || DECODER_GUESS_MAX_DEPTH == 0) {
+        if(meta) {
+            *meta = result;
+        }
+        return result.success;
     }
     
-    this->final_value = static_cast<softbit_t>(nan("")); // mark value as unset
-}
-
-void ldpc::decoder::bit_node::new_round(void) {
-#if LDPC_DO_SANITY_CHECKS
-    if(this->tmp_indx != 0 && this->tmp_indx != this->NUM_CHECKS) {
-        fprintf(stderr, "Resetting bit node, although not all values are read out");
-        exit( EXIT_FAILURE );
+    // The least reliable bits are guessed first, with the sign of their posterior LLR preferred
+    const uint64_t depth = std::min<uint64_t>(DECODER_GUESS_MAX_DEPTH, this->graph->M);
+    uint64_t *candidates = new uint64_t[this->graph->M];
+    for(uint64_t i=0; i<this->graph->M; i++) {
+        candidates[i] = i;
     }
-#endif
-
-    this->final_value = static_cast<softbit_t>(nan("")); // mark value as unset
-    this->tmp_indx = 0;
-}
-
-void ldpc::decoder::bit_node::set_check_value(softbit_t val) {
-    // store new check value
-    this->check_values[this->tmp_indx] = val;
+    const softbit_t *posterior = this->posterior;
+    std::partial_sort(candidates, candidates+depth, candidates+this->graph->M, [posterior](uint64_t a, uint64_t b) {
+        return my_abs(posterior[a]) < my_abs(posterior[b]) || (my_abs(posterior[a]) == my_abs(posterior[b]) && a < b);
+    });
     
-    // increase counter
-    this->tmp_indx++;
-}
-
-ldpc::softbit_t ldpc::decoder::bit_node::get_buffered_final_value(void) const {
-#if LDPC_DO_SANITY_CHECKS
-    if(isnan(this->final_value)) {
-        fprintf(stderr, "ERROR: Access to bits final estimate, before it is computed.\n");
-        exit( EXIT_FAILURE );
+    bool *candidate_pos = new bool[depth];
+    for(uint64_t l=0; l<depth; l++) {
+        candidate_pos[l] = (posterior[candidates[l]] >= 0.0f);
     }
-#endif
-
-    return this->final_value;
-}
-
-ldpc::softbit_t ldpc::decoder::bit_node::computeValForCheck(uint64_t indx, bool final) {
-    llrsum_t sum;
-    llrsum_reset(&sum);
     
-    llrsum_add(&sum, this->channel_value);
+    // Every guess starts over from the channel LLRs
+    softbit_t *base_channel = new softbit_t[this->graph->M];
+    std::memcpy(base_channel, this->channel, this->graph->M*sizeof(softbit_t));
+    
+    // The calling thread decodes guesses as well, the others get decoders of their own
+    uint64_t num_threads = DECODER_GUESS_THREADS;
+    if(num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        num_threads = (num_threads > 0) ? num_threads : 1;
+    }
+    num_threads = debugprefix ? 1 : std::min<uint64_t>(num_threads, 2*DECODER_GUESS_BEAM);
     
-    //softbit_t ret = this->channel_value;    
-    for(size_t i=0; i<this->NUM_CHECKS; i++) {
-        //printf("           \t [% 5u]: %f\n", i, this->check_values[i]);
-        if(!final && i==indx) {
-            continue;
+    if(this->num_guess_decoders < num_threads-1) {
+        for(uint64_t i=0; i<this->num_guess_decoders; i++) {
+            delete this->guess_decoders[i];
         }
-        //printf(":: %f +", ret);
-        //ret = addllrs(ret, this->check_values[i]);
-        llrsum_add(&sum, this->check_values[i]);
-        //printf(" %f = %f\n", this->check_values[i], ret);
+        delete[] this->guess_decoders;
+        
+        this->num_guess_decoders = num_threads-1;
+        this->guess_decoders = new decoder*[this->num_guess_decoders];
+        for(uint64_t i=0; i<this->num_guess_decoders; i++) {
+            this->guess_decoders[i] = new decoder(this->graph);
+        }
+    }
+    for(uint64_t i=0; i<num_threads-1; i++) {
+        this->guess_decoders[i]->set_algorithm(this->algorithm, this->algorithm_param);
+        this->guess_decoders[i]->set_schedule(this->sched);
+        this->guess_decoders[i]->set_domain(this->domain);
+        this->guess_decoders[i]->set_stopping(this->stop);
     }
+    
+    guess_tree *root = new guess_tree(NULL, candidates[0], candidate_pos[0]);
+    root->branch = 0;
+    root->syndrome_count = result.syndrome_count;
+    
+    guess_tree **frontier = new guess_tree*[DECODER_GUESS_BEAM];
+    uint64_t num_frontier = 1;
+    frontier[0] = root;
+    
+    guess_task_t *tasks = new guess_task_t[2*DECODER_GUESS_BEAM];
+    uint64_t *better = new uint64_t[2*DECODER_GUESS_BEAM];
+    softbit_t *task_out = new softbit_t[2*DECODER_GUESS_BEAM*num_output];
+    std::thread *threads = new std::thread[num_threads];
+    
+    guess_task_t *found = NULL;
+    uint64_t num_guesses = 0;
+    
+    for(uint64_t level=0; level<depth && num_frontier>0; level++) {
+        // Both signs of the bit of every node of this level are independent guesses
+        const uint64_t num_tasks = 2*num_frontier;
+        for(uint64_t t=0; t<num_tasks; t++) {
+            tasks[t].node = frontier[t/2];
+            tasks[t].value = static_cast<uint8_t>(t%2);
+            tasks[t].out = &task_out[t*num_output];
+        }
+        
+        std::atomic<uint64_t> next_task(0);
+        auto run = [&](decoder *dec) {
+            std::string name;
+            for(uint64_t t=next_task++; t<num_tasks; t=next_task++) {
+                if(debugprefix) {
+                    name = std::string(debugprefix) + std::to_string(num_guesses+t+1);
+                }
+                dec->decode_guess_task(&tasks[t], base_channel, debugprefix ? name.c_str() : NULL);
+            }
+        };
+        
+        const uint64_t num_workers = std::min(num_threads, num_tasks);
+        for(uint64_t i=1; i<num_workers; i++) {
+            threads[i] = std::thread(run, this->guess_decoders[i-1]);
+        }
+        run(this);
+        for(uint64_t i=1; i<num_workers; i++) {
+            threads[i].join();
+        }
+        num_guesses += num_tasks;
+        
+        // Compare with the guess every node refines, the first codeword in tree order wins
+        uint64_t num_better = 0;
+        for(uint64_t t=0; t<num_tasks; t++) {
+            guess_tree *node = tasks[t].node;
+            if(tasks[t].success) {
+                node->results[tasks[t].value] = guess_tree::SUCCESS;
+                found = found ? found : &tasks[t];
+            } else if(tasks[t].meta.syndrome_count < node->syndrome_count) {
+                node->results[tasks[t].value] = guess_tree::BETTER;
+                better[num_better++] = t;
+            } else {
+                node->results[tasks[t].value] = guess_tree::WORSE;
+            }
+        }
+        
+        if(found || level+1 >= depth) {
+            break;
+        }
+        
+        // Refine the guesses with the fewest unsatisfied checks by the next bit
+        std::stable_sort(better, better+num_better, [tasks](uint64_t a, uint64_t b) {
+            return tasks[a].meta.syndrome_count < tasks[b].meta.syndrome_count;
+        });
+        
+        num_frontier = std::min<uint64_t>(num_better, DECODER_GUESS_BEAM);
+        for(uint64_t k=0; k<num_frontier; k++) {
+            const guess_task_t *task = &tasks[better[k]];
+            guess_tree *child = task->node->add_child(candidates[level+1], candidate_pos[level+1]);
+            child->branch = task->value;
+            child->syndrome_count = task->meta.syndrome_count;
+            frontier[k] = child;
+        }
+    }
+    
+    if(found) {
+        std::memcpy(out, found->out, num_output*sizeof(softbit_t));
+        result = found->meta;
+        
+        // Guessed bits always follow their infinite LLR, count those that differ from the channel
+        uint8_t value = found->value;
+        for(guess_tree *node=found->node; node; node=node->parent) {
+            const bool pos = (node->pref_pos != (value == 1));
+            result.num_corrected += ((pos ? 1.0f : -1.0f)*base_channel[node->guess_pos] < 0.0f) ? 1u : 0u;
+            value = node->branch;
+        }
+    }
+    result.num_guesses = num_guesses;
+    
+    delete root;
+    delete[] frontier;
+    delete[] tasks;
+    delete[] better;
+    delete[] task_out;
+    delete[] threads;
+    delete[] base_channel;
+    delete[] candidate_pos;
+    delete[] candidates;
+    
+    if(meta) {
+        *meta = result;
+    }
+    return result.success;
+}
 
-    // Store final value in class
-    if(final) {
-        this->final_value = llrsum_get(&sum);
+void ldpc::decoder::decode_guess_task(guess_task_t *task, const softbit_t *base_channel, const char *debugout) {
+    std::memcpy(this->channel, base_channel, this->graph->M*sizeof(softbit_t));
+    
+    // Fix the bit of the node and the bits of all guesses it refines
+    uint8_t value = task->value;
+    for(guess_tree *node=task->node; node; node=node->parent) {
+        const bool pos = (node->pref_pos != (value == 1));
+        this->channel[node->guess_pos] = pos ? std::numeric_limits<softbit_t>::infinity() : -std::numeric_limits<softbit_t>::infinity();
+        value = node->branch;
     }
     
-    //return ret;
-    return llrsum_get(&sum);
+    task->success = this->decode_channel(task->out, &task->meta, debugout);
 }
 
-void ldpc::decoder::bit_node::llrsum_reset(llrsum_t *l) const {
+////
+//////  LLR sums
+////
+void ldpc::decoder::llrsum_reset(llrsum_t *l) {
     l->inf_count = 0;
     l->fin_sum = 0.0f;
 }
-        
-void ldpc::decoder::bit_node::llrsum_add(llrsum_t *l, softbit_t val) const {
+
+void ldpc::decoder::llrsum_add(llrsum_t *l, softbit_t val) {
     l->inf_count += isinf(val) ? ((val > 0) ? 1 : -1) : 0;
     l->fin_sum += isinf(val) ? 0 : val;
 }
-        
-ldpc::softbit_t ldpc::decoder::bit_node::llrsum_get(llrsum_t *l) const {
+
+void ldpc::decoder::llrsum_sub(llrsum_t *l, softbit_t val) {
+    l->inf_count -= isinf(val) ? ((val > 0) ? 1 : -1) : 0;
+    l->fin_sum -= isinf(val) ? 0 : val;
+}
+
+ldpc::softbit_t ldpc::decoder::llrsum_get(const llrsum_t *l) {
     //Asserts floating point compatibility at compile time
     static_assert(std::numeric_limits<float>::is_iec559, "IEEE 754 required for +/- Infitinty floats");
     
@@ -753,12 +1257,16 @@ ldpc::decoder::guess_tree::guess_tree(guess_tree *parent, uint64_t guess_pos, bo
         }
         this->num_children_alloc = max_children;
     } else {
+        this->children = NULL;
         this->num_children_alloc = 0;
     }
     
     this->results[0] = PENDING;
     this->results[1] = PENDING;
     
+    this->branch = 0;
+    this->syndrome_count = 0;
+    
     this->traverse_counter = 0;
 }
 
@@ -769,7 +1277,7 @@ ldpc::decoder::guess_tree::~guess_tree(void) {
     delete[] this->children;
 }
 
-void ldpc::decoder::guess_tree::add_child(uint64_t guess_pos, bool pref_pos, uint64_t max_children) {
+ldpc::decoder::guess_tree* ldpc::decoder::guess_tree::add_child(uint64_t guess_pos, bool pref_pos, uint64_t max_children) {
     if(this->num_children >= this->num_children_alloc) {
         guess_tree **new_children = new guess_tree*[this->num_children+1];
         std::memcpy(new_children, this->children, this->num_children*sizeof(guess_tree*));
@@ -781,7 +1289,7 @@ void ldpc::decoder::guess_tree::add_child(uint64_t guess_pos, bool pref_pos, uin
     }
     
     this->children[this->num_children] = new guess_tree(this, guess_pos, pref_pos, max_children);
-    this->num_children++;
+    return this->children[this->num_children++];
 }
 
 ldpc::decoder::guess_tree *ldpc::decoder::guess_tree::traverse(void) {
@@ -0,0 +1,347 @@
+#include "decoder_batch.h"
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace {
+    /** Scalar arithmetic of an LLR representation
+     *
+     * Fixed point types saturate symmetrically to [-LLR_MAX,LLR_MAX] and scale with a Q15 factor, rounded the
+     * same way as the SIMD kernels do it.
+     */
+    template<typename T> struct elem_generic {
+        typedef int32_t factor;
+        static const T LLR_MAX = std::numeric_limits<T>::max();
+        
+        static inline T add(T a, T b) { return clip(static_cast<int32_t>(a) + static_cast<int32_t>(b)); }
+        static inline T sub(T a, T b) { return clip(static_cast<int32_t>(a) - static_cast<int32_t>(b)); }
+        static inline bool is_neg(T a) { return a < 0; }
+        
+        static inline factor make_scale(ldpc::softbit_t s) {
+            const ldpc::softbit_t q = std::round(s*32768.0f);
+            return static_cast<factor>((q > 32767.0f) ? 32767.0f : q);
+        }
+        
+        static inline T scale(T a, factor s) {
+            return static_cast<T>((static_cast<int32_t>(a)*s + 0x4000) >> 15);
+        }
+        
+        static inline T clip(int32_t a) {
+            return static_cast<T>((a > LLR_MAX) ? LLR_MAX : ((a < -LLR_MAX) ? -LLR_MAX : a));
+        }
+    };
+    
+    template<> struct elem_generic<ldpc::softbit_t> {
+        typedef ldpc::softbit_t factor;
+        static constexpr ldpc::softbit_t LLR_MAX = DECODER_BATCH_LLR_MAX;
+        
+        static inline ldpc::softbit_t add(ldpc::softbit_t a, ldpc::softbit_t b) { return a + b; }
+        static inline ldpc::softbit_t sub(ldpc::softbit_t a, ldpc::softbit_t b) { return a - b; }
+        static inline bool is_neg(ldpc::softbit_t a) { return std::signbit(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return s; }
+        static inline ldpc::softbit_t scale(ldpc::softbit_t a, factor s) { return a*s; }
+    };
+    
+    /** Portable vector of L elements of type T, the compiler is free to map it to whatever the target offers */
+    template<typename T, uint64_t L> struct vec_generic {
+        static const uint64_t LANES = L;
+        
+        typedef elem_generic<T> E;
+        typedef T elem;
+        struct vec {
+            T v[L];
+        };
+        typedef typename E::factor factor;
+        typedef uint64_t mask;
+        
+        static constexpr T LLR_MAX = E::LLR_MAX;
+        
+        static inline vec load(const T *p) {
+            vec r;
+            std::memcpy(r.v, p, sizeof(r.v));
+            return r;
+        }
+        
+        static inline void store(T *p, const vec &a) {
+            std::memcpy(p, a.v, sizeof(a.v));
+        }
+        
+        static inline vec set1(T a) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = a;
+            }
+            return r;
+        }
+        
+        static inline vec add(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = E::add(a.v[l], b.v[l]);
+            }
+            return r;
+        }
+        
+        static inline vec sub(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = E::sub(a.v[l], b.v[l]);
+            }
+            return r;
+        }
+        
+        static inline vec min(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = (a.v[l] < b.v[l]) ? a.v[l] : b.v[l];
+            }
+            return r;
+        }
+        
+        static inline vec max(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = (a.v[l] > b.v[l]) ? a.v[l] : b.v[l];
+            }
+            return r;
+        }
+        
+        static inline vec abs(const vec &a) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = E::is_neg(a.v[l]) ? static_cast<T>(-a.v[l]) : a.v[l];
+            }
+            return r;
+        }
+        
+        static inline factor make_scale(ldpc::softbit_t s) {
+            return E::make_scale(s);
+        }
+        
+        static inline vec scale(const vec &a, factor s) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = E::scale(a.v[l], s);
+            }
+            return r;
+        }
+        
+        static inline vec parity(const vec &p, const vec &t) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = (E::is_neg(p.v[l]) != E::is_neg(t.v[l])) ? static_cast<T>(-1) : static_cast<T>(0);
+            }
+            return r;
+        }
+        
+        static inline vec apply_sign(const vec &m, const vec &s) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = E::is_neg(s.v[l]) ? static_cast<T>(-m.v[l]) : m.v[l];
+            }
+            return r;
+        }
+        
+        static inline mask lt(const vec &a, const vec &b) {
+            mask r = 0;
+            for(uint64_t l=0; l<L; l++) {
+                r |= (a.v[l] < b.v[l]) ? (static_cast<mask>(1)<<l) : 0u;
+            }
+            return r;
+        }
+        
+        static inline mask eq(const vec &a, const vec &b) {
+            mask r = 0;
+            for(uint64_t l=0; l<L; l++) {
+                r |= (a.v[l] == b.v[l]) ? (static_cast<mask>(1)<<l) : 0u;
+            }
+            return r;
+        }
+        
+        static inline mask neq(const vec &a, const vec &b) {
+            mask r = 0;
+            for(uint64_t l=0; l<L; l++) {
+                r |= (a.v[l] != b.v[l]) ? (static_cast<mask>(1)<<l) : 0u;
+            }
+            return r;
+        }
+        
+        static inline mask is_neg(const vec &a) {
+            mask r = 0;
+            for(uint64_t l=0; l<L; l++) {
+                r |= E::is_neg(a.v[l]) ? (static_cast<mask>(1)<<l) : 0u;
+            }
+            return r;
+        }
+        
+        static inline vec select(mask m, const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = (m & (static_cast<mask>(1)<<l)) ? b.v[l] : a.v[l];
+            }
+            return r;
+        }
+        
+        static inline mask mask_or(mask a, mask b) {
+            return a | b;
+        }
+        
+        static inline mask mask_from_bits(uint64_t bits) {
+            return bits;
+        }
+        
+        static inline uint64_t mask_bits(mask m) {
+            return m;
+        }
+    };
+}
+
+#include "decoder_batch_impl.h"
+
+const uint64_t ldpc::batch::LANES_GENERIC = 8;
+const uint64_t ldpc::batch::LANES_GENERIC_I16 = 16;
+const uint64_t ldpc::batch::LANES_GENERIC_I8 = 32;
+
+void ldpc::batch::decode_generic(const graph_t *g, const conf_t *c, work_t<softbit_t> *w) {
+    batch_decode< vec_generic<softbit_t, 8> >(g, c, w);
+}
+
+void ldpc::batch::decode_generic_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w) {
+    batch_decode< vec_generic<int16_t, 16> >(g, c, w);
+}
+
+void ldpc::batch::decode_generic_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w) {
+    batch_decode< vec_generic<int8_t, 32> >(g, c, w);
+}
+
+void ldpc::batch::decode_single_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w) {
+    batch_decode< vec_generic<int16_t, 1> >(g, c, w);
+}
+
+void ldpc::batch::decode_single_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w) {
+    batch_decode< vec_generic<int8_t, 1> >(g, c, w);
+}
+
+template<typename T> ldpc::batch::work_t<T>* ldpc::batch::alloc_work(const graph_t *g, uint64_t lanes) {
+    T *mem = new T[lanes*(3*g->M + 2*g->E + g->max_check_degree)];
+    
+    work_t<T> *w = new work_t<T>;
+    w->lanes = lanes;
+    w->channel = mem;
+    w->posterior = &mem[lanes*g->M];
+    w->posterior_last = &mem[2*lanes*g->M];
+    w->msg_b2c = &mem[3*lanes*g->M];
+    w->msg_c2b = &mem[lanes*(3*g->M + g->E)];
+    w->check_buf = &mem[lanes*(3*g->M + 2*g->E)];
+    w->row_buf = (g->Z > 0 && lanes == 1) ? new T[4*g->Z] : NULL;
+    
+    w->active = new bool[lanes];
+    uint64_t *results = new uint64_t[2*lanes];
+    w->num_iterations = results;
+    w->syndrome_count = &results[lanes];
+    w->failure_flags = new uint8_t[lanes];
+    
+    return w;
+}
+
+template<typename T> void ldpc::batch::free_work(work_t<T> *w) {
+    if(!w) {
+        return;
+    }
+    
+    delete[] w->channel;
+    delete[] w->row_buf;
+    delete[] w->active;
+    delete[] w->num_iterations;
+    delete[] w->failure_flags;
+    delete w;
+}
+
+template ldpc::batch::work_t<ldpc::softbit_t>* ldpc::batch::alloc_work<ldpc::softbit_t>(const graph_t *g, uint64_t lanes);
+template ldpc::batch::work_t<int16_t>* ldpc::batch::alloc_work<int16_t>(const graph_t *g, uint64_t lanes);
+template ldpc::batch::work_t<int8_t>* ldpc::batch::alloc_work<int8_t>(const graph_t *g, uint64_t lanes);
+template void ldpc::batch::free_work<ldpc::softbit_t>(work_t<softbit_t> *w);
+template void ldpc::batch::free_work<int16_t>(work_t<int16_t> *w);
+template void ldpc::batch::free_work<int8_t>(work_t<int8_t> *w);
+
+bool ldpc::batch::isa_enabled(isa_t isa) {
+    const char *limit = std::getenv("LDPC_SIMD");
+    if(limit != NULL) {
+        if(std::strcmp(limit, "generic") == 0 && isa > GENERIC) {
+            return false;
+        }
+        if(std::strcmp(limit, "avx2") == 0 && isa > AVX2) {
+            return false;
+        }
+    }
+    
+    switch(isa) {
+#if defined(LDPC_SIMD_AVX512)
+        case AVX512:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+#endif
+#if defined(LDPC_SIMD_AVX2)
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        case GENERIC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+ldpc::batch::kernel_t ldpc::batch::select_kernel(uint64_t *lanes) {
+#if defined(LDPC_SIMD_AVX512)
+    if(isa_enabled(AVX512)) {
+        *lanes = LANES_AVX512;
+        return decode_avx512;
+    }
+#endif
+#if defined(LDPC_SIMD_AVX2)
+    if(isa_enabled(AVX2)) {
+        *lanes = LANES_AVX2;
+        return decode_avx2;
+    }
+#endif
+    
+    *lanes = LANES_GENERIC;
+    return decode_generic;
+}
+
+ldpc::batch::kernel_i16_t ldpc::batch::select_kernel_i16(uint64_t *lanes) {
+#if defined(LDPC_SIMD_AVX512)
+    if(isa_enabled(AVX512)) {
+        *lanes = LANES_AVX512_I16;
+        return decode_avx512_i16;
+    }
+#endif
+#if defined(LDPC_SIMD_AVX2)
+    if(isa_enabled(AVX2)) {
+        *lanes = LANES_AVX2_I16;
+        return decode_avx2_i16;
+    }
+#endif
+    
+    *lanes = LANES_GENERIC_I16;
+    return decode_generic_i16;
+}
+
+ldpc::batch::kernel_i8_t ldpc::batch::select_kernel_i8(uint64_t *lanes) {
+#if defined(LDPC_SIMD_AVX512)
+    if(isa_enabled(AVX512)) {
+        *lanes = LANES_AVX512_I8;
+        return decode_avx512_i8;
+    }
+#endif
+#if defined(LDPC_SIMD_AVX2)
+    if(isa_enabled(AVX2)) {
+        *lanes = LANES_AVX2_I8;
+        return decode_avx2_i8;
+    }
+#endif
+    
+    *lanes = LANES_GENERIC_I8;
+    return decode_generic_i8;
+}
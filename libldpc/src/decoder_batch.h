@@ -0,0 +1,163 @@
+#ifndef __LIBLDPC_DECODER_BATCH_H__DEFINED__
+#define __LIBLDPC_DECODER_BATCH_H__DEFINED__
+
+#include <ldpc/decoder.h>
+#include <stdint.h>
+
+/** Magnitude limit of all LLRs in the floating point batch decoder
+ *
+ * The batch decoder works on plain floats without infinity counting, so infinite input LLRs are clipped to
+ * this value and check messages never exceed it.
+ */
+#define DECODER_BATCH_LLR_MAX 1.0e30f
+
+/** Number of rows of a quasi-cyclic block row whose minima the layered schedule keeps in registers, for groups of frames */
+#ifndef DECODER_BATCH_QC_TILE
+#define DECODER_BATCH_QC_TILE 8
+#endif
+
+namespace ldpc {
+    namespace batch {
+        
+        /** Read-only view of the Tanner graph of a decoder */
+        struct graph_t {
+            uint64_t N;
+            uint64_t M;
+            uint64_t E;
+            uint64_t max_check_degree;
+            const uint64_t *check_offsets;
+            const uint64_t *check_edges;
+            const uint64_t *bit_offsets;
+            const uint64_t *edge_b2c;
+            const uint64_t *edge_c2b;
+            
+            /** Circulant structure of quasi-cyclic codes, Z is zero for other codes (see decoder) */
+            uint64_t Z;
+            uint64_t base_rows;
+            const uint64_t *block_offsets;
+            const uint64_t *block_cols;
+            const uint64_t *block_shifts;
+        };
+        
+        /** Decoding parameters of a batch
+         *
+         * The offset of OFFSET_MIN_SUM and min_llr_mag are given in units of the LLR representation, i.e.
+         * already scaled for quantized decoding. The scaling factor of NORMALIZED_MIN_SUM is always a plain factor.
+         */
+        struct conf_t {
+            checknode::algorithm_t algorithm;
+            softbit_t algorithm_param;
+            schedule::schedule_t sched;
+            uint64_t max_iterations;
+            softbit_t min_llr_mag;
+            
+            /** Whether lanes whose posterior LLRs did not change in an iteration are stopped */
+            bool stop_unchanged;
+            
+            /** Time limit of the whole group in microseconds, zero for none */
+            uint64_t max_time_us;
+        };
+        
+        /** Memory of one group of frames
+         *
+         * All LLR arrays are interleaved lane-wise, i.e. element i of lane l is stored at i*lanes+l. T is the
+         * LLR representation, softbit_t or a saturating fixed point type.
+         */
+        template<typename T> struct work_t {
+            /** Number of lanes the memory is allocated for */
+            uint64_t lanes;
+            
+            /** Channel LLRs, clipped to the range of the representation (M*lanes elements) */
+            T *channel;
+            
+            /** Posterior LLRs (M*lanes elements) */
+            T *posterior;
+            
+            /** Posterior LLRs of the previous iteration (M*lanes elements) */
+            T *posterior_last;
+            
+            /** Bit to check messages in check-major order (E*lanes elements) */
+            T *msg_b2c;
+            
+            /** Check to bit messages (E*lanes elements)
+             *
+             * Bit-major for the flooding and check-major for the layered schedule. The layered schedule of
+             * quasi-cyclic codes stores the Z messages of every circulant one after the other.
+             */
+            T *msg_c2b;
+            
+            /** Scratch buffer for a single check (max_check_degree*lanes elements) */
+            T *check_buf;
+            
+            /** Smallest magnitudes and sign parity of every row of a block row (4*Z elements, single frame quasi-cyclic decoding only, NULL otherwise) */
+            T *row_buf;
+            
+            /** Whether a lane contains a frame (lanes elements) */
+            bool *active;
+            
+            /** Results of every lane (lanes elements each) */
+            uint64_t *num_iterations;
+            uint64_t *syndrome_count;
+            uint8_t *failure_flags;
+        };
+        
+        /** Allocate memory of a group of lanes frames, free_work() accepts NULL */
+        template<typename T> work_t<T>* alloc_work(const graph_t *g, uint64_t lanes);
+        template<typename T> void free_work(work_t<T> *w);
+        
+        /** Decode one group of frames, one function per LLR representation and instruction set */
+        typedef void (*kernel_t)(const graph_t *g, const conf_t *c, work_t<softbit_t> *w);
+        typedef void (*kernel_i16_t)(const graph_t *g, const conf_t *c, work_t<int16_t> *w);
+        typedef void (*kernel_i8_t)(const graph_t *g, const conf_t *c, work_t<int8_t> *w);
+        
+        void decode_generic(const graph_t *g, const conf_t *c, work_t<softbit_t> *w);
+        void decode_generic_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w);
+        void decode_generic_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w);
+        extern const uint64_t LANES_GENERIC;
+        extern const uint64_t LANES_GENERIC_I16;
+        extern const uint64_t LANES_GENERIC_I8;
+        
+        /** Decode a single frame (lanes=1) in fixed point */
+        void decode_single_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w);
+        void decode_single_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w);
+
+#ifdef LDPC_SIMD_AVX2
+        void decode_avx2(const graph_t *g, const conf_t *c, work_t<softbit_t> *w);
+        void decode_avx2_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w);
+        void decode_avx2_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w);
+        extern const uint64_t LANES_AVX2;
+        extern const uint64_t LANES_AVX2_I16;
+        extern const uint64_t LANES_AVX2_I8;
+#endif
+
+#ifdef LDPC_SIMD_AVX512
+        void decode_avx512(const graph_t *g, const conf_t *c, work_t<softbit_t> *w);
+        void decode_avx512_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w);
+        void decode_avx512_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w);
+        extern const uint64_t LANES_AVX512;
+        extern const uint64_t LANES_AVX512_I16;
+        extern const uint64_t LANES_AVX512_I8;
+#endif
+        
+        /** Instruction sets of the kernels, from the narrowest to the widest */
+        enum isa_t {
+            GENERIC = 0,
+            AVX2 = 1,
+            AVX512 = 2
+        };
+        
+        /** Whether the kernels of an instruction set may be selected
+         *
+         * The CPU has to support the instruction set. The environment variable LDPC_SIMD (generic, avx2 or avx512)
+         * limits the selection to the given and narrower instruction sets, e.g. to compare the kernels.
+         */
+        bool isa_enabled(isa_t isa);
+        
+        /** Select the widest enabled kernel at runtime */
+        kernel_t select_kernel(uint64_t *lanes);
+        kernel_i16_t select_kernel_i16(uint64_t *lanes);
+        kernel_i8_t select_kernel_i8(uint64_t *lanes);
+    }
+}
+
+#endif /* __LIBLDPC_DECODER_BATCH_H__DEFINED__ */
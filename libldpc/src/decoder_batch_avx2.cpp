@@ -0,0 +1,178 @@
+#include "decoder_batch.h"
+#include <immintrin.h>
+#include <math.h>
+
+namespace {
+    /** Q15 representation of a scaling factor in (0,1]
+     *
+     * Rounded with the C library instead of std::round(), whose inline copy would be emitted with AVX2
+     * instructions and could be picked up by the linker for the generic kernels.
+     */
+    inline int16_t q15_factor(ldpc::softbit_t s) {
+        const ldpc::softbit_t q = roundf(s*32768.0f);
+        return static_cast<int16_t>((q > 32767.0f) ? 32767.0f : q);
+    }
+    
+    /** Eight softbits in an AVX2 register */
+    struct vec_avx2 {
+        static const uint64_t LANES = 8;
+        
+        typedef ldpc::softbit_t elem;
+        typedef __m256 vec;
+        typedef __m256 mask;
+        typedef __m256 factor;
+        
+        static constexpr elem LLR_MAX = DECODER_BATCH_LLR_MAX;
+        
+        static inline vec load(const elem *p) { return _mm256_loadu_ps(p); }
+        static inline void store(elem *p, vec a) { _mm256_storeu_ps(p, a); }
+        static inline vec set1(elem a) { return _mm256_set1_ps(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+        static inline vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+        static inline vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+        static inline vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+        static inline vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return _mm256_set1_ps(s); }
+        static inline vec scale(vec a, factor s) { return _mm256_mul_ps(a, s); }
+        
+        static inline vec parity(vec p, vec t) { return _mm256_xor_ps(p, _mm256_and_ps(_mm256_set1_ps(-0.0f), t)); }
+        static inline vec apply_sign(vec m, vec s) { return parity(m, s); }
+        
+        static inline mask lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static inline mask eq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+        static inline mask neq(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_OQ); }
+        static inline mask is_neg(vec a) { return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(a), 31)); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm256_blendv_ps(a, b, m); }
+        static inline mask mask_or(mask a, mask b) { return _mm256_or_ps(a, b); }
+        
+        static inline mask mask_from_bits(uint64_t bits) {
+            const __m256i lane_bits = _mm256_setr_epi32(1<<0, 1<<1, 1<<2, 1<<3, 1<<4, 1<<5, 1<<6, 1<<7);
+            const __m256i b = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits & 0xFF)), lane_bits);
+            return _mm256_castsi256_ps(_mm256_cmpeq_epi32(b, lane_bits));
+        }
+        
+        static inline uint64_t mask_bits(mask m) { return static_cast<uint64_t>(_mm256_movemask_ps(m)); }
+    };
+    
+    /** Sixteen Q15-scalable 16 bit LLRs in an AVX2 register */
+    struct vec_avx2_i16 {
+        static const uint64_t LANES = 16;
+        
+        typedef int16_t elem;
+        typedef __m256i vec;
+        typedef __m256i mask;
+        typedef __m256i factor;
+        
+        static constexpr elem LLR_MAX = INT16_MAX;
+        
+        static inline vec load(const elem *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static inline void store(elem *p, vec a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+        static inline vec set1(elem a) { return _mm256_set1_epi16(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm256_max_epi16(_mm256_adds_epi16(a, b), _mm256_set1_epi16(-LLR_MAX)); }
+        static inline vec sub(vec a, vec b) { return _mm256_max_epi16(_mm256_subs_epi16(a, b), _mm256_set1_epi16(-LLR_MAX)); }
+        static inline vec min(vec a, vec b) { return _mm256_min_epi16(a, b); }
+        static inline vec max(vec a, vec b) { return _mm256_max_epi16(a, b); }
+        static inline vec abs(vec a) { return _mm256_abs_epi16(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return _mm256_set1_epi16(q15_factor(s)); }
+        static inline vec scale(vec a, factor s) { return _mm256_mulhrs_epi16(a, s); }
+        
+        static inline vec parity(vec p, vec t) { return _mm256_xor_si256(p, t); }
+        static inline vec apply_sign(vec m, vec s) { return select(is_neg(s), m, _mm256_sub_epi16(_mm256_setzero_si256(), m)); }
+        
+        static inline mask lt(vec a, vec b) { return _mm256_cmpgt_epi16(b, a); }
+        static inline mask eq(vec a, vec b) { return _mm256_cmpeq_epi16(a, b); }
+        static inline mask neq(vec a, vec b) { return _mm256_xor_si256(_mm256_cmpeq_epi16(a, b), _mm256_set1_epi16(-1)); }
+        static inline mask is_neg(vec a) { return _mm256_srai_epi16(a, 15); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm256_blendv_epi8(a, b, m); }
+        static inline mask mask_or(mask a, mask b) { return _mm256_or_si256(a, b); }
+        
+        static inline mask mask_from_bits(uint64_t bits) {
+            const __m256i lane_bits = _mm256_setr_epi16(1<<0, 1<<1, 1<<2, 1<<3, 1<<4, 1<<5, 1<<6, 1<<7,
+                1<<8, 1<<9, 1<<10, 1<<11, 1<<12, 1<<13, 1<<14, static_cast<int16_t>(0x8000));
+            const __m256i b = _mm256_and_si256(_mm256_set1_epi16(static_cast<int16_t>(bits & 0xFFFF)), lane_bits);
+            return _mm256_cmpeq_epi16(b, lane_bits);
+        }
+        
+        static inline uint64_t mask_bits(mask m) {
+            // One byte per lane, packing works per 128 bit half
+            const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(m, m), 0xD8);
+            return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(packed)) & 0xFFFF);
+        }
+    };
+    
+    /** Thirty-two 8 bit LLRs in an AVX2 register, scaled in 16 bit */
+    struct vec_avx2_i8 {
+        static const uint64_t LANES = 32;
+        
+        typedef int8_t elem;
+        typedef __m256i vec;
+        typedef __m256i mask;
+        typedef __m256i factor;
+        
+        static constexpr elem LLR_MAX = INT8_MAX;
+        
+        static inline vec load(const elem *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        static inline void store(elem *p, vec a) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), a); }
+        static inline vec set1(elem a) { return _mm256_set1_epi8(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm256_max_epi8(_mm256_adds_epi8(a, b), _mm256_set1_epi8(-LLR_MAX)); }
+        static inline vec sub(vec a, vec b) { return _mm256_max_epi8(_mm256_subs_epi8(a, b), _mm256_set1_epi8(-LLR_MAX)); }
+        static inline vec min(vec a, vec b) { return _mm256_min_epi8(a, b); }
+        static inline vec max(vec a, vec b) { return _mm256_max_epi8(a, b); }
+        static inline vec abs(vec a) { return _mm256_abs_epi8(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return vec_avx2_i16::make_scale(s); }
+        
+        static inline vec scale(vec a, factor s) {
+            const __m256i lo = _mm256_mulhrs_epi16(_mm256_cvtepi8_epi16(_mm256_castsi256_si128(a)), s);
+            const __m256i hi = _mm256_mulhrs_epi16(_mm256_cvtepi8_epi16(_mm256_extracti128_si256(a, 1)), s);
+            return _mm256_permute4x64_epi64(_mm256_packs_epi16(lo, hi), 0xD8);
+        }
+        
+        static inline vec parity(vec p, vec t) { return _mm256_xor_si256(p, t); }
+        static inline vec apply_sign(vec m, vec s) { return select(is_neg(s), m, _mm256_sub_epi8(_mm256_setzero_si256(), m)); }
+        
+        static inline mask lt(vec a, vec b) { return _mm256_cmpgt_epi8(b, a); }
+        static inline mask eq(vec a, vec b) { return _mm256_cmpeq_epi8(a, b); }
+        static inline mask neq(vec a, vec b) { return _mm256_xor_si256(_mm256_cmpeq_epi8(a, b), _mm256_set1_epi8(-1)); }
+        static inline mask is_neg(vec a) { return _mm256_cmpgt_epi8(_mm256_setzero_si256(), a); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm256_blendv_epi8(a, b, m); }
+        static inline mask mask_or(mask a, mask b) { return _mm256_or_si256(a, b); }
+        
+        static inline mask mask_from_bits(uint64_t bits) {
+            // Spread byte i/8 of the bitmap to byte i, then test bit i%8
+            const __m256i byte_indx = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+            const __m256i lane_bits = _mm256_set1_epi64x(static_cast<int64_t>(0x8040201008040201ull));
+            const __m256i b = _mm256_shuffle_epi8(_mm256_set1_epi32(static_cast<int>(bits & 0xFFFFFFFFu)), byte_indx);
+            return _mm256_cmpeq_epi8(_mm256_and_si256(b, lane_bits), lane_bits);
+        }
+        
+        static inline uint64_t mask_bits(mask m) { return static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(m))); }
+    };
+}
+
+#include "decoder_batch_impl.h"
+
+const uint64_t ldpc::batch::LANES_AVX2 = vec_avx2::LANES;
+const uint64_t ldpc::batch::LANES_AVX2_I16 = vec_avx2_i16::LANES;
+const uint64_t ldpc::batch::LANES_AVX2_I8 = vec_avx2_i8::LANES;
+
+void ldpc::batch::decode_avx2(const graph_t *g, const conf_t *c, work_t<softbit_t> *w) {
+    batch_decode<vec_avx2>(g, c, w);
+}
+
+void ldpc::batch::decode_avx2_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w) {
+    batch_decode<vec_avx2_i16>(g, c, w);
+}
+
+void ldpc::batch::decode_avx2_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w) {
+    batch_decode<vec_avx2_i8>(g, c, w);
+}
@@ -0,0 +1,155 @@
+#include "decoder_batch.h"
+#include <immintrin.h>
+#include <math.h>
+
+namespace {
+    /** Q15 representation of a scaling factor in (0,1]
+     *
+     * Rounded with the C library instead of std::round(), whose inline copy would be emitted with AVX-512
+     * instructions and could be picked up by the linker for the generic kernels.
+     */
+    inline int16_t q15_factor(ldpc::softbit_t s) {
+        const ldpc::softbit_t q = roundf(s*32768.0f);
+        return static_cast<int16_t>((q > 32767.0f) ? 32767.0f : q);
+    }
+    
+    /** Sixteen softbits in an AVX-512 register */
+    struct vec_avx512 {
+        static const uint64_t LANES = 16;
+        
+        typedef ldpc::softbit_t elem;
+        typedef __m512 vec;
+        typedef __mmask16 mask;
+        typedef __m512 factor;
+        
+        static constexpr elem LLR_MAX = DECODER_BATCH_LLR_MAX;
+        
+        static inline vec load(const elem *p) { return _mm512_loadu_ps(p); }
+        static inline void store(elem *p, vec a) { _mm512_storeu_ps(p, a); }
+        static inline vec set1(elem a) { return _mm512_set1_ps(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static inline vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+        static inline vec min(vec a, vec b) { return _mm512_min_ps(a, b); }
+        static inline vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+        static inline vec abs(vec a) { return _mm512_abs_ps(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return _mm512_set1_ps(s); }
+        static inline vec scale(vec a, factor s) { return _mm512_mul_ps(a, s); }
+        
+        static inline vec parity(vec p, vec t) {
+            const __m512i signbits = _mm512_and_si512(_mm512_castps_si512(t), _mm512_set1_epi32(static_cast<int>(0x80000000u)));
+            return _mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(p), signbits));
+        }
+        static inline vec apply_sign(vec m, vec s) { return parity(m, s); }
+        
+        static inline mask lt(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+        static inline mask eq(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+        static inline mask neq(vec a, vec b) { return _mm512_cmp_ps_mask(a, b, _CMP_NEQ_OQ); }
+        static inline mask is_neg(vec a) { return _mm512_cmplt_epi32_mask(_mm512_castps_si512(a), _mm512_setzero_si512()); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm512_mask_blend_ps(m, a, b); }
+        static inline mask mask_or(mask a, mask b) { return static_cast<mask>(a | b); }
+        static inline mask mask_from_bits(uint64_t bits) { return static_cast<mask>(bits); }
+        static inline uint64_t mask_bits(mask m) { return static_cast<uint64_t>(m); }
+    };
+    
+    /** Thirty-two Q15-scalable 16 bit LLRs in an AVX-512 register */
+    struct vec_avx512_i16 {
+        static const uint64_t LANES = 32;
+        
+        typedef int16_t elem;
+        typedef __m512i vec;
+        typedef __mmask32 mask;
+        typedef __m512i factor;
+        
+        static constexpr elem LLR_MAX = INT16_MAX;
+        
+        static inline vec load(const elem *p) { return _mm512_loadu_si512(p); }
+        static inline void store(elem *p, vec a) { _mm512_storeu_si512(p, a); }
+        static inline vec set1(elem a) { return _mm512_set1_epi16(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm512_max_epi16(_mm512_adds_epi16(a, b), _mm512_set1_epi16(-LLR_MAX)); }
+        static inline vec sub(vec a, vec b) { return _mm512_max_epi16(_mm512_subs_epi16(a, b), _mm512_set1_epi16(-LLR_MAX)); }
+        static inline vec min(vec a, vec b) { return _mm512_min_epi16(a, b); }
+        static inline vec max(vec a, vec b) { return _mm512_max_epi16(a, b); }
+        static inline vec abs(vec a) { return _mm512_abs_epi16(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return _mm512_set1_epi16(q15_factor(s)); }
+        static inline vec scale(vec a, factor s) { return _mm512_mulhrs_epi16(a, s); }
+        
+        static inline vec parity(vec p, vec t) { return _mm512_xor_si512(p, t); }
+        static inline vec apply_sign(vec m, vec s) { return _mm512_mask_sub_epi16(m, is_neg(s), _mm512_setzero_si512(), m); }
+        
+        static inline mask lt(vec a, vec b) { return _mm512_cmplt_epi16_mask(a, b); }
+        static inline mask eq(vec a, vec b) { return _mm512_cmpeq_epi16_mask(a, b); }
+        static inline mask neq(vec a, vec b) { return _mm512_cmpneq_epi16_mask(a, b); }
+        static inline mask is_neg(vec a) { return _mm512_movepi16_mask(a); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm512_mask_blend_epi16(m, a, b); }
+        static inline mask mask_or(mask a, mask b) { return static_cast<mask>(a | b); }
+        static inline mask mask_from_bits(uint64_t bits) { return static_cast<mask>(bits); }
+        static inline uint64_t mask_bits(mask m) { return static_cast<uint64_t>(m); }
+    };
+    
+    /** Sixty-four 8 bit LLRs in an AVX-512 register, scaled in 16 bit */
+    struct vec_avx512_i8 {
+        static const uint64_t LANES = 64;
+        
+        typedef int8_t elem;
+        typedef __m512i vec;
+        typedef __mmask64 mask;
+        typedef __m512i factor;
+        
+        static constexpr elem LLR_MAX = INT8_MAX;
+        
+        static inline vec load(const elem *p) { return _mm512_loadu_si512(p); }
+        static inline void store(elem *p, vec a) { _mm512_storeu_si512(p, a); }
+        static inline vec set1(elem a) { return _mm512_set1_epi8(a); }
+        
+        static inline vec add(vec a, vec b) { return _mm512_max_epi8(_mm512_adds_epi8(a, b), _mm512_set1_epi8(-LLR_MAX)); }
+        static inline vec sub(vec a, vec b) { return _mm512_max_epi8(_mm512_subs_epi8(a, b), _mm512_set1_epi8(-LLR_MAX)); }
+        static inline vec min(vec a, vec b) { return _mm512_min_epi8(a, b); }
+        static inline vec max(vec a, vec b) { return _mm512_max_epi8(a, b); }
+        static inline vec abs(vec a) { return _mm512_abs_epi8(a); }
+        
+        static inline factor make_scale(ldpc::softbit_t s) { return vec_avx512_i16::make_scale(s); }
+        
+        static inline vec scale(vec a, factor s) {
+            const __m512i lo = _mm512_mulhrs_epi16(_mm512_cvtepi8_epi16(_mm512_castsi512_si256(a)), s);
+            const __m512i hi = _mm512_mulhrs_epi16(_mm512_cvtepi8_epi16(_mm512_extracti64x4_epi64(a, 1)), s);
+            return _mm512_inserti64x4(_mm512_castsi256_si512(_mm512_cvtsepi16_epi8(lo)), _mm512_cvtsepi16_epi8(hi), 1);
+        }
+        
+        static inline vec parity(vec p, vec t) { return _mm512_xor_si512(p, t); }
+        static inline vec apply_sign(vec m, vec s) { return _mm512_mask_sub_epi8(m, is_neg(s), _mm512_setzero_si512(), m); }
+        
+        static inline mask lt(vec a, vec b) { return _mm512_cmplt_epi8_mask(a, b); }
+        static inline mask eq(vec a, vec b) { return _mm512_cmpeq_epi8_mask(a, b); }
+        static inline mask neq(vec a, vec b) { return _mm512_cmpneq_epi8_mask(a, b); }
+        static inline mask is_neg(vec a) { return _mm512_movepi8_mask(a); }
+        
+        static inline vec select(mask m, vec a, vec b) { return _mm512_mask_blend_epi8(m, a, b); }
+        static inline mask mask_or(mask a, mask b) { return static_cast<mask>(a | b); }
+        static inline mask mask_from_bits(uint64_t bits) { return static_cast<mask>(bits); }
+        static inline uint64_t mask_bits(mask m) { return static_cast<uint64_t>(m); }
+    };
+}
+
+#include "decoder_batch_impl.h"
+
+const uint64_t ldpc::batch::LANES_AVX512 = vec_avx512::LANES;
+const uint64_t ldpc::batch::LANES_AVX512_I16 = vec_avx512_i16::LANES;
+const uint64_t ldpc::batch::LANES_AVX512_I8 = vec_avx512_i8::LANES;
+
+void ldpc::batch::decode_avx512(const graph_t *g, const conf_t *c, work_t<softbit_t> *w) {
+    batch_decode<vec_avx512>(g, c, w);
+}
+
+void ldpc::batch::decode_avx512_i16(const graph_t *g, const conf_t *c, work_t<int16_t> *w) {
+    batch_decode<vec_avx512_i16>(g, c, w);
+}
+
+void ldpc::batch::decode_avx512_i8(const graph_t *g, const conf_t *c, work_t<int8_t> *w) {
+    batch_decode<vec_avx512_i8>(g, c, w);
+}
@@ -0,0 +1,424 @@
+#ifndef __LIBLDPC_DECODER_BATCH_IMPL_H__DEFINED__
+#define __LIBLDPC_DECODER_BATCH_IMPL_H__DEFINED__
+
+/*
+ * Lane-generic batch decoding kernel.
+ *
+ * This file is included by one translation unit per instruction set, after the vector types of that
+ * instruction set are defined. The kernels are kept in an anonymous namespace, so code compiled for one
+ * instruction set can never be picked up by the linker for another one. Functions with external linkage
+ * must not be defined inline in any header these translation units include (the helpers of timing.h are
+ * file-local as well), their copies would be emitted with the instructions of that set.
+ *
+ * A vector type V has to provide:
+ *   elem, vec, mask, LANES       LLR representation, vector of LANES elements and lane mask
+ *   factor                       scaling factor in the format scale() expects
+ *   LLR_MAX                      largest magnitude of a message
+ *   load, store                  unaligned memory access
+ *   set1                         broadcast
+ *   add, sub, min, max, abs      lane-wise arithmetic, saturating and symmetric for fixed point types
+ *   make_scale, scale            multiplication with a factor in (0,1]
+ *   parity(p, t)                 p with its sign flipped where t is negative
+ *   apply_sign(m, s)             m with its sign flipped where s is negative
+ *   lt, eq, neq, is_neg          comparisons returning a mask
+ *   select(m, a, b)              m ? b : a
+ *   mask_or                      mask combination
+ *   mask_from_bits, mask_bits    conversion between mask and lane bitmap
+ */
+
+#include "decoder_batch.h"
+#include "timing.h"
+
+namespace {
+    
+    /** Apply the correction of the selected min-sum variant to both minima of a check */
+    template<class V> inline void batch_correct(const ldpc::batch::conf_t *c, typename V::vec *min1, typename V::vec *min2, typename V::factor factor, typename V::vec offset) {
+        const typename V::vec zero = V::set1(0);
+        
+        if(c->algorithm == ldpc::checknode::NORMALIZED_MIN_SUM) {
+            *min1 = V::scale(*min1, factor);
+            *min2 = V::scale(*min2, factor);
+        } else if(c->algorithm == ldpc::checknode::OFFSET_MIN_SUM) {
+            *min1 = V::max(V::sub(*min1, offset), zero);
+            *min2 = V::max(V::sub(*min2, offset), zero);
+        }
+    }
+    
+    template<class V> void batch_layered(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w, typename V::mask act, typename V::factor factor, typename V::vec offset) {
+        typedef typename V::vec vec;
+        typedef typename V::mask mask;
+        const uint64_t L = V::LANES;
+        
+        const vec llr_max = V::set1(V::LLR_MAX);
+        const vec zero = V::set1(0);
+        
+        for(uint64_t check_indx=0; check_indx<g->N; check_indx++) {
+            const uint64_t first = g->check_offsets[check_indx];
+            const uint64_t num = g->check_offsets[check_indx+1] - first;
+            
+            vec min1 = llr_max;
+            vec min2 = llr_max;
+            vec sign = zero;
+            
+            // Remove the old message from the posterior and find the two smallest magnitudes
+            for(uint64_t k=0; k<num; k++) {
+                const uint64_t bit_indx = g->check_edges[first+k];
+                const vec t = V::sub(V::load(&w->posterior[bit_indx*L]), V::load(&w->msg_c2b[(first+k)*L]));
+                V::store(&w->check_buf[k*L], t);
+                
+                const vec mag = V::abs(t);
+                sign = V::parity(sign, t);
+                
+                const mask m1 = V::lt(mag, min1);
+                min2 = V::select(m1, V::min(min2, mag), min1);
+                min1 = V::min(min1, mag);
+            }
+            
+            vec min1_corr = min1;
+            vec min2_corr = min2;
+            batch_correct<V>(c, &min1_corr, &min2_corr, factor, offset);
+            
+            // Compute new messages and add them to the posterior of active lanes. Edges holding the minimum
+            // get the second smallest magnitude, which is the same value if the minimum is not unique.
+            for(uint64_t k=0; k<num; k++) {
+                const uint64_t bit_indx = g->check_edges[first+k];
+                const vec t = V::load(&w->check_buf[k*L]);
+                const vec mag = V::select(V::eq(V::abs(t), min1), min1_corr, min2_corr);
+                const vec msg = V::apply_sign(mag, V::parity(sign, t));
+                
+                typename V::elem *c2b = &w->msg_c2b[(first+k)*L];
+                typename V::elem *post = &w->posterior[bit_indx*L];
+                V::store(c2b, V::select(act, V::load(c2b), msg));
+                V::store(post, V::select(act, V::load(post), V::add(t, msg)));
+            }
+        }
+    }
+    
+    /** Layered update of the T rows i0...i0+T-1 of a quasi-cyclic block row
+     *
+     * Row i of a circulant with shift s is connected to bit (i+s)%Z of its block column. The rows of a block row
+     * share no bit, so the minima of all T rows are collected circulant by circulant and kept in registers.
+     */
+    template<class V, uint64_t T> inline void batch_qc_rows(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w, typename V::mask act, typename V::factor factor, typename V::vec offset, uint64_t first, uint64_t last, uint64_t i0) {
+        typedef typename V::elem elem;
+        typedef typename V::vec vec;
+        const uint64_t L = V::LANES;
+        const uint64_t Z = g->Z;
+        
+        vec min1[T];
+        vec min2[T];
+        vec sign[T];
+        for(uint64_t i=0; i<T; i++) {
+            min1[i] = V::set1(V::LLR_MAX);
+            min2[i] = V::set1(V::LLR_MAX);
+            sign[i] = V::set1(0);
+        }
+        
+        // Remove the old messages from the posterior and find the two smallest magnitudes of every row
+        for(uint64_t k=first; k<last; k++) {
+            const elem *post = &w->posterior[g->block_cols[k]*Z*L];
+            const elem *c2b = &w->msg_c2b[(k*Z + i0)*L];
+            uint64_t bit = i0 + g->block_shifts[k];
+            bit = (bit >= Z) ? bit-Z : bit;
+            
+            for(uint64_t i=0; i<T; i++) {
+                const vec t = V::sub(V::load(&post[bit*L]), V::load(&c2b[i*L]));
+                const vec mag = V::abs(t);
+                sign[i] = V::parity(sign[i], t);
+                min2[i] = V::select(V::lt(mag, min1[i]), V::min(min2[i], mag), min1[i]);
+                min1[i] = V::min(min1[i], mag);
+                bit = (bit+1 == Z) ? 0 : bit+1;
+            }
+        }
+        
+        vec min1_corr[T];
+        vec min2_corr[T];
+        for(uint64_t i=0; i<T; i++) {
+            min1_corr[i] = min1[i];
+            min2_corr[i] = min2[i];
+            batch_correct<V>(c, &min1_corr[i], &min2_corr[i], factor, offset);
+        }
+        
+        // Compute new messages and add them to the posterior of active lanes, the posterior of these bits has
+        // not been changed by any other row of the block row
+        for(uint64_t k=first; k<last; k++) {
+            elem *post = &w->posterior[g->block_cols[k]*Z*L];
+            elem *c2b = &w->msg_c2b[(k*Z + i0)*L];
+            uint64_t bit = i0 + g->block_shifts[k];
+            bit = (bit >= Z) ? bit-Z : bit;
+            
+            for(uint64_t i=0; i<T; i++) {
+                const vec t = V::sub(V::load(&post[bit*L]), V::load(&c2b[i*L]));
+                const vec mag = V::select(V::eq(V::abs(t), min1[i]), min1_corr[i], min2_corr[i]);
+                const vec msg = V::apply_sign(mag, V::parity(sign[i], t));
+                
+                V::store(&c2b[i*L], V::select(act, V::load(&c2b[i*L]), msg));
+                V::store(&post[bit*L], V::select(act, V::load(&post[bit*L]), V::add(t, msg)));
+                bit = (bit+1 == Z) ? 0 : bit+1;
+            }
+        }
+    }
+    
+    /** Layered update of a whole quasi-cyclic block row, one circulant after the other
+     *
+     * The minima of all Z rows are kept in work_t::row_buf. The loops over the rows are split where the
+     * rotation wraps around, both parts access the messages, the posterior and the row minima contiguously.
+     */
+    template<class V> inline void batch_qc_block_row(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w, typename V::mask act, typename V::factor factor, typename V::vec offset, uint64_t first, uint64_t last) {
+        typedef typename V::elem elem;
+        typedef typename V::vec vec;
+        const uint64_t L = V::LANES;
+        const uint64_t Z = g->Z;
+        
+        elem *row_min1 = w->row_buf;
+        elem *row_min2 = &w->row_buf[Z*L];
+        elem *row_min1_corr = &w->row_buf[2*Z*L];
+        elem *row_sign = &w->row_buf[3*Z*L];
+        
+        for(uint64_t i=0; i<Z; i++) {
+            V::store(&row_min1[i*L], V::set1(V::LLR_MAX));
+            V::store(&row_min2[i*L], V::set1(V::LLR_MAX));
+            V::store(&row_sign[i*L], V::set1(0));
+        }
+        
+        // Remove the old messages from the posterior and find the two smallest magnitudes of every row
+        for(uint64_t k=first; k<last; k++) {
+            const elem *post = &w->posterior[g->block_cols[k]*Z*L];
+            const elem *c2b = &w->msg_c2b[k*Z*L];
+            const uint64_t split = Z - g->block_shifts[k];
+            
+            for(uint64_t part=0; part<2; part++) {
+                const uint64_t begin = part ? split : 0;
+                const uint64_t end = part ? Z : split;
+                const elem *p = part ? &post[0] : &post[(Z-split)*L];
+                
+                for(uint64_t i=begin, j=0; i<end; i++, j++) {
+                    const vec t = V::sub(V::load(&p[j*L]), V::load(&c2b[i*L]));
+                    const vec mag = V::abs(t);
+                    const vec min1 = V::load(&row_min1[i*L]);
+                    V::store(&row_sign[i*L], V::parity(V::load(&row_sign[i*L]), t));
+                    V::store(&row_min2[i*L], V::select(V::lt(mag, min1), V::min(V::load(&row_min2[i*L]), mag), min1));
+                    V::store(&row_min1[i*L], V::min(min1, mag));
+                }
+            }
+        }
+        
+        // Corrected magnitudes, the raw smallest one is kept to find the edges holding it
+        for(uint64_t i=0; i<Z; i++) {
+            vec min1_corr = V::load(&row_min1[i*L]);
+            vec min2_corr = V::load(&row_min2[i*L]);
+            batch_correct<V>(c, &min1_corr, &min2_corr, factor, offset);
+            V::store(&row_min1_corr[i*L], min1_corr);
+            V::store(&row_min2[i*L], min2_corr);
+        }
+        
+        // Compute new messages and add them to the posterior of active lanes
+        for(uint64_t k=first; k<last; k++) {
+            elem *post = &w->posterior[g->block_cols[k]*Z*L];
+            elem *c2b = &w->msg_c2b[k*Z*L];
+            const uint64_t split = Z - g->block_shifts[k];
+            
+            for(uint64_t part=0; part<2; part++) {
+                const uint64_t begin = part ? split : 0;
+                const uint64_t end = part ? Z : split;
+                elem *p = part ? &post[0] : &post[(Z-split)*L];
+                
+                for(uint64_t i=begin, j=0; i<end; i++, j++) {
+                    const vec t = V::sub(V::load(&p[j*L]), V::load(&c2b[i*L]));
+                    const vec mag = V::select(V::eq(V::abs(t), V::load(&row_min1[i*L])), V::load(&row_min1_corr[i*L]), V::load(&row_min2[i*L]));
+                    const vec msg = V::apply_sign(mag, V::parity(V::load(&row_sign[i*L]), t));
+                    
+                    V::store(&c2b[i*L], V::select(act, V::load(&c2b[i*L]), msg));
+                    V::store(&p[j*L], V::select(act, V::load(&p[j*L]), V::add(t, msg)));
+                }
+            }
+        }
+    }
+    
+    /** Layered schedule of quasi-cyclic codes
+     *
+     * Bits are addressed by rotation instead of the edge index arrays, the messages of a circulant are stored
+     * one after the other. The rows of a block row share no bit, so they can be processed in any order. A
+     * single frame is processed a whole block row at a time, which turns the loops over the rows into
+     * contiguous loops across the circulants. Groups of frames are processed in tiles of DECODER_BATCH_QC_TILE
+     * rows, whose minima fit into registers.
+     */
+    template<class V> void batch_layered_qc(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w, typename V::mask act, typename V::factor factor, typename V::vec offset) {
+        for(uint64_t r=0; r<g->base_rows; r++) {
+            const uint64_t first = g->block_offsets[r];
+            const uint64_t last = g->block_offsets[r+1];
+            
+            if(V::LANES == 1) {
+                batch_qc_block_row<V>(g, c, w, act, factor, offset, first, last);
+                continue;
+            }
+            
+            uint64_t i = 0;
+            for(; i+DECODER_BATCH_QC_TILE<=g->Z; i+=DECODER_BATCH_QC_TILE) {
+                batch_qc_rows<V, DECODER_BATCH_QC_TILE>(g, c, w, act, factor, offset, first, last, i);
+            }
+            for(; i<g->Z; i++) {
+                batch_qc_rows<V, 1>(g, c, w, act, factor, offset, first, last, i);
+            }
+        }
+    }
+    
+    template<class V> void batch_flooding(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w, typename V::mask act, typename V::factor factor, typename V::vec offset) {
+        typedef typename V::vec vec;
+        typedef typename V::mask mask;
+        const uint64_t L = V::LANES;
+        
+        const vec llr_max = V::set1(V::LLR_MAX);
+        const vec zero = V::set1(0);
+        
+        // Bit nodes: posterior and extrinsic messages
+        for(uint64_t bit_indx=0; bit_indx<g->M; bit_indx++) {
+            const uint64_t first = g->bit_offsets[bit_indx];
+            const uint64_t last = g->bit_offsets[bit_indx+1];
+            
+            vec sum = V::load(&w->channel[bit_indx*L]);
+            for(uint64_t f=first; f<last; f++) {
+                sum = V::add(sum, V::load(&w->msg_c2b[f*L]));
+            }
+            
+            typename V::elem *post = &w->posterior[bit_indx*L];
+            V::store(post, V::select(act, V::load(post), sum));
+            
+            for(uint64_t f=first; f<last; f++) {
+                V::store(&w->msg_b2c[g->edge_b2c[f]*L], V::sub(sum, V::load(&w->msg_c2b[f*L])));
+            }
+        }
+        
+        // Check nodes
+        for(uint64_t check_indx=0; check_indx<g->N; check_indx++) {
+            const uint64_t first = g->check_offsets[check_indx];
+            const uint64_t last = g->check_offsets[check_indx+1];
+            
+            vec min1 = llr_max;
+            vec min2 = llr_max;
+            vec sign = zero;
+            
+            for(uint64_t e=first; e<last; e++) {
+                const vec t = V::load(&w->msg_b2c[e*L]);
+                const vec mag = V::abs(t);
+                sign = V::parity(sign, t);
+                
+                const mask m1 = V::lt(mag, min1);
+                min2 = V::select(m1, V::min(min2, mag), min1);
+                min1 = V::min(min1, mag);
+            }
+            
+            vec min1_corr = min1;
+            vec min2_corr = min2;
+            batch_correct<V>(c, &min1_corr, &min2_corr, factor, offset);
+            
+            for(uint64_t e=first; e<last; e++) {
+                const vec t = V::load(&w->msg_b2c[e*L]);
+                const vec mag = V::select(V::eq(V::abs(t), min1), min1_corr, min2_corr);
+                const vec msg = V::apply_sign(mag, V::parity(sign, t));
+                
+                typename V::elem *c2b = &w->msg_c2b[g->edge_c2b[e]*L];
+                V::store(c2b, V::select(act, V::load(c2b), msg));
+            }
+        }
+    }
+    
+    template<class V> void batch_decode(const ldpc::batch::graph_t *g, const ldpc::batch::conf_t *c, ldpc::batch::work_t<typename V::elem> *w) {
+        typedef typename V::elem elem;
+        typedef typename V::vec vec;
+        typedef typename V::mask mask;
+        const uint64_t L = V::LANES;
+        
+        const vec min_mag = V::set1(static_cast<elem>(c->min_llr_mag));
+        const typename V::factor factor = V::make_scale(c->algorithm_param);
+        const vec offset = V::set1(static_cast<elem>(c->algorithm_param));
+        
+        const uint64_t deadline = ldpc::timing::deadline(c->max_time_us);
+        
+        uint64_t active = 0;
+        for(uint64_t l=0; l<L; l++) {
+            active |= w->active[l] ? (static_cast<uint64_t>(1)<<l) : 0u;
+            w->num_iterations[l] = 0;
+            w->syndrome_count[l] = 0;
+            w->failure_flags[l] = ldpc::decoder::NONE;
+        }
+        
+        // Reset messages and start with the channel information
+        for(uint64_t i=0; i<g->E*L; i++) {
+            w->msg_c2b[i] = 0;
+        }
+        for(uint64_t i=0; i<g->M*L; i++) {
+            w->posterior[i] = w->channel[i];
+            w->posterior_last[i] = w->channel[i];
+        }
+        
+        for(uint64_t iteration=0; active!=0 && iteration<c->max_iterations; iteration++) {
+            const mask act = V::mask_from_bits(active);
+            
+            if(c->sched == ldpc::schedule::LAYERED && g->Z > 0) {
+                batch_layered_qc<V>(g, c, w, act, factor, offset);
+            } else if(c->sched == ldpc::schedule::LAYERED) {
+                batch_layered<V>(g, c, w, act, factor, offset);
+            } else {
+                batch_flooding<V>(g, c, w, act, factor, offset);
+            }
+            
+            // Number of unfulfilled syndromes per lane
+            for(uint64_t l=0; l<L; l++) {
+                w->syndrome_count[l] = 0;
+            }
+            for(uint64_t check_indx=0; check_indx<g->N; check_indx++) {
+                vec parity = V::set1(0);
+                mask undef = V::mask_from_bits(0);
+                for(uint64_t e=g->check_offsets[check_indx]; e<g->check_offsets[check_indx+1]; e++) {
+                    const vec p = V::load(&w->posterior[g->check_edges[e]*L]);
+                    parity = V::parity(parity, p);
+                    undef = V::mask_or(undef, V::lt(V::abs(p), min_mag));
+                }
+                
+                uint64_t unfulfilled = V::mask_bits(V::mask_or(undef, V::is_neg(parity))) & active;
+                while(unfulfilled) {
+                    w->syndrome_count[__builtin_ctzll(unfulfilled)]++;
+                    unfulfilled &= unfulfilled-1;
+                }
+            }
+            
+            // Lanes in which any posterior LLR changed
+            mask changed = V::mask_from_bits(0);
+            for(uint64_t bit_indx=0; bit_indx<g->M; bit_indx++) {
+                const vec p = V::load(&w->posterior[bit_indx*L]);
+                changed = V::mask_or(changed, V::neq(p, V::load(&w->posterior_last[bit_indx*L])));
+                V::store(&w->posterior_last[bit_indx*L], p);
+            }
+            const uint64_t changed_lanes = V::mask_bits(changed);
+            
+            const bool deadline_passed = ldpc::timing::passed(deadline);
+            
+            // Retire converged, stuck or timed out lanes
+            for(uint64_t l=0; l<L; l++) {
+                const uint64_t lane = static_cast<uint64_t>(1)<<l;
+                if(!(active & lane)) {
+                    continue;
+                }
+                
+                w->num_iterations[l] = iteration+1;
+                
+                const bool stuck = (c->stop_unchanged && iteration > 0 && !(changed_lanes & lane));
+                if(stuck) {
+                    w->failure_flags[l] |= ldpc::decoder::NO_SOFTBITS_CHANGE;
+                }
+                if(!stuck && w->syndrome_count[l] > 0 && iteration+1 >= c->max_iterations) {
+                    w->failure_flags[l] |= ldpc::decoder::MAX_ITERATIONS;
+                }
+                if(!stuck && w->syndrome_count[l] > 0 && deadline_passed) {
+                    w->failure_flags[l] |= ldpc::decoder::DEADLINE;
+                }
+                if(stuck || w->syndrome_count[l] == 0 || deadline_passed) {
+                    active &= ~lane;
+                }
+            }
+        }
+    }
+}
+
+#endif /* __LIBLDPC_DECODER_BATCH_IMPL_H__DEFINED__ */
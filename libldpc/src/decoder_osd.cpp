@@ -0,0 +1,289 @@
+#include <ldpc/decoder.h>
+#include "gf2.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+    /** Test pattern enumeration of ordered statistics decoding
+     *
+     * The pattern costs are integers, the reliability of every pivot bit is stored bit sliced in planes, so
+     * the cost of the pivot bits that differ from their hard decision is a few popcounts per word.
+     */
+    struct osd_search_t {
+        /** Words of a vector over the pivot rows */
+        uint64_t words;
+        
+        /** Number of candidate bits and largest number of flipped bits */
+        uint64_t window;
+        uint64_t order;
+        
+        /** Pivot bits toggled by each candidate bit (window vectors) */
+        const ldpc::gf2::word_t *cols;
+        
+        /** Bit planes of the pivot bit costs (DECODER_OSD_WEIGHT_BITS vectors) */
+        const ldpc::gf2::word_t *planes;
+        
+        /** Cost of flipping each candidate bit, not decreasing */
+        const uint64_t *flip_cost;
+        
+        /** Pivot bits differing from their hard decision for every level of the enumeration (order+1 vectors) */
+        ldpc::gf2::word_t *stack;
+        
+        /** Candidate bits of the current pattern */
+        uint64_t *flips;
+        
+        /** Cheapest pattern so far */
+        uint64_t best_cost;
+        uint64_t *best_flips;
+        uint64_t best_num;
+        
+        uint64_t num_patterns;
+    };
+    
+    uint64_t osd_cost(const osd_search_t *s, const ldpc::gf2::word_t *d) {
+        uint64_t cost = 0;
+        for(uint64_t b=0; b<DECODER_OSD_WEIGHT_BITS; b++) {
+            cost += ldpc::gf2::weight_and(d, &s->planes[b*s->words], s->words) << b;
+        }
+        return cost;
+    }
+    
+    /** Try all patterns that add one candidate bit from first on to the pattern of the given level */
+    void osd_search(osd_search_t *s, uint64_t level, uint64_t first, uint64_t cost_flips) {
+        const ldpc::gf2::word_t *d = &s->stack[level*s->words];
+        ldpc::gf2::word_t *next = &s->stack[(level+1)*s->words];
+        
+        for(uint64_t f=first; f<s->window; f++) {
+            // The costs of the candidates grow, so no later pattern can be cheaper either
+            const uint64_t cost_info = cost_flips + s->flip_cost[f];
+            if(cost_info >= s->best_cost) {
+                break;
+            }
+            
+            ldpc::gf2::sum(next, d, &s->cols[f*s->words], s->words);
+            const uint64_t cost = cost_info + osd_cost(s, next);
+            s->flips[level] = f;
+            s->num_patterns++;
+            
+            if(cost < s->best_cost) {
+                s->best_cost = cost;
+                s->best_num = level+1;
+                std::memcpy(s->best_flips, s->flips, (level+1)*sizeof(uint64_t));
+            }
+            
+            if(level+1 < s->order) {
+                osd_search(s, level+1, f+1, cost_info);
+            }
+        }
+    }
+}
+
+bool ldpc::decoder::decode_osd(softbit_t *out, const softbit_t *input, metadata_t *meta, uint64_t order) {
+    metadata_t result;
+    this->load_channel(input);
+    if(this->decode_channel(out, &result, NULL)) {
+        if(meta) {
+            *meta = result;
+        }
+        return true;
+    }
+    
+    const uint64_t M = this->graph->M;
+    const uint64_t N = this->graph->N;
+    const uint64_t words = gf2::num_words(M);
+    const softbit_t *posterior = this->posterior;
+    
+    // Bits from the least to the most reliable
+    uint64_t *bits = new uint64_t[M];
+    for(uint64_t i=0; i<M; i++) {
+        bits[i] = i;
+    }
+    std::stable_sort(bits, bits+M, [posterior](uint64_t a, uint64_t b) {
+        return my_abs(posterior[a]) < my_abs(posterior[b]);
+    });
+    
+    // Bit-packed parity check matrix
+    gf2::word_t *rows = new gf2::word_t[N*words]();
+    for(uint64_t j=0; j<N; j++) {
+        for(uint64_t e=this->graph->check_offsets[j]; e<this->graph->check_offsets[j+1]; e++) {
+            gf2::flip(&rows[j*words], this->graph->check_edges[e]);
+        }
+    }
+    
+    // Gauss-Jordan elimination with the pivots in the least reliable independent columns
+    uint64_t *pivots = new uint64_t[N];
+    bool *is_pivot = new bool[M]();
+    uint64_t rank = 0;
+    for(uint64_t k=0; k<M && rank<N; k++) {
+        const uint64_t c = bits[k];
+        
+        uint64_t r = rank;
+        while(r < N && !gf2::get(&rows[r*words], c)) {
+            r++;
+        }
+        if(r == N) {
+            continue;
+        }
+        if(r != rank) {
+            std::swap_ranges(&rows[r*words], &rows[(r+1)*words], &rows[rank*words]);
+        }
+        
+        const gf2::word_t *pivot_row = &rows[rank*words];
+        for(uint64_t i=0; i<N; i++) {
+            if(i != rank && gf2::get(&rows[i*words], c)) {
+                gf2::add(&rows[i*words], pivot_row, words);
+            }
+        }
+        
+        pivots[rank++] = c;
+        is_pivot[c] = true;
+    }
+    
+    // Hard decisions of the information set, each pivot bit follows from its row
+    gf2::word_t *x = new gf2::word_t[words]();
+    for(uint64_t i=0; i<M; i++) {
+        if(!is_pivot[i] && posterior[i] < 0.0f) {
+            gf2::set(x, i);
+        }
+    }
+    
+    // Candidates are the least reliable information bits
+    const uint64_t num_info = M - rank;
+    const uint64_t window = (DECODER_OSD_WINDOW > 0) ? std::min<uint64_t>(DECODER_OSD_WINDOW, num_info) : num_info;
+    uint64_t *candidates = new uint64_t[window];
+    for(uint64_t k=0, n=0; n<window; k++) {
+        if(!is_pivot[bits[k]]) {
+            candidates[n++] = bits[k];
+        }
+    }
+    
+    // Integer costs relative to the most reliable finite bit
+    softbit_t max_mag = 0.0f;
+    for(uint64_t i=0; i<M; i++) {
+        max_mag = (!std::isinf(posterior[i]) && my_abs(posterior[i]) > max_mag) ? my_abs(posterior[i]) : max_mag;
+    }
+    const uint64_t max_cost = (static_cast<uint64_t>(1) << DECODER_OSD_WEIGHT_BITS) - 1;
+    const softbit_t cost_scale = (max_mag > 0.0f) ? static_cast<softbit_t>(max_cost)/max_mag : 0.0f;
+    auto cost_of = [posterior, cost_scale, max_cost](uint64_t i) {
+        const softbit_t mag = my_abs(posterior[i]);
+        return std::isinf(mag) ? max_cost : std::min<uint64_t>(static_cast<uint64_t>(std::lround(mag*cost_scale)), max_cost);
+    };
+    
+    osd_search_t s;
+    s.words = gf2::num_words(rank);
+    s.window = window;
+    s.order = std::min<uint64_t>(order, window);
+    
+    gf2::word_t *cols = new gf2::word_t[window*s.words]();
+    gf2::word_t *planes = new gf2::word_t[DECODER_OSD_WEIGHT_BITS*s.words]();
+    gf2::word_t *stack = new gf2::word_t[(s.order+1)*s.words]();
+    uint64_t *flip_cost = new uint64_t[window];
+    
+    for(uint64_t i=0; i<rank; i++) {
+        const gf2::word_t *row = &rows[i*words];
+        const uint64_t p = pivots[i];
+        
+        // Pivot bits that differ from their hard decision
+        if(gf2::dot(row, x, words) != (posterior[p] < 0.0f)) {
+            gf2::set(stack, i);
+        }
+        
+        const uint64_t cost = cost_of(p);
+        for(uint64_t b=0; b<DECODER_OSD_WEIGHT_BITS; b++) {
+            if((cost >> b) & 0x01u) {
+                gf2::set(&planes[b*s.words], i);
+            }
+        }
+        
+        for(uint64_t f=0; f<window; f++) {
+            if(gf2::get(row, candidates[f])) {
+                gf2::set(&cols[f*s.words], i);
+            }
+        }
+    }
+    for(uint64_t f=0; f<window; f++) {
+        flip_cost[f] = cost_of(candidates[f]);
+    }
+    
+    s.cols = cols;
+    s.planes = planes;
+    s.flip_cost = flip_cost;
+    s.stack = stack;
+    s.flips = new uint64_t[s.order+1];
+    s.best_flips = new uint64_t[s.order+1];
+    s.best_num = 0;
+    s.best_cost = osd_cost(&s, stack);
+    s.num_patterns = 1;
+    
+    if(s.order > 0) {
+        osd_search(&s, 0, 0, 0);
+    }
+    
+    // Re-encode the best pattern
+    gf2::word_t *d = new gf2::word_t[s.words];
+    std::memcpy(d, stack, s.words*sizeof(gf2::word_t));
+    for(uint64_t k=0; k<s.best_num; k++) {
+        gf2::add(d, &cols[s.best_flips[k]*s.words], s.words);
+        gf2::flip(x, candidates[s.best_flips[k]]);
+    }
+    for(uint64_t i=0; i<rank; i++) {
+        if((posterior[pivots[i]] < 0.0f) != gf2::get(d, i)) {
+            gf2::set(x, pivots[i]);
+        }
+    }
+    
+    uint64_t syndrome_count = 0;
+    for(uint64_t j=0; j<N; j++) {
+        bool parity = false;
+        for(uint64_t e=this->graph->check_offsets[j]; e<this->graph->check_offsets[j+1]; e++) {
+            parity ^= gf2::get(x, this->graph->check_edges[e]);
+        }
+        syndrome_count += parity ? 1u : 0u;
+    }
+    
+    uint64_t index_out_first;
+    uint64_t index_out_last;
+    this->graph->get_output_range(&index_out_first, &index_out_last);
+    
+    uint64_t ber_counter = 0;
+    for(uint64_t i=0, j=0; i<M; i++) {
+        const bool bit = gf2::get(x, i);
+        const softbit_t mag = std::max(my_abs(posterior[i]), this->stop.min_llr_mag);
+        
+        if(i>=index_out_first && i<index_out_last) {
+            out[j++] = bit ? -mag : mag;
+        }
+        
+        ber_counter += (!this->graph->punctured[i] && this->channel[i] != 0.0f && (this->channel[i] < 0.0f) != bit) ? 1u : 0u;
+    }
+    
+    // A codeword has been found, whatever stopped belief propagation
+    result.success = (syndrome_count == 0);
+    if(result.success) {
+        result.failure_flags = NONE;
+    }
+    result.syndrome_count = syndrome_count;
+    result.num_corrected = ber_counter;
+    result.num_guesses = s.num_patterns;
+    
+    delete[] s.flips;
+    delete[] s.best_flips;
+    delete[] d;
+    delete[] flip_cost;
+    delete[] stack;
+    delete[] planes;
+    delete[] cols;
+    delete[] candidates;
+    delete[] x;
+    delete[] is_pivot;
+    delete[] pivots;
+    delete[] rows;
+    delete[] bits;
+    
+    if(meta) {
+        *meta = result;
+    }
+    return result.success;
+}
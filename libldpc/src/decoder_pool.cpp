@@ -0,0 +1,331 @@
+#include <ldpc/decoder_pool.h>
+#include <deque>
+#include <stdlib.h>
+
+struct ldpc::decoder_pool::job_t {
+    softbit_t *out;
+    const softbit_t *input;
+    
+    /** Callback and its argument, NULL if the result is delivered through the promise */
+    callback_t callback;
+    void *user;
+    std::promise<decoder::metadata_t> promise;
+    
+    uint64_t stream;
+    uint64_t seq;
+    
+    /** Stopping criteria at the time the frame has been submitted */
+    stopping::conf_t stop;
+    
+    /** Time the frame has been submitted, the time limit counts from here */
+    std::chrono::steady_clock::time_point submit_time;
+    
+    decoder::metadata_t meta;
+};
+
+struct ldpc::decoder_pool::queue_t {
+    std::mutex mutex;
+    std::deque<job_t*> jobs;
+};
+
+ldpc::decoder_pool::decoder_pool(const code *c, uint64_t num_threads, bool ordered) {
+    this->graph = c;
+    this->ordered = ordered;
+    
+    if(num_threads == 0) {
+        num_threads = std::thread::hardware_concurrency();
+        num_threads = (num_threads > 0) ? num_threads : 1;
+    }
+    this->num_threads = num_threads;
+    
+    this->next_queue = 0;
+    this->num_queued = 0;
+    this->num_submitted = 0;
+    this->num_decoded = 0;
+    this->num_delivered = 0;
+    this->stopping = false;
+    this->start_time = std::chrono::steady_clock::now();
+    
+    this->queues = new queue_t[this->num_threads];
+    this->decoders = new decoder*[this->num_threads];
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i] = new decoder(this->graph);
+    }
+    
+    this->threads = new std::thread[this->num_threads];
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->threads[i] = std::thread(&decoder_pool::run_worker, this, i);
+    }
+}
+
+ldpc::decoder_pool::~decoder_pool() {
+    this->wait();
+    
+    {
+        std::lock_guard<std::mutex> lock(this->idle_mutex);
+        this->stopping = true;
+    }
+    this->idle_cond.notify_all();
+    
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->threads[i].join();
+    }
+    delete[] this->threads;
+    
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        delete this->decoders[i];
+    }
+    delete[] this->decoders;
+    delete[] this->queues;
+}
+
+void ldpc::decoder_pool::set_algorithm(checknode::algorithm_t algorithm) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_algorithm(algorithm);
+    }
+}
+
+void ldpc::decoder_pool::set_algorithm(checknode::algorithm_t algorithm, softbit_t param) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_algorithm(algorithm, param);
+    }
+}
+
+void ldpc::decoder_pool::set_schedule(schedule::schedule_t sched) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_schedule(sched);
+    }
+}
+
+void ldpc::decoder_pool::set_domain(llr::domain_t domain) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_domain(domain);
+    }
+}
+
+void ldpc::decoder_pool::set_quantization(quantization::type_t type) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_quantization(type);
+    }
+}
+
+void ldpc::decoder_pool::set_quantization(quantization::type_t type, softbit_t scale, uint64_t clip) {
+    this->wait();
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        this->decoders[i]->set_quantization(type, scale, clip);
+    }
+}
+
+void ldpc::decoder_pool::set_stopping(const stopping::conf_t &stop) {
+    // Validate the criteria right away instead of in a worker
+    decoder::check_stopping(stop);
+    
+    std::lock_guard<std::mutex> lock(this->stop_mutex);
+    this->stop = stop;
+}
+
+void ldpc::decoder_pool::submit(softbit_t *out, const softbit_t *input, callback_t callback, void *user, uint64_t stream) {
+    if(!callback) {
+        fprintf(stderr, "No callback given for decoded frame.\n");
+        exit( EXIT_FAILURE );
+    }
+    
+    job_t *job = new job_t;
+    job->out = out;
+    job->input = input;
+    job->callback = callback;
+    job->user = user;
+    job->stream = stream;
+    
+    this->enqueue(job);
+}
+
+std::future<ldpc::decoder::metadata_t> ldpc::decoder_pool::submit(softbit_t *out, const softbit_t *input, uint64_t stream) {
+    job_t *job = new job_t;
+    job->out = out;
+    job->input = input;
+    job->callback = NULL;
+    job->user = NULL;
+    job->stream = stream;
+    
+    std::future<decoder::metadata_t> result = job->promise.get_future();
+    this->enqueue(job);
+    return result;
+}
+
+void ldpc::decoder_pool::wait(void) {
+    std::unique_lock<std::mutex> lock(this->done_mutex);
+    this->done_cond.wait(lock, [this] { return this->num_delivered == this->num_submitted; });
+}
+
+uint64_t ldpc::decoder_pool::get_num_input(void) const {
+    return this->graph->get_num_input();
+}
+
+uint64_t ldpc::decoder_pool::get_num_output(void) const {
+    return this->graph->get_num_output();
+}
+
+uint64_t ldpc::decoder_pool::get_num_threads(void) const {
+    return this->num_threads;
+}
+
+uint64_t ldpc::decoder_pool::get_queue_depth(void) const {
+    return this->num_queued;
+}
+
+uint64_t ldpc::decoder_pool::get_num_decoded(void) const {
+    return this->num_decoded;
+}
+
+double ldpc::decoder_pool::get_throughput(void) const {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start_time;
+    return static_cast<double>(this->num_decoded) / elapsed.count();
+}
+
+void ldpc::decoder_pool::enqueue(job_t *job) {
+    {
+        std::lock_guard<std::mutex> lock(this->stop_mutex);
+        job->stop = this->stop;
+    }
+    job->submit_time = std::chrono::steady_clock::now();
+    
+    // Sequence numbers are only needed to restore the order of a stream
+    job->seq = 0;
+    if(this->ordered) {
+        std::lock_guard<std::mutex> lock(this->order_mutex);
+        std::map<uint64_t, stream_t>::iterator it = this->streams.find(job->stream);
+        if(it == this->streams.end()) {
+            stream_t s;
+            s.next_submit = 0;
+            s.next_deliver = 0;
+            s.delivering = false;
+            it = this->streams.insert(std::make_pair(job->stream, s)).first;
+        }
+        job->seq = it->second.next_submit++;
+    }
+    
+    {
+        // Counted before it is queued, so wait() cannot miss it
+        std::lock_guard<std::mutex> lock(this->done_mutex);
+        this->num_submitted++;
+    }
+    
+    queue_t *q = &this->queues[this->next_queue++ % this->num_threads];
+    {
+        // Counted under the lock of idle workers, so they cannot miss the wakeup, and before the job can be
+        // taken, so the counter never drops below zero
+        std::lock_guard<std::mutex> idle_lock(this->idle_mutex);
+        this->num_queued++;
+        
+        std::lock_guard<std::mutex> lock(q->mutex);
+        q->jobs.push_back(job);
+    }
+    this->idle_cond.notify_one();
+}
+
+ldpc::decoder_pool::job_t* ldpc::decoder_pool::take_job(uint64_t worker_indx) {
+    // Oldest frame of the own queue first, otherwise steal the newest frame of another queue
+    for(uint64_t i=0; i<this->num_threads; i++) {
+        queue_t *q = &this->queues[(worker_indx+i) % this->num_threads];
+        std::lock_guard<std::mutex> lock(q->mutex);
+        
+        if(!q->jobs.empty()) {
+            job_t *job;
+            if(i == 0) {
+                job = q->jobs.front();
+                q->jobs.pop_front();
+            } else {
+                job = q->jobs.back();
+                q->jobs.pop_back();
+            }
+            this->num_queued--;
+            return job;
+        }
+    }
+    
+    return NULL;
+}
+
+void ldpc::decoder_pool::run_worker(uint64_t worker_indx) {
+    decoder *dec = this->decoders[worker_indx];
+    
+    while(true) {
+        job_t *job = this->take_job(worker_indx);
+        
+        if(!job) {
+            std::unique_lock<std::mutex> lock(this->idle_mutex);
+            this->idle_cond.wait(lock, [this] { return this->stopping || this->num_queued > 0; });
+            
+            if(this->stopping && this->num_queued == 0) {
+                return;
+            }
+            continue;
+        }
+        
+        // Time spent in the queue counts against the time limit, a frame out of time still gets one iteration
+        if(job->stop.max_time_us > 0) {
+            const uint64_t waited = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - job->submit_time).count());
+            job->stop.max_time_us = (waited < job->stop.max_time_us) ? job->stop.max_time_us - waited : 1;
+        }
+        
+        dec->set_stopping(job->stop);
+        dec->decode(job->out, job->input, &job->meta);
+        this->num_decoded++;
+        this->finish(job);
+    }
+}
+
+void ldpc::decoder_pool::finish(job_t *job) {
+    if(!this->ordered) {
+        this->deliver(job);
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(this->order_mutex);
+    stream_t *s = &this->streams[job->stream];
+    s->done[job->seq] = job;
+    
+    // Only one worker delivers the frames of a stream, the others leave their frames to it
+    if(s->delivering) {
+        return;
+    }
+    s->delivering = true;
+    
+    while(true) {
+        std::map<uint64_t, job_t*>::iterator it = s->done.find(s->next_deliver);
+        if(it == s->done.end()) {
+            break;
+        }
+        
+        job_t *next = it->second;
+        s->done.erase(it);
+        s->next_deliver++;
+        
+        // Deliver without the lock, so callbacks can submit further frames
+        lock.unlock();
+        this->deliver(next);
+        lock.lock();
+    }
+    s->delivering = false;
+}
+
+void ldpc::decoder_pool::deliver(job_t *job) {
+    if(job->callback) {
+        job->callback(job->user, job->out, &job->meta);
+    } else {
+        job->promise.set_value(job->meta);
+    }
+    delete job;
+    
+    {
+        std::lock_guard<std::mutex> lock(this->done_mutex);
+        this->num_delivered++;
+    }
+    this->done_cond.notify_all();
+}
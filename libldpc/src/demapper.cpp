@@ -0,0 +1,263 @@
+#include <ldpc/demapper.h>
+#include "decoder_batch.h"
+#include "demapper_kernels.h"
+#include "demapper_impl.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+
+ldpc::demapper::demapper(modulation::modulation_t modtype, softbit_t noise_variance, demapping::demapping_t method) {
+    this->modtype = modtype;
+    
+    softbit_t xy[2*8];
+    if(modtype == modulation::BPSK) {
+        this->bits = 1;
+        this->amplitude = 1.0f;
+        xy[0] = 1.0f;
+        xy[1] = 0.0f;
+        xy[2] = -1.0f;
+        xy[3] = 0.0f;
+    } else if(modtype == modulation::QPSK) {
+        // First bit on I, second bit on Q
+        this->bits = 2;
+        this->amplitude = static_cast<softbit_t>(std::sqrt(0.5));
+        for(uint64_t s=0; s<4; s++) {
+            xy[2*s] = (s & 0x02u) ? -this->amplitude : this->amplitude;
+            xy[2*s+1] = (s & 0x01u) ? -this->amplitude : this->amplitude;
+        }
+    } else if(modtype == modulation::PSK8) {
+        // Neighbouring points differ in a single bit
+        this->bits = 3;
+        this->amplitude = 1.0f;
+        for(uint64_t k=0; k<8; k++) {
+            const uint64_t label = k ^ (k >> 1);
+            xy[2*label] = static_cast<softbit_t>(std::cos(static_cast<double>(k)*M_PI/4.0));
+            xy[2*label+1] = static_cast<softbit_t>(std::sin(static_cast<double>(k)*M_PI/4.0));
+        }
+    } else {
+        fprintf(stderr, "Modulation %d has no predefined constellation, CUSTOM constellations are given by their points.\n", modtype);
+        exit( EXIT_FAILURE );
+    }
+    
+    this->num_points = static_cast<uint64_t>(1) << this->bits;
+    this->init(xy, noise_variance, method);
+}
+
+ldpc::demapper::demapper(uint64_t bits, const softbit_t *points, softbit_t noise_variance, demapping::demapping_t method) {
+    if(bits < 1 || bits > DEMAPPER_MAX_BITS) {
+        fprintf(stderr, "Constellations with %lu bits per symbol are not supported, only up to %d.\n", bits, DEMAPPER_MAX_BITS);
+        exit( EXIT_FAILURE );
+    }
+    
+    this->modtype = modulation::CUSTOM;
+    this->bits = bits;
+    this->amplitude = 0.0f;
+    this->num_points = static_cast<uint64_t>(1) << bits;
+    this->init(points, noise_variance, method);
+}
+
+void ldpc::demapper::init(const softbit_t *xy, softbit_t noise_variance, demapping::demapping_t method) {
+    this->method = method;
+    this->domain = llr::LOG10;
+    
+    this->points = new softbit_t[3*this->num_points];
+    for(uint64_t p=0; p<this->num_points; p++) {
+        this->points[3*p] = 2.0f*xy[2*p];
+        this->points[3*p+1] = 2.0f*xy[2*p+1];
+        this->points[3*p+2] = -(xy[2*p]*xy[2*p] + xy[2*p+1]*xy[2*p+1]);
+    }
+    
+    this->set_noise_variance(noise_variance);
+    
+    this->scale_kernel = demap::select_scale();
+    this->max_log_kernel = demap::select_max_log();
+}
+
+ldpc::demapper::~demapper() {
+    delete[] this->points;
+}
+
+uint64_t ldpc::demapper::get_bits_per_symbol(void) const {
+    return this->bits;
+}
+
+uint64_t ldpc::demapper::get_num_symbols(uint64_t num_llrs) const {
+    return (num_llrs + this->bits - 1)/this->bits;
+}
+
+ldpc::softbit_t ldpc::demapper::get_noise_variance(void) const {
+    return this->noise_variance;
+}
+
+void ldpc::demapper::set_noise_variance(softbit_t noise_variance) {
+    if(noise_variance < 0.0f) {
+        fprintf(stderr, "Noise variance %f is negative.\n", static_cast<double>(noise_variance));
+        exit( EXIT_FAILURE );
+    }
+    
+    this->noise_variance = noise_variance;
+    this->scale = 1.0f/(get_llr_nats(this->domain)*2.0f*noise_variance);
+}
+
+ldpc::llr::domain_t ldpc::demapper::get_domain(void) const {
+    return this->domain;
+}
+
+void ldpc::demapper::set_domain(llr::domain_t domain) {
+    this->domain = domain;
+    this->set_noise_variance(this->noise_variance);
+}
+
+ldpc::softbit_t ldpc::demapper::get_metric(const softbit_t *sample, uint64_t point) const {
+    const softbit_t *p = &this->points[3*point];
+    return p[0]*sample[0] + p[1]*sample[1] + p[2];
+}
+
+ldpc::softbit_t ldpc::demapper::estimate_noise_variance(const softbit_t *samples, uint64_t num_symbols) const {
+    if(num_symbols == 0) {
+        return 0.0f;
+    }
+    const double num = static_cast<double>(num_symbols);
+    
+    if(this->modtype == modulation::BPSK) {
+        // Real samples: E[y^2] = S+N and E[y^4] = S^2+6SN+3N^2
+        double m2 = 0.0;
+        double m4 = 0.0;
+        for(uint64_t n=0; n<num_symbols; n++) {
+            const double y2 = static_cast<double>(samples[n])*static_cast<double>(samples[n]);
+            m2 += y2;
+            m4 += y2*y2;
+        }
+        m2 /= num;
+        m4 /= num;
+        const double s = std::sqrt(std::max(0.0, (3.0*m2*m2 - m4)/2.0));
+        return static_cast<softbit_t>(std::max(0.0, m2 - s));
+    }
+    
+    bool constant_modulus = true;
+    for(uint64_t p=1; p<this->num_points; p++) {
+        constant_modulus = constant_modulus && std::fabs(this->points[3*p+2] - this->points[2]) <= 1.0e-4f*std::fabs(this->points[2]);
+    }
+    
+    if(constant_modulus) {
+        // Complex samples: E[|y|^2] = S+N and E[|y|^4] = S^2+4SN+2N^2, half of N falls on each of I and Q
+        double m2 = 0.0;
+        double m4 = 0.0;
+        for(uint64_t n=0; n<num_symbols; n++) {
+            const double y2 = static_cast<double>(samples[2*n])*static_cast<double>(samples[2*n]) + static_cast<double>(samples[2*n+1])*static_cast<double>(samples[2*n+1]);
+            m2 += y2;
+            m4 += y2*y2;
+        }
+        m2 /= num;
+        m4 /= num;
+        const double s = std::sqrt(std::max(0.0, 2.0*m2*m2 - m4));
+        return static_cast<softbit_t>(std::max(0.0, m2 - s)/2.0);
+    }
+    
+    // Distance to the closest point, whose metric is the largest
+    double sum = 0.0;
+    for(uint64_t n=0; n<num_symbols; n++) {
+        const softbit_t *y = &samples[2*n];
+        softbit_t best = this->get_metric(y, 0);
+        for(uint64_t p=1; p<this->num_points; p++) {
+            best = std::max(best, this->get_metric(y, p));
+        }
+        sum += static_cast<double>(y[0]*y[0] + y[1]*y[1] - best);
+    }
+    return static_cast<softbit_t>(sum/num/2.0);
+}
+
+void ldpc::demapper::demap(softbit_t *llrs, const softbit_t *samples, uint64_t num_llrs) const {
+    // Every sample of BPSK and QPSK is the LLR of one bit
+    if(this->modtype == modulation::BPSK || this->modtype == modulation::QPSK) {
+        this->scale_kernel(llrs, samples, num_llrs, 4.0f*this->amplitude*this->scale);
+        return;
+    }
+    
+    const uint64_t num_symbols = num_llrs/this->bits;
+    const uint64_t rest = num_llrs - num_symbols*this->bits;
+    
+    if(this->method == demapping::EXACT) {
+        this->demap_exact(llrs, samples, num_symbols);
+    } else {
+        this->max_log_kernel(llrs, samples, num_symbols, this->bits, this->num_points, this->points, this->scale);
+    }
+    
+    // Only the first bits of the last symbol are needed
+    if(rest > 0) {
+        softbit_t last[DEMAPPER_MAX_BITS];
+        if(this->method == demapping::EXACT) {
+            this->demap_exact(last, &samples[2*num_symbols], 1);
+        } else {
+            this->max_log_kernel(last, &samples[2*num_symbols], 1, this->bits, this->num_points, this->points, this->scale);
+        }
+        std::copy(last, last+rest, &llrs[num_symbols*this->bits]);
+    }
+}
+
+void ldpc::demapper::demap_exact(softbit_t *out, const softbit_t *samples, uint64_t num_symbols) const {
+    const softbit_t nats = get_llr_nats(this->domain);
+    const softbit_t nat_scale = this->scale*nats;
+    softbit_t metric[static_cast<uint64_t>(1) << DEMAPPER_MAX_BITS];
+    
+    for(uint64_t n=0; n<num_symbols; n++) {
+        for(uint64_t p=0; p<this->num_points; p++) {
+            metric[p] = nat_scale*this->get_metric(&samples[2*n], p);
+        }
+        
+        for(uint64_t b=0; b<this->bits; b++) {
+            const uint64_t shift = this->bits-1-b;
+            
+            // Sum the likelihoods relative to the largest one of each bit value, so none of them overflows
+            softbit_t max[2] = {-HUGE_VALF, -HUGE_VALF};
+            for(uint64_t p=0; p<this->num_points; p++) {
+                max[(p >> shift) & 0x01u] = std::max(max[(p >> shift) & 0x01u], metric[p]);
+            }
+            softbit_t sum[2] = {0.0f, 0.0f};
+            for(uint64_t p=0; p<this->num_points; p++) {
+                sum[(p >> shift) & 0x01u] += std::exp(metric[p] - max[(p >> shift) & 0x01u]);
+            }
+            
+            out[n*this->bits + b] = ((max[0] + std::log(sum[0])) - (max[1] + std::log(sum[1])))/nats;
+        }
+    }
+}
+
+ldpc::demap::scale_t ldpc::demap::select_scale(void) {
+#if defined(LDPC_SIMD_AVX512)
+    if(batch::isa_enabled(batch::AVX512)) {
+        return scale_avx512;
+    }
+#endif
+#if defined(LDPC_SIMD_AVX2)
+    if(batch::isa_enabled(batch::AVX2)) {
+        return scale_avx2;
+    }
+#endif
+    
+    return scale_generic;
+}
+
+ldpc::demap::max_log_t ldpc::demap::select_max_log(void) {
+#if defined(LDPC_SIMD_AVX512)
+    if(batch::isa_enabled(batch::AVX512)) {
+        return max_log_avx512;
+    }
+#endif
+#if defined(LDPC_SIMD_AVX2)
+    if(batch::isa_enabled(batch::AVX2)) {
+        return max_log_avx2;
+    }
+#endif
+    
+    return max_log_generic;
+}
+
+void ldpc::demap::scale_generic(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor) {
+    demap_scale< vec_demap_generic<8> >(out, in, num, factor);
+}
+
+void ldpc::demap::max_log_generic(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale) {
+    demap_max_log< vec_demap_generic<8> >(out, samples, num_symbols, bits, num_points, points, scale);
+}
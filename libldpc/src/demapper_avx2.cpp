@@ -0,0 +1,38 @@
+#include "demapper_kernels.h"
+#include <immintrin.h>
+
+namespace {
+    /** Eight softbits in an AVX2 register */
+    struct vec_demap_avx2 {
+        static const uint64_t LANES = 8;
+        
+        typedef __m256 vec;
+        
+        static inline vec load(const ldpc::softbit_t *p) { return _mm256_loadu_ps(p); }
+        static inline void store(ldpc::softbit_t *p, vec a) { _mm256_storeu_ps(p, a); }
+        static inline vec set1(ldpc::softbit_t a) { return _mm256_set1_ps(a); }
+        
+        static inline void load_iq(const ldpc::softbit_t *p, vec *i, vec *q) {
+            // Both shuffles keep the symbols of each 128 bit half, the permutation restores their order
+            const __m256 a = _mm256_loadu_ps(p);
+            const __m256 b = _mm256_loadu_ps(p+8);
+            *i = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0))), _MM_SHUFFLE(3,1,2,0)));
+            *q = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(_mm256_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1))), _MM_SHUFFLE(3,1,2,0)));
+        }
+        
+        static inline vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+        static inline vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+        static inline vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+        static inline vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+    };
+}
+
+#include "demapper_impl.h"
+
+void ldpc::demap::scale_avx2(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor) {
+    demap_scale<vec_demap_avx2>(out, in, num, factor);
+}
+
+void ldpc::demap::max_log_avx2(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale) {
+    demap_max_log<vec_demap_avx2>(out, samples, num_symbols, bits, num_points, points, scale);
+}
@@ -0,0 +1,40 @@
+#include "demapper_kernels.h"
+#include <immintrin.h>
+
+namespace {
+    /** Sixteen softbits in an AVX-512 register */
+    struct vec_demap_avx512 {
+        static const uint64_t LANES = 16;
+        
+        typedef __m512 vec;
+        
+        static inline vec load(const ldpc::softbit_t *p) { return _mm512_loadu_ps(p); }
+        static inline void store(ldpc::softbit_t *p, vec a) { _mm512_storeu_ps(p, a); }
+        static inline vec set1(ldpc::softbit_t a) { return _mm512_set1_ps(a); }
+        
+        static inline void load_iq(const ldpc::softbit_t *p, vec *i, vec *q) {
+            // Even elements of both registers are I, odd ones Q
+            const __m512i even = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+            const __m512i odd = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+            const __m512 a = _mm512_loadu_ps(p);
+            const __m512 b = _mm512_loadu_ps(p+16);
+            *i = _mm512_permutex2var_ps(a, even, b);
+            *q = _mm512_permutex2var_ps(a, odd, b);
+        }
+        
+        static inline vec add(vec a, vec b) { return _mm512_add_ps(a, b); }
+        static inline vec sub(vec a, vec b) { return _mm512_sub_ps(a, b); }
+        static inline vec mul(vec a, vec b) { return _mm512_mul_ps(a, b); }
+        static inline vec max(vec a, vec b) { return _mm512_max_ps(a, b); }
+    };
+}
+
+#include "demapper_impl.h"
+
+void ldpc::demap::scale_avx512(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor) {
+    demap_scale<vec_demap_avx512>(out, in, num, factor);
+}
+
+void ldpc::demap::max_log_avx512(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale) {
+    demap_max_log<vec_demap_avx512>(out, samples, num_symbols, bits, num_points, points, scale);
+}
@@ -0,0 +1,151 @@
+#ifndef __LIBLDPC_DEMAPPER_IMPL_H__DEFINED__
+#define __LIBLDPC_DEMAPPER_IMPL_H__DEFINED__
+
+/*
+ * Lane-generic demapping kernels.
+ *
+ * This file is included by one translation unit per instruction set, after the vector types of that
+ * instruction set are defined. Everything is kept in an anonymous namespace, like the batch decoding kernel.
+ * Every lane of a vector is one symbol.
+ *
+ * A vector type V has to provide:
+ *   vec, LANES                   vector of LANES softbits
+ *   load, store                  unaligned memory access
+ *   load_iq(p, i, q)             load 2*LANES interleaved samples and split them into I and Q
+ *   set1                         broadcast
+ *   add, sub, mul, max           lane-wise arithmetic
+ */
+
+#include "demapper_kernels.h"
+#include <cfloat>
+#include <cstring>
+
+namespace {
+    
+    /** Plain arrays of L softbits, for compilers to vectorize and for the remaining symbols of the other kernels */
+    template<uint64_t L> struct vec_demap_generic {
+        static const uint64_t LANES = L;
+        
+        struct vec {
+            ldpc::softbit_t v[L];
+        };
+        
+        static inline vec load(const ldpc::softbit_t *p) {
+            vec r;
+            std::memcpy(r.v, p, sizeof(r.v));
+            return r;
+        }
+        
+        static inline void store(ldpc::softbit_t *p, const vec &a) {
+            std::memcpy(p, a.v, sizeof(a.v));
+        }
+        
+        static inline void load_iq(const ldpc::softbit_t *p, vec *i, vec *q) {
+            for(uint64_t l=0; l<L; l++) {
+                i->v[l] = p[2*l];
+                q->v[l] = p[2*l+1];
+            }
+        }
+        
+        static inline vec set1(ldpc::softbit_t a) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = a;
+            }
+            return r;
+        }
+        
+        static inline vec add(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = a.v[l] + b.v[l];
+            }
+            return r;
+        }
+        
+        static inline vec sub(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = a.v[l] - b.v[l];
+            }
+            return r;
+        }
+        
+        static inline vec mul(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = a.v[l] * b.v[l];
+            }
+            return r;
+        }
+        
+        static inline vec max(const vec &a, const vec &b) {
+            vec r;
+            for(uint64_t l=0; l<L; l++) {
+                r.v[l] = (a.v[l] > b.v[l]) ? a.v[l] : b.v[l];
+            }
+            return r;
+        }
+    };
+    
+    template<class V> void demap_scale(ldpc::softbit_t *out, const ldpc::softbit_t *in, uint64_t num, ldpc::softbit_t factor) {
+        const typename V::vec f = V::set1(factor);
+        
+        uint64_t i = 0;
+        for(; i+V::LANES<=num; i+=V::LANES) {
+            V::store(&out[i], V::mul(V::load(&in[i]), f));
+        }
+        for(; i<num; i++) {
+            out[i] = in[i]*factor;
+        }
+    }
+    
+    template<class V> void demap_max_log(ldpc::softbit_t *out, const ldpc::softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const ldpc::softbit_t *points, ldpc::softbit_t scale) {
+        typedef typename V::vec vec;
+        const uint64_t L = V::LANES;
+        const uint64_t num_vec = num_symbols/L*L;
+        const vec s = V::set1(scale);
+        
+        ldpc::softbit_t llr[DEMAPPER_MAX_BITS*V::LANES];
+        vec max0[DEMAPPER_MAX_BITS];
+        vec max1[DEMAPPER_MAX_BITS];
+        
+        for(uint64_t n=0; n<num_vec; n+=L) {
+            vec i, q;
+            V::load_iq(&samples[2*n], &i, &q);
+            
+            for(uint64_t b=0; b<bits; b++) {
+                max0[b] = V::set1(-FLT_MAX);
+                max1[b] = V::set1(-FLT_MAX);
+            }
+            
+            // Largest metric of all points with a zero and with a one in every bit, MSB first
+            for(uint64_t p=0; p<num_points; p++) {
+                const vec m = V::add(V::add(V::mul(V::set1(points[3*p]), i), V::mul(V::set1(points[3*p+1]), q)), V::set1(points[3*p+2]));
+                for(uint64_t b=0; b<bits; b++) {
+                    if((p >> (bits-1-b)) & 0x01u) {
+                        max1[b] = V::max(max1[b], m);
+                    } else {
+                        max0[b] = V::max(max0[b], m);
+                    }
+                }
+            }
+            
+            // Transpose the bits of the lanes into the bits of consecutive symbols
+            for(uint64_t b=0; b<bits; b++) {
+                V::store(&llr[b*L], V::mul(V::sub(max0[b], max1[b]), s));
+            }
+            for(uint64_t l=0; l<L; l++) {
+                for(uint64_t b=0; b<bits; b++) {
+                    out[(n+l)*bits + b] = llr[b*L + l];
+                }
+            }
+        }
+        
+        if(num_vec < num_symbols) {
+            demap_max_log< vec_demap_generic<1> >(&out[num_vec*bits], &samples[2*num_vec], num_symbols-num_vec, bits, num_points, points, scale);
+        }
+    }
+}
+
+#endif /* __LIBLDPC_DEMAPPER_IMPL_H__DEFINED__ */
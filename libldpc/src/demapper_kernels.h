@@ -0,0 +1,36 @@
+#ifndef __LIBLDPC_DEMAPPER_KERNELS_H__DEFINED__
+#define __LIBLDPC_DEMAPPER_KERNELS_H__DEFINED__
+
+#include <ldpc/demapper.h>
+#include <stdint.h>
+
+namespace ldpc {
+    namespace demap {
+        
+        /** Multiply num samples by factor, the LLRs of BPSK and QPSK */
+        typedef void (*scale_t)(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor);
+        
+        /** Max-log LLRs of num_symbols complex samples, points as in demapper::points */
+        typedef void (*max_log_t)(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale);
+        
+        /** One function per instruction set */
+        void scale_generic(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor);
+        void max_log_generic(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale);
+
+#ifdef LDPC_SIMD_AVX2
+        void scale_avx2(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor);
+        void max_log_avx2(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale);
+#endif
+
+#ifdef LDPC_SIMD_AVX512
+        void scale_avx512(softbit_t *out, const softbit_t *in, uint64_t num, softbit_t factor);
+        void max_log_avx512(softbit_t *out, const softbit_t *samples, uint64_t num_symbols, uint64_t bits, uint64_t num_points, const softbit_t *points, softbit_t scale);
+#endif
+        
+        /** Select the widest enabled kernels at runtime, like the batch decoder (see batch::isa_enabled()) */
+        scale_t select_scale(void);
+        max_log_t select_max_log(void);
+    }
+}
+
+#endif /* __LIBLDPC_DEMAPPER_KERNELS_H__DEFINED__ */
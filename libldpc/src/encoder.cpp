@@ -1,41 +1,216 @@
 #include <ldpc/encoder.h>
+#include <ldpc/code.h>
+#include "checksum.h"
+#include "mapped_file.h"
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 
 using namespace ldpc;
 
-encoder::encoder(const char* generator_file, systematic::systematic_t systype, puncturing::conf_t *punctconf) {
+/*
+ * Generator file formats
+ *
+ * Version 1 holds N and K as big endian 64 bit numbers, followed by the N rows of the parity part of the
+ * generator, each padded to full bytes with the information bits MSB first.
+ *
+ * Version 2, the compiled generator, consists of 64 bit words in the byte order of the machine that wrote it.
+ * It starts with a header of GEN_HEADER_WORDS words:
+ *
+ *   0  magic "LDPC-GEN", version 1 files cannot start like this as N would be far too large
+ *   1  format version
+ *   2  N           3  K
+ *   4  words per column, a multiple of ENCODER_BLOCK_WORDS of the writer
+ *   5  byte offset of the columns from the start of the file, a multiple of 64
+ *   6  byte offset of the column order, zero if the codeword bits are in the order of the parity check matrix
+ *   7  checksum of words 0 to 6
+ *
+ * The column order, if any, follows the header with the column of the parity check matrix of every codeword
+ * bit (N+K words, see encoder::get_column_order()). The K generator columns follow in the layout of
+ * encoder::gen_columns, so they can be mapped and encoded from in place with aligned loads. Neither is
+ * checksummed, which would cost as much as reading a version 1 file.
+ */
+
+namespace {
+    const char GEN_MAGIC[8] = {'L', 'D', 'P', 'C', '-', 'G', 'E', 'N'};
+    const uint64_t GEN_VERSION = 2;
+    const uint64_t GEN_HEADER_WORDS = 8;
+    
+    uint64_t read_big_endian(const uint8_t *bytes) {
+        uint64_t ret = 0;
+        for(size_t i=0; i<8; i++) {
+            ret = (ret << 8) | bytes[i];
+        }
+        return ret;
+    }
+    
+    void check_compiled(const uint64_t *h, uint64_t size, const char *file) {
+        if(h[1] != GEN_VERSION) {
+            fprintf(stderr, "Generator %s has format version %lu, but only version %lu is supported.\n", file, h[1], GEN_VERSION);
+            exit( EXIT_FAILURE );
+        }
+        if(checksum::add(checksum::INIT, h, 7) != h[7]) {
+            fprintf(stderr, "Header of generator %s is corrupt.\n", file);
+            exit( EXIT_FAILURE );
+        }
+        
+        const uint64_t N = h[2];
+        const uint64_t K = h[3];
+        const uint64_t stride = h[4];
+        const uint64_t offset = h[5];
+        if(stride == 0 || stride*64 < N || offset % 64 != 0 || offset < GEN_HEADER_WORDS*sizeof(uint64_t) || size < offset || (size-offset)/sizeof(uint64_t)/stride < K) {
+            fprintf(stderr, "Generator %s ends before all %lu columns.\n", file, K);
+            exit( EXIT_FAILURE );
+        }
+        
+        const uint64_t order = h[6];
+        if(order != 0 && (order % sizeof(uint64_t) != 0 || order < GEN_HEADER_WORDS*sizeof(uint64_t) || size < order || (size-order)/sizeof(uint64_t) < N+K)) {
+            fprintf(stderr, "Generator %s ends before its column order.\n", file);
+            exit( EXIT_FAILURE );
+        }
+    }
+    
+    /** Write the header, the column order and K columns of words words each, stride words apart */
+    void write_generator(const char *file, uint64_t N, uint64_t K, const uint64_t *columns, uint64_t words, uint64_t stride, const uint64_t *column_order) {
+        const uint64_t order_words = column_order ? N+K : 0;
+        const uint64_t offset = ((GEN_HEADER_WORDS + order_words)*sizeof(uint64_t) + 63)/64*64;
+        
+        uint64_t h[GEN_HEADER_WORDS];
+        std::memcpy(&h[0], GEN_MAGIC, sizeof(GEN_MAGIC));
+        h[1] = GEN_VERSION;
+        h[2] = N;
+        h[3] = K;
+        h[4] = words;
+        h[5] = offset;
+        h[6] = column_order ? GEN_HEADER_WORDS*sizeof(uint64_t) : 0;
+        h[7] = checksum::add(checksum::INIT, h, 7);
+        
+        FILE *f = fopen(file, "wb");
+        if(!f) {
+            fprintf(stderr, "Cannot open file %s\n", file);
+            exit( EXIT_FAILURE );
+        }
+        
+        // Pad the column order, so the columns start at a multiple of 64 bytes
+        const uint64_t pad[8] = {0};
+        const uint64_t pad_words = offset/sizeof(uint64_t) - GEN_HEADER_WORDS - order_words;
+        bool ok = (fwrite(h, sizeof(uint64_t), GEN_HEADER_WORDS, f) == GEN_HEADER_WORDS);
+        ok = ok && (order_words == 0 || fwrite(column_order, sizeof(uint64_t), order_words, f) == order_words);
+        ok = ok && (pad_words == 0 || fwrite(pad, sizeof(uint64_t), pad_words, f) == pad_words);
+        for(size_t k=0; k<K && ok; k++) {
+            ok = (fwrite(&columns[k*stride], sizeof(uint64_t), words, f) == words);
+        }
+        
+        if(fclose(f) != 0 || !ok) {
+            fprintf(stderr, "Cannot write compiled generator to %s\n", file);
+            exit( EXIT_FAILURE );
+        }
+    }
+}
+
+encoder::encoder(const char* generator_file, systematic::systematic_t systype, puncturing::conf_t *punctconf, encoding::encoding_t enctype, uint64_t circulant_size) {
+    
+    if(enctype == encoding::SPARSE) {
+        const code c(generator_file, systype, punctconf);
+        this->init_sparse(&c);
+        return;
+    }
+    
+    mapped_file *file = new mapped_file(generator_file);
+    const uint64_t size = file->get_size();
+    const uint8_t *data = reinterpret_cast<const uint8_t*>(file->get_data());
+    
+    const uint64_t *header = NULL;
+    if(size >= GEN_HEADER_WORDS*sizeof(uint64_t) && std::memcmp(data, GEN_MAGIC, sizeof(GEN_MAGIC)) == 0) {
+        header = reinterpret_cast<const uint64_t*>(data);
+        check_compiled(header, size, generator_file);
+        this->N = header[2];
+        this->K = header[3];
+    } else {
+        if(size < 16) {
+            fprintf(stderr, "Unable to read generator dimensions from %s.\n", generator_file);
+            exit( EXIT_FAILURE );
+        }
+        this->N = read_big_endian(&data[0]);
+        this->K = read_big_endian(&data[8]);
+    }
+    
+    this->init_dimensions(this->N, this->K, punctconf, systype, enctype);
+    
+    if(header && header[6] != 0) {
+        const uint64_t *order = &header[header[6]/sizeof(uint64_t)];
+        this->column_order = new uint64_t[this->N+this->K];
+        std::copy(order, order+this->N+this->K, this->column_order);
+    }
+    
+    if(enctype == encoding::DENSE) {
+        this->N_punct_words = (this->N_punct+64*ENCODER_BLOCK_WORDS-1)/(64*ENCODER_BLOCK_WORDS)*ENCODER_BLOCK_WORDS;
+    }
+    
+    const uint8_t *rows;
+    uint8_t *rows_copy = NULL;
+    if(header) {
+        const uint64_t *columns = &header[header[5]/sizeof(uint64_t)];
+        const uint64_t stride = header[4];
+        
+        // Only the leading parity bits are encoded, so the columns can be used in place if the others are punctured
+        bool prefix = true;
+        for(size_t i=0; i<this->N && prefix; i++) {
+            prefix = (punctconf->is_punctured(i+this->K,this->N+this->K) == (i >= this->N_punct));
+        }
+        
+        if(enctype == encoding::DENSE && prefix && stride >= this->N_punct_words) {
+            this->gen_columns = const_cast<uint64_t*>(columns);
+            this->gen_stride = stride;
+            this->mapping = file;
+            return;
+        }
+        
+        // Gather the rows for the other encodings
+        rows_copy = new uint8_t[this->N*this->K_bytes];
+        std::memset(rows_copy, 0, this->N*this->K_bytes);
+        for(size_t k=0; k<this->K; k++) {
+            for(size_t i=0; i<this->N; i++) {
+                if(columns[k*stride + i/64] & (0x8000000000000000u >> (i%64))) {
+                    rows_copy[i*this->K_bytes + k/8] = static_cast<uint8_t>(rows_copy[i*this->K_bytes + k/8] | (0x80u >> (k%8)));
+                }
+            }
+        }
+        rows = rows_copy;
+    } else {
+        if(this->K_bytes > 0 && (size-16)/this->K_bytes < this->N) {
+            fprintf(stderr, "Generator %s ends before all %lu rows.\n", generator_file, this->N);
+            exit( EXIT_FAILURE );
+        }
+        rows = &data[16];
+    }
     
-    FILE *fgen = fopen(generator_file, "rb");
-    if(!fgen) {
-        fprintf(stderr, "Cannot open generator file %s\n", generator_file);
+    if(enctype == encoding::DENSE) {
+        this->init_dense(rows, punctconf);
+    } else if(enctype == encoding::QUASI_CYCLIC) {
+        this->init_quasi_cyclic(rows, punctconf, circulant_size);
+    } else {
+        fprintf(stderr, "Unknown encoding type %d.\n", enctype);
         exit( EXIT_FAILURE );
     }
     
-    // Read N
-    uint64_t tmp = 0;
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (7*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (6*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (5*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (4*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (3*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (2*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (1*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (0*8);
-    this->N = tmp;
-    
-    // Read K
-    tmp = 0;
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (7*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (6*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (5*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (4*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (3*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (2*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (1*8);
-    tmp |= ((uint64_t) read_byte(fgen, "generator dimensions")) << (0*8);
-    this->K = tmp;
+    delete[] rows_copy;
+    delete file;
+}
+
+encoder::encoder(const code *c) {
+    this->init_sparse(c);
+    
+    if(c->column_order) {
+        this->column_order = new uint64_t[c->M];
+        std::copy(c->column_order, c->column_order+c->M, this->column_order);
+    }
+}
+
+void encoder::init_dimensions(uint64_t N, uint64_t K, const puncturing::conf_t *punctconf, systematic::systematic_t systype, encoding::encoding_t enctype) {
+    this->N = N;
+    this->K = K;
     
     // Check puncturing
     if(punctconf->type == puncturing::NONE && punctconf->num_punct != 0) {
@@ -51,23 +226,57 @@ encoder::encoder(const char* generator_file, systematic::systematic_t systype, p
     this->N_punct_bytes = static_cast<uint64_t>(ceil(static_cast<double>(this->N_punct)/8.0));
     this->K_bytes = static_cast<uint64_t>(ceil(static_cast<double>(this->K)/8.0));
     
+    this->enctype = enctype;
+    this->N_punct_words = 0;
+    this->gen_columns = NULL;
+    this->gen_stride = 0;
+    this->mapping = NULL;
+    this->Z = 0;
+    this->Z_words = 0;
+    this->circ_words = 0;
+    this->circulants = NULL;
+    this->parity_words = NULL;
+    this->parity_map = NULL;
+    this->windows = NULL;
+    this->set_columns = new const uint64_t*[this->K];
+    this->set_windows = new uint64_t[this->K];
+    this->num_tri = 0;
+    this->tri_offsets = NULL;
+    this->tri_bits = NULL;
+    this->tri_pivots = NULL;
+    this->gap = 0;
+    this->gap_bits = NULL;
+    this->gap_check_offsets = NULL;
+    this->gap_check_bits = NULL;
+    this->gap_inverse = NULL;
+    this->gap_words = 0;
+    this->codeword = NULL;
+    this->gap_syndrome = NULL;
+    this->column_order = NULL;
+    this->systype = systype;
+}
+
+void encoder::init_dense(const uint8_t *rows, puncturing::conf_t *punctconf) {
+    // Scatter the rows of the generator into its columns
+    this->gen_stride = this->N_punct_words;
+    this->gen_columns = new uint64_t[this->K*this->N_punct_words];
+    std::memset(this->gen_columns, 0, this->K*this->N_punct_words*sizeof(uint64_t));
+    
     uint8_t buf;
-    this->parity_checks = new uint8_t*[this->N_punct];
     size_t i_local = 0;
     bool punct;
     for(size_t i=0; i<this->N; i++) {
         
         punct = punctconf->is_punctured(i+this->K,this->N+this->K);
         
-        if(!punct) {
-            this->parity_checks[i_local] = new uint8_t[this->K_bytes];
-        }
-        
+        const uint64_t row_bit = 0x8000000000000000u >> (i_local%64);
         for(size_t j=0; j<this->K_bytes; j++) {
-            buf = read_byte(fgen, "Parity generator byte");
+            buf = rows[i*this->K_bytes + j];
             
-            if(!punct) {
-                this->parity_checks[i_local][j] = buf;
+            for(size_t k=j*8; buf!=0 && k<this->K; k++, buf = static_cast<uint8_t>(buf<<1)) {
+                if(!punct && (buf & 0x80u)) {
+                    this->gen_columns[k*this->N_punct_words + i_local/64] |= row_bit;
+                }
             }
         }
         
@@ -79,15 +288,140 @@ encoder::encoder(const char* generator_file, systematic::systematic_t systype, p
         fprintf(stderr, "Allocated %lu parity checks, but code has %lu.\n", i_local, this->N_punct);
         exit( EXIT_FAILURE );
     }
+}
+
+void encoder::init_quasi_cyclic(const uint8_t *rows, puncturing::conf_t *punctconf, uint64_t circulant_size) {
+    if(circulant_size > 0) {
+        if(!this->is_quasi_cyclic(rows, circulant_size)) {
+            fprintf(stderr, "Generator with %lu parity and %lu information bits does not consist of circulants of size %lu.\n", this->N, this->K, circulant_size);
+            exit( EXIT_FAILURE );
+        }
+        this->Z = circulant_size;
+    } else {
+        // Try the largest common divisor of both dimensions first
+        uint64_t a = this->N;
+        uint64_t b = this->K;
+        while(b != 0) {
+            const uint64_t t = a % b;
+            a = b;
+            b = t;
+        }
+        
+        for(uint64_t z=a; z>1 && this->Z==0; z--) {
+            if(a % z == 0 && this->is_quasi_cyclic(rows, z)) {
+                this->Z = z;
+            }
+        }
+        
+        if(this->Z == 0) {
+            fprintf(stderr, "Unable to find a circulant size for generator with %lu parity and %lu information bits.\n", this->N, this->K);
+            exit( EXIT_FAILURE );
+        }
+    }
     
-    this->systype = systype;
+    this->Z_words = (this->Z+63)/64;
+    this->circ_words = (this->Z+64*this->Z_words)/64 + 2;
+    
+    const uint64_t Nb = this->N/this->Z;
+    const uint64_t Kb = this->K/this->Z;
+    
+    // Encoding always reads ENCODER_BLOCK_WORDS+1 words of a window, keep the last one in bounds
+    const uint64_t circ_alloc = Kb*Nb*this->circ_words + ENCODER_BLOCK_WORDS + 1;
+    this->circulants = new uint64_t[circ_alloc];
+    std::memset(this->circulants, 0, circ_alloc*sizeof(uint64_t));
+    
+    // Keep the first column of every circulant twice in a row
+    for(size_t kb=0; kb<Kb; kb++) {
+        for(size_t nb=0; nb<Nb; nb++) {
+            uint64_t *circ = &this->circulants[(kb*Nb + nb)*this->circ_words];
+            for(size_t i=0; i<this->Z; i++) {
+                if(this->get_generator_bit(rows, nb*this->Z + i, kb*this->Z)) {
+                    circ[i/64] |= 0x8000000000000000u >> (i%64);
+                    circ[(i+this->Z)/64] |= 0x8000000000000000u >> ((i+this->Z)%64);
+                }
+            }
+        }
+    }
+    
+    // Column j of a circulant starts at bit Z-j of the doubled first column
+    this->windows = new uint64_t[this->K];
+    for(size_t k=0; k<this->K; k++) {
+        this->windows[k] = (k/this->Z*Nb*this->circ_words)*64 + (this->Z - k%this->Z) % this->Z;
+    }
+    
+    // One slack word, so blocks not aligned to words can be merged without a bounds check
+    this->parity_words = new uint64_t[this->N/64 + 2];
+    
+    // Map the remaining parity bits to all parity bits, unless they are the leading ones anyway
+    uint64_t *map = new uint64_t[this->N];
+    bool prefix = true;
+    size_t i_local = 0;
+    for(size_t i=0; i<this->N; i++) {
+        if(!punctconf->is_punctured(i+this->K,this->N+this->K)) {
+            prefix = prefix && (i == i_local);
+            map[i_local++] = i;
+        }
+    }
+    if(i_local!=this->N_punct) {
+        fprintf(stderr, "Allocated %lu parity checks, but code has %lu.\n", i_local, this->N_punct);
+        exit( EXIT_FAILURE );
+    }
+    
+    if(prefix) {
+        delete[] map;
+    } else {
+        this->parity_map = map;
+    }
+}
+
+bool encoder::is_quasi_cyclic(const uint8_t *rows, uint64_t circulant_size) const {
+    if(this->N % circulant_size != 0 || this->K % circulant_size != 0) {
+        return false;
+    }
+    
+    // Column j of a circulant is its first column rotated down by j
+    for(size_t nb=0; nb<this->N; nb+=circulant_size) {
+        for(size_t kb=0; kb<this->K; kb+=circulant_size) {
+            for(size_t j=1; j<circulant_size; j++) {
+                for(size_t i=0; i<circulant_size; i++) {
+                    const size_t i_first = (i + circulant_size - j) % circulant_size;
+                    if(this->get_generator_bit(rows, nb+i, kb+j) != this->get_generator_bit(rows, nb+i_first, kb)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    
+    return true;
+}
+
+bool encoder::get_generator_bit(const uint8_t *rows, uint64_t row, uint64_t col) const {
+    return (rows[row*this->K_bytes + col/8] & (0x80u >> (col%8))) != 0;
 }
 
 encoder::~encoder() {
-    for(size_t i=0; i<this->N_punct; i++) {
-        delete[] this->parity_checks[i];
+    if(this->mapping) {
+        delete this->mapping;
+    } else {
+        delete[] this->gen_columns;
     }
-    delete[] this->parity_checks;
+    delete[] this->circulants;
+    delete[] this->parity_words;
+    delete[] this->parity_map;
+    delete[] this->windows;
+    delete[] this->set_columns;
+    delete[] this->set_windows;
+    delete[] this->tri_offsets;
+    delete[] this->tri_bits;
+    delete[] this->tri_pivots;
+    delete[] this->gap_bits;
+    delete[] this->gap_check_offsets;
+    delete[] this->gap_check_bits;
+    delete[] this->gap_inverse;
+    delete[] this->codeword;
+    delete[] this->gap_syndrome;
+    delete[] this->column_order;
 }
 
 uint64_t encoder::get_num_input(void) const {
@@ -102,26 +436,24 @@ uint64_t encoder::get_num_output(void) const {
     }
 }
 
+uint64_t encoder::get_circulant_size(void) const {
+    return this->Z;
+}
+
+const uint64_t* encoder::get_column_order(void) const {
+    return this->column_order;
+}
+
 void encoder::encode(uint8_t *out, const uint8_t *input) {
     
+    uint8_t *par_out = (this->systype == systematic::FRONT) ? &out[this->K_bytes] : out;
     
-    size_t par_ofst = (this->systype == systematic::FRONT) ? this->K_bytes : 0;
-    
-    uint8_t parity_buf;
-    uint8_t output_buf = 0;
-    bool flag_buf;
-    for(size_t i=0; i<this->N_punct_bytes; i++) {
-        output_buf = 0;
-        for(uint8_t j=0; j<8 && i*8+j<this->N_punct; j++) {
-            parity_buf = 0;
-            for(size_t k=0; k<this->K_bytes; k++) {
-                parity_buf ^= input[k] & this->parity_checks[i*8+j][k];
-            }
-            flag_buf = byte_parity(parity_buf);
-            
-            modify_bit(&output_buf, j, flag_buf);
-        }
-        out[i+par_ofst] = output_buf;
+    if(this->enctype == encoding::SPARSE) {
+        this->encode_sparse(par_out, input);
+    } else if(this->enctype == encoding::QUASI_CYCLIC) {
+        this->encode_quasi_cyclic(par_out, this->collect_set_bits(input));
+    } else {
+        this->encode_dense(par_out, this->collect_set_bits(input));
     }
     
     if(this->systype == systematic::FRONT) {
@@ -131,33 +463,134 @@ void encoder::encode(uint8_t *out, const uint8_t *input) {
     }
 }
 
-uint8_t encoder::read_byte(FILE *fp, const char *descr) {
-    uint8_t buf;
+uint64_t encoder::collect_set_bits(const uint8_t *input) {
+    uint64_t num_set = 0;
+    for(size_t k_word=0; k_word*64<this->K; k_word++) {
+        uint64_t bits = 0;
+        for(size_t b=0; b<8 && k_word*8+b<this->K_bytes; b++) {
+            bits |= static_cast<uint64_t>(input[k_word*8+b]) << (56-8*b);
+        }
+        
+        // Ignore padding bits behind K
+        if(this->K-k_word*64 < 64) {
+            bits &= ~(0xFFFFFFFFFFFFFFFFu >> (this->K-k_word*64));
+        }
+        
+        // Bit 63-t of the word is information bit k_word*64+t
+        while(bits) {
+            const uint64_t k = k_word*64 + 63u - static_cast<uint64_t>(__builtin_ctzll(bits));
+            if(this->enctype == encoding::QUASI_CYCLIC) {
+                this->set_windows[num_set] = this->windows[k];
+            } else {
+                this->set_columns[num_set] = &this->gen_columns[k*this->gen_stride];
+            }
+            num_set++;
+            bits &= bits-1;
+        }
+    }
     
-    if(fread(&buf, sizeof(uint8_t), 1, fp) != 1) {
-        fprintf(stderr, "Unable to read byte for %s.\n", descr);
-        exit( EXIT_FAILURE );
+    return num_set;
+}
+
+void encoder::encode_dense(uint8_t *out, uint64_t num_set) {
+    // XOR the collected columns block by block, so the parity words stay in registers
+    for(size_t w=0; w<this->N_punct_words; w+=ENCODER_BLOCK_WORDS) {
+        uint64_t parity[ENCODER_BLOCK_WORDS] = {0};
+        
+        for(size_t s=0; s<num_set; s++) {
+            const uint64_t *col = &this->set_columns[s][w];
+            for(size_t b=0; b<ENCODER_BLOCK_WORDS; b++) {
+                parity[b] ^= col[b];
+            }
+        }
+        
+        for(size_t i=w*8; i<(w+ENCODER_BLOCK_WORDS)*8 && i<this->N_punct_bytes; i++) {
+            out[i] = static_cast<uint8_t>(parity[i/8-w] >> (56-8*(i%8)));
+        }
     }
     
-    return buf;
+    // Mapped columns hold the punctured parity bits as well
+    if(this->N_punct%8 != 0) {
+        out[this->N_punct_bytes-1] &= static_cast<uint8_t>(0xFFu << (8-this->N_punct%8));
+    }
 }
 
-bool encoder::byte_parity(uint8_t byte) {
-    uint8_t par = 0u;
+void encoder::encode_quasi_cyclic(uint8_t *out, uint64_t num_set) {
+    const uint64_t Nb = this->N/this->Z;
+    const uint64_t tail_mask = (this->Z%64 == 0) ? 0xFFFFFFFFFFFFFFFFu : ~(0xFFFFFFFFFFFFFFFFu >> (this->Z%64));
+    
+    std::memset(this->parity_words, 0, (this->N/64 + 2)*sizeof(uint64_t));
     
-    for(uint8_t i=0u; i<8u; i++) {
-        par ^= static_cast<uint8_t>( 0x01u & static_cast<uint8_t>(byte>>i));
+    for(size_t nb=0; nb<Nb; nb++) {
+        for(size_t w=0; w<this->Z_words; w+=ENCODER_BLOCK_WORDS) {
+            uint64_t parity[ENCODER_BLOCK_WORDS] = {0};
+            
+            // XOR the rotated first columns, every rotation is a window into the doubled column
+            const uint64_t *circ = &this->circulants[nb*this->circ_words + w];
+            for(size_t s=0; s<num_set; s++) {
+                const uint64_t shift = this->set_windows[s]%64;
+                const uint64_t *src = &circ[this->set_windows[s]/64];
+                
+                // Shift in two steps, so a shift of zero does not shift by 64
+                for(size_t b=0; b<ENCODER_BLOCK_WORDS; b++) {
+                    parity[b] ^= (src[b] << shift) | ((src[b+1] >> 1) >> (63-shift));
+                }
+            }
+            
+            // Merge the words into the parity bits, block nb starts at bit nb*Z
+            for(size_t b=0; b<ENCODER_BLOCK_WORDS && w+b<this->Z_words; b++) {
+                const uint64_t word = (w+b+1 == this->Z_words) ? (parity[b] & tail_mask) : parity[b];
+                const uint64_t pos = nb*this->Z + 64*(w+b);
+                this->parity_words[pos/64] |= word >> (pos%64);
+                if(pos%64 != 0) {
+                    this->parity_words[pos/64+1] |= word << (64-pos%64);
+                }
+            }
+        }
+    }
+    
+    if(!this->parity_map) {
+        for(size_t i=0; i<this->N_punct_bytes; i++) {
+            out[i] = static_cast<uint8_t>(this->parity_words[i/8] >> (56-8*(i%8)));
+        }
+        if(this->N_punct%8 != 0) {
+            out[this->N_punct_bytes-1] &= static_cast<uint8_t>(0xFFu << (8-this->N_punct%8));
+        }
+    } else {
+        std::memset(out, 0, this->N_punct_bytes);
+        for(size_t i=0; i<this->N_punct; i++) {
+            const uint64_t p = this->parity_map[i];
+            if(this->parity_words[p/64] & (0x8000000000000000u >> (p%64))) {
+                out[i/8] = static_cast<uint8_t>(out[i/8] | (0x80u >> (i%8)));
+            }
+        }
+    }
+}
+
+void encoder::write_compiled(const char *file) const {
+    if(this->enctype != encoding::DENSE || this->N_punct != this->N) {
+        fprintf(stderr, "Only DENSE encoders without punctured parity bits can be written as compiled generator.\n");
+        exit( EXIT_FAILURE );
     }
     
-    return (par > 0u);
+    write_generator(file, this->N, this->K, this->gen_columns, this->N_punct_words, this->gen_stride, this->column_order);
 }
 
-void encoder::modify_bit(uint8_t *byte, uint8_t pos, bool value) {
-    uint8_t buf = static_cast<uint8_t>(0x01u << (7u-pos)); // one at pos
+void encoder::write_compiled(const char *file, uint64_t N, uint64_t K, const uint8_t *rows, const uint64_t *column_order) {
+    const uint64_t words = (N+64*ENCODER_BLOCK_WORDS-1)/(64*ENCODER_BLOCK_WORDS)*ENCODER_BLOCK_WORDS;
+    const uint64_t K_bytes = (K+7)/8;
     
-    if(value) {
-        *byte |= buf; // Set to one, by OR
-    } else {
-        *byte &= (0xFF ^ buf); // Set to zero by AND (0xFF^buf gives all ones except at position pos
+    // Scatter the rows into the columns, like init_dense() without puncturing
+    uint64_t *columns = new uint64_t[K*words]();
+    for(size_t i=0; i<N; i++) {
+        const uint64_t row_bit = 0x8000000000000000u >> (i%64);
+        for(size_t k=0; k<K; k++) {
+            if(rows[i*K_bytes + k/8] & (0x80u >> (k%8))) {
+                columns[k*words + i/64] |= row_bit;
+            }
+        }
     }
+    
+    write_generator(file, N, K, columns, words, words, column_order);
+    delete[] columns;
 }
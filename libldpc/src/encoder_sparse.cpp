@@ -0,0 +1,255 @@
+#include <ldpc/encoder.h>
+#include <ldpc/code.h>
+#include "gf2.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+using namespace ldpc;
+
+void encoder::init_sparse(const code *c) {
+    this->init_dimensions(c->N, c->K, c->punctconf, c->systype, encoding::SPARSE);
+    
+    const uint64_t N = this->N;
+    const uint64_t K = this->K;
+    const uint64_t M = c->M;
+    
+    // Number of parity bits of every check that are still unknown
+    uint64_t *degree = new uint64_t[N];
+    for(uint64_t j=0; j<N; j++) {
+        degree[j] = 0;
+        for(uint64_t e=c->check_offsets[j]; e<c->check_offsets[j+1]; e++) {
+            degree[j] += (c->check_edges[e] >= K) ? 1u : 0u;
+        }
+    }
+    
+    // Checks with a single unknown parity bit, every check drops to one unknown bit only once
+    uint64_t *ready = new uint64_t[N];
+    uint64_t num_ready = 0;
+    for(uint64_t j=0; j<N; j++) {
+        if(degree[j] == 1) {
+            ready[num_ready++] = j;
+        }
+    }
+    
+    bool *known = new bool[M]();
+    bool *solved = new bool[N]();
+    uint64_t *tri_checks = new uint64_t[N];
+    uint64_t *pivots = new uint64_t[N];
+    uint64_t *gap_bits = new uint64_t[N];
+    uint64_t num_tri = 0;
+    uint64_t gap = 0;
+    
+    auto make_known = [c, known, solved, degree, ready, &num_ready](uint64_t bit) {
+        known[bit] = true;
+        for(uint64_t e=c->bit_offsets[bit]; e<c->bit_offsets[bit+1]; e++) {
+            const uint64_t j = c->bit_edges[e];
+            if(--degree[j] == 1 && !solved[j]) {
+                ready[num_ready++] = j;
+            }
+        }
+    };
+    
+    // Greedy approximate lower triangulation: solve every check with a single unknown parity bit for it, and
+    // if there is none, declare all but one unknown bits of the check with the fewest of them gap bits
+    while(num_tri + gap < N) {
+        while(num_ready > 0) {
+            const uint64_t j = ready[--num_ready];
+            if(solved[j] || degree[j] != 1) {
+                continue;
+            }
+            
+            uint64_t e = c->check_offsets[j];
+            while(c->check_edges[e] < K || known[c->check_edges[e]]) {
+                e++;
+            }
+            
+            solved[j] = true;
+            tri_checks[num_tri] = j;
+            pivots[num_tri++] = c->check_edges[e];
+            make_known(c->check_edges[e]);
+        }
+        
+        if(num_tri + gap == N) {
+            break;
+        }
+        
+        uint64_t best = N;
+        for(uint64_t j=0; j<N; j++) {
+            if(!solved[j] && degree[j] >= 2 && (best == N || degree[j] < degree[best])) {
+                best = j;
+            }
+        }
+        if(best == N) {
+            fprintf(stderr, "Parity bits of the code cannot be solved for, some are not part of any check.\n");
+            exit( EXIT_FAILURE );
+        }
+        
+        for(uint64_t e=c->check_offsets[best], left=degree[best]; e<c->check_offsets[best+1] && left>1; e++) {
+            const uint64_t b = c->check_edges[e];
+            if(b >= K && !known[b]) {
+                gap_bits[gap++] = b;
+                make_known(b);
+                left--;
+            }
+        }
+    }
+    
+    // Checks in the order of back-substitution, without the bit they are solved for
+    this->num_tri = num_tri;
+    this->tri_offsets = new uint64_t[num_tri+1];
+    this->tri_bits = new uint64_t[c->E];
+    this->tri_pivots = new uint64_t[num_tri];
+    this->tri_offsets[0] = 0;
+    for(uint64_t i=0; i<num_tri; i++) {
+        const uint64_t j = tri_checks[i];
+        uint64_t n = this->tri_offsets[i];
+        for(uint64_t e=c->check_offsets[j]; e<c->check_offsets[j+1]; e++) {
+            if(c->check_edges[e] != pivots[i]) {
+                this->tri_bits[n++] = c->check_edges[e];
+            }
+        }
+        this->tri_offsets[i+1] = n;
+        this->tri_pivots[i] = pivots[i];
+    }
+    
+    // As many checks remain as there are gap bits
+    this->gap = gap;
+    this->gap_words = gf2::num_words(gap);
+    this->gap_bits = new uint64_t[gap];
+    std::copy(gap_bits, gap_bits+gap, this->gap_bits);
+    this->gap_check_offsets = new uint64_t[gap+1];
+    this->gap_check_bits = new uint64_t[c->E];
+    this->gap_check_offsets[0] = 0;
+    for(uint64_t j=0, g=0; j<N; j++) {
+        if(!solved[j]) {
+            uint64_t n = this->gap_check_offsets[g];
+            for(uint64_t e=c->check_offsets[j]; e<c->check_offsets[j+1]; e++) {
+                this->gap_check_bits[n++] = c->check_edges[e];
+            }
+            this->gap_check_offsets[++g] = n;
+        }
+    }
+    
+    this->codeword = new uint8_t[M]();
+    this->gap_syndrome = new uint64_t[this->gap_words];
+    
+    // Syndromes of the remaining checks caused by each gap bit alone, row r holds those of check r
+    gf2::word_t *phi = new gf2::word_t[gap*this->gap_words]();
+    for(uint64_t g=0; g<gap; g++) {
+        this->codeword[this->gap_bits[g]] = 1;
+        this->solve_triangle();
+        this->codeword[this->gap_bits[g]] = 0;
+        
+        for(uint64_t r=0; r<gap; r++) {
+            if(gf2::get(this->gap_syndrome, r)) {
+                gf2::set(&phi[r*this->gap_words], g);
+            }
+        }
+    }
+    
+    // Gauss-Jordan elimination, the row operations that turn phi into the identity are its inverse
+    this->gap_inverse = new uint64_t[gap*this->gap_words]();
+    for(uint64_t r=0; r<gap; r++) {
+        gf2::set(&this->gap_inverse[r*this->gap_words], r);
+    }
+    for(uint64_t i=0; i<gap; i++) {
+        uint64_t r = i;
+        while(r < gap && !gf2::get(&phi[r*this->gap_words], i)) {
+            r++;
+        }
+        if(r == gap) {
+            fprintf(stderr, "Parity bits of the code cannot be solved for, the last %lu columns of the parity check matrix are singular.\n", N);
+            exit( EXIT_FAILURE );
+        }
+        if(r != i) {
+            std::swap_ranges(&phi[r*this->gap_words], &phi[(r+1)*this->gap_words], &phi[i*this->gap_words]);
+            std::swap_ranges(&this->gap_inverse[r*this->gap_words], &this->gap_inverse[(r+1)*this->gap_words], &this->gap_inverse[i*this->gap_words]);
+        }
+        
+        for(uint64_t k=0; k<gap; k++) {
+            if(k != i && gf2::get(&phi[k*this->gap_words], i)) {
+                gf2::add(&phi[k*this->gap_words], &phi[i*this->gap_words], this->gap_words);
+                gf2::add(&this->gap_inverse[k*this->gap_words], &this->gap_inverse[i*this->gap_words], this->gap_words);
+            }
+        }
+    }
+    
+    // Map the remaining parity bits to all parity bits, unless they are the leading ones anyway
+    uint64_t *map = new uint64_t[N];
+    bool prefix = true;
+    uint64_t i_local = 0;
+    for(uint64_t i=0; i<N; i++) {
+        if(!c->punctured[K+i]) {
+            prefix = prefix && (i == i_local);
+            map[i_local++] = i;
+        }
+    }
+    if(i_local!=this->N_punct) {
+        fprintf(stderr, "Allocated %lu parity checks, but code has %lu.\n", i_local, this->N_punct);
+        exit( EXIT_FAILURE );
+    }
+    
+    if(prefix) {
+        delete[] map;
+    } else {
+        this->parity_map = map;
+    }
+    
+    delete[] phi;
+    delete[] gap_bits;
+    delete[] pivots;
+    delete[] tri_checks;
+    delete[] solved;
+    delete[] known;
+    delete[] ready;
+    delete[] degree;
+}
+
+void encoder::solve_triangle(void) {
+    for(uint64_t i=0; i<this->num_tri; i++) {
+        uint8_t bit = 0;
+        for(uint64_t e=this->tri_offsets[i]; e<this->tri_offsets[i+1]; e++) {
+            bit ^= this->codeword[this->tri_bits[e]];
+        }
+        this->codeword[this->tri_pivots[i]] = bit;
+    }
+    
+    std::memset(this->gap_syndrome, 0, this->gap_words*sizeof(uint64_t));
+    for(uint64_t r=0; r<this->gap; r++) {
+        uint8_t bit = 0;
+        for(uint64_t e=this->gap_check_offsets[r]; e<this->gap_check_offsets[r+1]; e++) {
+            bit ^= this->codeword[this->gap_check_bits[e]];
+        }
+        if(bit) {
+            gf2::set(this->gap_syndrome, r);
+        }
+    }
+}
+
+void encoder::encode_sparse(uint8_t *out, const uint8_t *input) {
+    for(uint64_t k=0; k<this->K; k++) {
+        this->codeword[k] = (input[k/8] >> (7-k%8)) & 0x01u;
+    }
+    for(uint64_t g=0; g<this->gap; g++) {
+        this->codeword[this->gap_bits[g]] = 0;
+    }
+    this->solve_triangle();
+    
+    // The gap bits cancel the syndromes of the remaining checks, back-substitute again with them
+    if(this->gap > 0) {
+        for(uint64_t g=0; g<this->gap; g++) {
+            this->codeword[this->gap_bits[g]] = gf2::dot(&this->gap_inverse[g*this->gap_words], this->gap_syndrome, this->gap_words) ? 1u : 0u;
+        }
+        this->solve_triangle();
+    }
+    
+    const uint8_t *parity = &this->codeword[this->K];
+    std::memset(out, 0, this->N_punct_bytes);
+    for(uint64_t i=0; i<this->N_punct; i++) {
+        const uint64_t p = this->parity_map ? this->parity_map[i] : i;
+        if(parity[p]) {
+            out[i/8] = static_cast<uint8_t>(out[i/8] | (0x80u >> (i%8)));
+        }
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef __LIBLDPC_GF2_H__DEFINED__
+#define __LIBLDPC_GF2_H__DEFINED__
+
+#include <stdint.h>
+
+namespace ldpc {
+    /** Bit-packed vectors over GF(2)
+     *
+     * Element i of a vector is bit i%64 of word i/64, unused bits of the last word are zero. All operations
+     * work on whole words, so a row operation of a matrix with M columns takes M/64 word operations.
+     */
+    namespace gf2 {
+        typedef uint64_t word_t;
+        
+        /** Number of words of a vector with num_bits elements */
+        inline uint64_t num_words(uint64_t num_bits) {
+            return (num_bits+63)/64;
+        }
+        
+        inline bool get(const word_t *v, uint64_t i) {
+            return (v[i/64] >> (i%64)) & 0x01u;
+        }
+        
+        inline void set(word_t *v, uint64_t i) {
+            v[i/64] |= static_cast<word_t>(1) << (i%64);
+        }
+        
+        inline void flip(word_t *v, uint64_t i) {
+            v[i/64] ^= static_cast<word_t>(1) << (i%64);
+        }
+        
+        /** dst += src */
+        inline void add(word_t *dst, const word_t *src, uint64_t words) {
+            for(uint64_t w=0; w<words; w++) {
+                dst[w] ^= src[w];
+            }
+        }
+        
+        /** dst = a + b */
+        inline void sum(word_t *dst, const word_t *a, const word_t *b, uint64_t words) {
+            for(uint64_t w=0; w<words; w++) {
+                dst[w] = a[w] ^ b[w];
+            }
+        }
+        
+        /** Inner product of a and b */
+        inline bool dot(const word_t *a, const word_t *b, uint64_t words) {
+            word_t acc = 0;
+            for(uint64_t w=0; w<words; w++) {
+                acc ^= a[w] & b[w];
+            }
+            return __builtin_parityll(acc);
+        }
+        
+        /** Number of ones of a and b */
+        inline uint64_t weight_and(const word_t *a, const word_t *b, uint64_t words) {
+            uint64_t n = 0;
+            for(uint64_t w=0; w<words; w++) {
+                n += static_cast<uint64_t>(__builtin_popcountll(a[w] & b[w]));
+            }
+            return n;
+        }
+    }
+}
+
+#endif /* __LIBLDPC_GF2_H__DEFINED__ */
@@ -1,30 +1,35 @@
 #include <ldpc/ldpc.h>
+#include "llr_approx.h"
+#include <algorithm>
 #include <cstring>
+#include <cmath>
 #include <math.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 
 ldpc::puncturing::conf_t::conf_t(void) : type(NONE), num_punct(0) {}
-            
+
 ldpc::puncturing::conf_t::conf_t(const puncturing_t type, const uint64_t num_punct, uint64_t *punct_pos)
     : type(type), num_punct(num_punct) {
-        
+    
     if(this->type == CUSTOM) {
+        // Sorted, so is_punctured() can search it
         this->punct_pos = new uint64_t[num_punct];
         std::memcpy(this->punct_pos, punct_pos, num_punct*sizeof(uint64_t));
+        std::sort(this->punct_pos, this->punct_pos+num_punct);
     }
 }
-        
+
 ldpc::puncturing::conf_t::conf_t(const conf_t &cpy)
     : type(cpy.type), num_punct(cpy.num_punct) {
-        
+    
     if(this->type == CUSTOM) {
         this->punct_pos = new uint64_t[this->num_punct];
         std::memcpy(this->punct_pos, cpy.punct_pos, this->num_punct*sizeof(uint64_t));
     }
 }
-        
+
 ldpc::puncturing::conf_t::~conf_t(void) {
     if(this->type == CUSTOM) {
         delete[] this->punct_pos;
@@ -41,12 +46,7 @@ bool ldpc::puncturing::conf_t::is_punctured(uint64_t indx, const uint64_t M) con
     } else if(this->type == puncturing::BACK) {
         ret = (indx >= M-this->num_punct);
     } else if(this->type == puncturing::CUSTOM) {
-        for(size_t i=0; i<this->num_punct; i++) {
-            if(indx == this->punct_pos[i]) {
-                ret = true;
-                break;
-            }
-        }
+        ret = std::binary_search(this->punct_pos, this->punct_pos+this->num_punct, indx);
     } else {
         fprintf(stderr, "State machine error.\n");
         exit( EXIT_FAILURE );
@@ -56,12 +56,77 @@ bool ldpc::puncturing::conf_t::is_punctured(uint64_t indx, const uint64_t M) con
     return ret;
 }
 
-ldpc::softbit_t ldpc::prob2llr(const softbit_t prob_one) {
-    return log10((1.0f-prob_one)/prob_one);
+ldpc::softbit_t ldpc::prob2llr(const softbit_t prob_one, llr::domain_t domain) {
+    return std::log((1.0f-prob_one)/prob_one)/get_llr_nats(domain);
+}
+
+ldpc::softbit_t ldpc::llr2prob(const softbit_t llr, llr::domain_t domain) {
+    return 1.0f/(std::exp(llr*get_llr_nats(domain)) + 1.0f);
+}
+
+ldpc::softbit_t ldpc::get_llr_nats(llr::domain_t domain) {
+    return (domain == llr::LOG10) ? 2.302585093f : 1.0f;
 }
+
+const ldpc::softbit_t ldpc::approx::jacobian_table[LLR_JACOBIAN_SIZE+2] = {
+        6.931471806e-01f, 6.623853824e-01f, 6.325990353e-01f, 6.037852896e-01f, 5.759394199e-01f, 5.490548623e-01f, 5.231232641e-01f, 4.981345475e-01f,
+        4.740769842e-01f, 4.509372816e-01f, 4.287006783e-01f, 4.073510473e-01f, 3.868710061e-01f, 3.672420321e-01f, 3.484445810e-01f, 3.304582076e-01f,
+        3.132616875e-01f, 2.968331379e-01f, 2.811501362e-01f, 2.661898366e-01f, 2.519290813e-01f, 2.383445081e-01f, 2.254126516e-01f, 2.131100388e-01f,
+        2.014132780e-01f, 1.902991404e-01f, 1.797446354e-01f, 1.697270782e-01f, 1.602241504e-01f, 1.512139540e-01f, 1.426750576e-01f, 1.345865375e-01f,
+        1.269280110e-01f, 1.196796652e-01f, 1.128222788e-01f, 1.063372400e-01f, 1.002065589e-01f, 9.441287586e-02f, 8.893946547e-02f, 8.377023751e-02f,
+        7.888973429e-02f, 7.428312536e-02f, 6.993619964e-02f, 6.583535553e-02f, 6.196758900e-02f, 5.832048028e-02f, 5.488217916e-02f, 5.164138928e-02f,
+        4.858735157e-02f, 4.570982707e-02f, 4.299907923e-02f, 4.044585600e-02f, 3.804137169e-02f, 3.577728881e-02f, 3.364569998e-02f, 3.163911003e-02f,
+        2.975041827e-02f, 2.797290114e-02f, 2.630019519e-02f, 2.472628046e-02f, 2.324546437e-02f, 2.185236599e-02f, 2.054190090e-02f, 1.930926650e-02f,
+        1.814992792e-02f, 1.705960436e-02f, 1.603425608e-02f, 1.507007185e-02f, 1.416345693e-02f, 1.331102162e-02f, 1.250957028e-02f, 1.175609083e-02f,
+        1.104774485e-02f, 1.038185799e-02f, 9.755911000e-03f, 9.167531084e-03f, 8.614483762e-03f, 8.094665110e-03f, 7.606094404e-03f, 7.146907153e-03f,
+        6.715348489e-03f, 6.309766913e-03f, 5.928608376e-03f, 5.570410673e-03f, 5.233798152e-03f, 4.917476700e-03f, 4.620229019e-03f, 4.340910153e-03f,
+        4.078443271e-03f, 3.831815682e-03f, 3.600075082e-03f, 3.382326003e-03f, 3.177726471e-03f, 2.985484858e-03f, 2.804856903e-03f, 2.635142916e-03f,
+        2.475685138e-03f, 2.325865251e-03f, 2.185102043e-03f, 2.052849194e-03f, 1.928593204e-03f, 1.811851438e-03f, 1.702170282e-03f, 1.599123411e-03f,
+        1.502310160e-03f, 1.411353988e-03f, 1.325901036e-03f, 1.245618763e-03f, 1.170194676e-03f, 1.099335120e-03f, 1.032764154e-03f, 9.702224814e-04f,
+        9.114664538e-04f, 8.562671288e-04f, 8.044093861e-04f, 7.556910953e-04f, 7.099223343e-04f, 6.669246541e-04f, 6.265303873e-04f, 5.885819990e-04f,
+        5.529314754e-04f, 5.194397500e-04f, 4.879761638e-04f, 4.584179581e-04f, 4.306497976e-04f, 4.045633225e-04f, 3.800567272e-04f, 3.570343642e-04f,
+        0.000000000e+00f, 0.000000000e+00f
+};
+
+ldpc::approx::phi_table_t::phi_table_t(uint64_t steps) {
+    uint32_t mantissa_bits = 0;
+    while((static_cast<uint64_t>(1) << mantissa_bits) < steps) {
+        mantissa_bits++;
+    }
     
-ldpc::softbit_t ldpc::llr2prob(const softbit_t llr) {
-    return 1.0f/(pow(10.0f, llr) + 1.0f);
+    const softbit_t min = LLR_PHI_MIN;
+    const softbit_t max = LLR_PHI_MAX;
+    uint32_t min_bits, max_bits;
+    std::memcpy(&min_bits, &min, sizeof(min_bits));
+    std::memcpy(&max_bits, &max, sizeof(max_bits));
+    
+    this->shift = 23u - mantissa_bits;
+    this->base = min_bits >> this->shift;
+    this->size = (max_bits >> this->shift) - this->base + 1u;
+    this->values = new softbit_t[this->size];
+    
+    for(uint64_t k=0; k<this->size; k++) {
+        // Bounds of the cell, the cell of the largest magnitude ends like the ones below it
+        const uint32_t first_bits = static_cast<uint32_t>((this->base + k) << this->shift);
+        const uint32_t last_bits = static_cast<uint32_t>((this->base + k + 1u) << this->shift);
+        softbit_t first, last;
+        std::memcpy(&first, &first_bits, sizeof(first));
+        std::memcpy(&last, &last_bits, sizeof(last));
+        
+        const double x = (static_cast<double>(first) + static_cast<double>(last))/2.0;
+        this->values[k] = static_cast<softbit_t>(-std::log(std::tanh(x/2.0)));
+    }
+}
+
+ldpc::approx::phi_table_t::~phi_table_t() {
+    delete[] this->values;
+}
+
+void ldpc::convert_llrs(softbit_t *out, const softbit_t *in, uint64_t num, llr::domain_t from, llr::domain_t to) {
+    const softbit_t factor = get_llr_nats(from)/get_llr_nats(to);
+    for(uint64_t i=0; i<num; i++) {
+        out[i] = in[i]*factor;
+    }
 }
 
 ldpc::softbit_t ldpc::addllrs(const softbit_t val1, softbit_t val2) {
@@ -0,0 +1,89 @@
+#ifndef __LIBLDPC_LLR_APPROX_H__DEFINED__
+#define __LIBLDPC_LLR_APPROX_H__DEFINED__
+
+#include <ldpc/ldpc.h>
+#include <stdint.h>
+#include <cstring>
+
+/** Table entries per natural LLR unit of the Jacobian logarithm correction */
+#define LLR_JACOBIAN_STEPS 16
+
+/** Number of table intervals of the Jacobian logarithm correction, it is zero from LLR_JACOBIAN_SIZE/LLR_JACOBIAN_STEPS on */
+#define LLR_JACOBIAN_SIZE 128
+
+/** Smallest and largest natural LLR magnitude of the phi table, phi(2^-20) is about 14.6 and phi(16) about 2e-7 */
+#define LLR_PHI_MIN 9.5367431640625e-7f
+#define LLR_PHI_MAX 16.0f
+
+namespace ldpc {
+    namespace approx {
+        
+        /** ln(1+exp(-x)) at x=k/LLR_JACOBIAN_STEPS, the last two entries are zero */
+        extern const softbit_t jacobian_table[LLR_JACOBIAN_SIZE+2];
+        
+        /** ln(1+exp(-x)) of x >= 0, linearly interpolated between the table entries
+         * 
+         * The error is below 4e-4, most of it from cutting the correction off at x=8. NaN yields zero.
+         */
+        inline softbit_t jacobian_correction(const softbit_t x) {
+            // Clipping selects the zero entries beyond the table without a branch
+            softbit_t pos = x*static_cast<softbit_t>(LLR_JACOBIAN_STEPS);
+            pos = (pos < static_cast<softbit_t>(LLR_JACOBIAN_SIZE)) ? pos : static_cast<softbit_t>(LLR_JACOBIAN_SIZE);
+            
+            const int32_t i = static_cast<int32_t>(pos);
+            const softbit_t frac = pos - static_cast<softbit_t>(i);
+            return jacobian_table[i] + frac*(jacobian_table[i+1] - jacobian_table[i]);
+        }
+        
+        /** Natural LLR of the sum of two bits with the natural LLRs a and b, i.e. 2*atanh(tanh(a/2)*tanh(b/2))
+         * 
+         * The Jacobian logarithm turns its magnitude into min(|a|,|b|) + ln(1+exp(-|a|-|b|)) - ln(1+exp(-||a|-|b||)),
+         * so no transcendental function is evaluated and no product of values close to one loses precision. The
+         * magnitude is clipped at zero, so the error of the corrections never flips the sign. +inf is the
+         * neutral element, inf and -inf yield -inf. NaN in either operand yields zero, like an erased bit.
+         * The error is below 8e-4, twice the error of jacobian_correction().
+         */
+        inline softbit_t boxplus(const softbit_t a, const softbit_t b) {
+            const softbit_t mag_a = my_abs(a);
+            const softbit_t mag_b = my_abs(b);
+            const softbit_t sum = mag_a+mag_b;
+            
+            softbit_t mag = (mag_a < mag_b) ? mag_a : mag_b;
+            mag += jacobian_correction(sum) - jacobian_correction(my_abs(mag_a-mag_b));
+            mag = (mag > 0.0f && sum == sum) ? mag : 0.0f;
+            
+            return ((a < 0.0f) != (b < 0.0f)) ? -mag : mag;
+        }
+        
+        /** Table of phi(x) = -ln(tanh(x/2)) over natural LLR magnitudes x
+         * 
+         * The cells are spaced logarithmically, steps (a power of two) per octave from LLR_PHI_MIN (2^-20) to
+         * LLR_PHI_MAX (16). The index of a cell is taken from the exponent and the leading mantissa bits of the
+         * float, so a lookup is a few integer operations and phi has the same relative resolution in its steep
+         * part near zero as in its flat part. Every cell holds phi at its center.
+         */
+        struct phi_table_t {
+            softbit_t *values;
+            uint64_t size;
+            
+            /** Dropped mantissa bits and the index of the first cell in the remaining bits */
+            uint32_t shift;
+            uint32_t base;
+            
+            phi_table_t(uint64_t steps);
+            ~phi_table_t();
+            
+            /** phi of x >= 0, magnitudes beyond the table read its first or last cell, NaN reads the last one */
+            inline softbit_t lookup(softbit_t x) const {
+                x = (x < LLR_PHI_MAX) ? x : LLR_PHI_MAX;
+                x = (x > LLR_PHI_MIN) ? x : LLR_PHI_MIN;
+                
+                uint32_t bits;
+                std::memcpy(&bits, &x, sizeof(bits));
+                return this->values[(bits >> this->shift) - this->base];
+            }
+        };
+    }
+}
+
+#endif /* __LIBLDPC_LLR_APPROX_H__DEFINED__ */
@@ -0,0 +1,48 @@
+#include "mapped_file.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ldpc::mapped_file::mapped_file(const char *file) {
+    const int fd = open(file, O_RDONLY);
+    if(fd < 0) {
+        fprintf(stderr, "Cannot open file %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        fprintf(stderr, "Cannot determine size of file %s\n", file);
+        exit( EXIT_FAILURE );
+    }
+    this->size = static_cast<uint64_t>(st.st_size);
+    
+    // Empty files cannot be mapped
+    this->data = NULL;
+    if(this->size > 0) {
+        void *p = mmap(NULL, this->size, PROT_READ, MAP_SHARED, fd, 0);
+        if(p == MAP_FAILED) {
+            fprintf(stderr, "Cannot map file %s\n", file);
+            exit( EXIT_FAILURE );
+        }
+        this->data = static_cast<const char*>(p);
+    }
+    close(fd);
+}
+
+ldpc::mapped_file::~mapped_file() {
+    if(this->data) {
+        munmap(const_cast<char*>(this->data), this->size);
+    }
+}
+
+const char* ldpc::mapped_file::get_data(void) const {
+    return this->data;
+}
+
+uint64_t ldpc::mapped_file::get_size(void) const {
+    return this->size;
+}
@@ -0,0 +1,27 @@
+#ifndef __LIBLDPC_MAPPED_FILE_H__DEFINED__
+#define __LIBLDPC_MAPPED_FILE_H__DEFINED__
+
+#include <stdint.h>
+
+namespace ldpc {
+    /** Read-only memory map of a whole file
+     *
+     * The pages are loaded on first access and shared with every other process mapping the same file.
+     */
+    class mapped_file {
+    private:
+        const char *data;
+        uint64_t size;
+        
+    public:
+        /** Map the file, exits if it cannot be opened or mapped */
+        mapped_file(const char *file);
+        ~mapped_file();
+        
+        /** Contents of the file, NULL for an empty file */
+        const char* get_data(void) const;
+        uint64_t get_size(void) const;
+    };
+}
+
+#endif /* __LIBLDPC_MAPPED_FILE_H__DEFINED__ */
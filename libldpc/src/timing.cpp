@@ -0,0 +1,28 @@
+#include "timing.h"
+
+namespace {
+    uint64_t measure_ticks_per_us(void) {
+#if defined(__x86_64__) || defined(__i386__)
+        // Count ticks during one millisecond
+        const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        const uint64_t c0 = ldpc::timing::now();
+        
+        std::chrono::steady_clock::time_point t1;
+        do {
+            t1 = std::chrono::steady_clock::now();
+        } while(t1 - t0 < std::chrono::milliseconds(1));
+        const uint64_t c1 = ldpc::timing::now();
+        
+        const uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+        const uint64_t ticks = (c1 - c0)/us;
+        return (ticks > 0) ? ticks : 1;
+#else
+        return 1000;
+#endif
+    }
+}
+
+uint64_t ldpc::timing::ticks_per_us(void) {
+    static const uint64_t ticks = measure_ticks_per_us();
+    return ticks;
+}
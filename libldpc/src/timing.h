@@ -0,0 +1,47 @@
+#ifndef __LIBLDPC_TIMING_H__DEFINED__
+#define __LIBLDPC_TIMING_H__DEFINED__
+
+#include <stdint.h>
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace ldpc {
+    namespace timing {
+        /** Counter ticks per microsecond, measured against the steady clock on first use */
+        uint64_t ticks_per_us(void);
+        
+        /*
+         * The helpers are file-local, this header is also included by translation units compiled for other
+         * instruction sets, whose copies must not be picked up by the linker for the generic code.
+         */
+        namespace {
+            
+            /** Current value of a cheap monotonic counter to check deadlines with
+             *
+             * This is the time stamp counter on x86, which takes a few tens of cycles to read and is assumed to run
+             * at a constant rate, and the steady clock in nanoseconds elsewhere.
+             */
+            inline uint64_t now(void) {
+#if defined(__x86_64__) || defined(__i386__)
+                return __rdtsc();
+#else
+                return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+            }
+            
+            /** Counter value max_time_us microseconds from now, zero if max_time_us is zero */
+            inline uint64_t deadline(uint64_t max_time_us) {
+                return (max_time_us > 0) ? now() + max_time_us*ticks_per_us() : 0;
+            }
+            
+            /** Whether a deadline returned by deadline() has passed */
+            inline bool passed(uint64_t deadline) {
+                return deadline != 0 && now() >= deadline;
+            }
+        }
+    }
+}
+
+#endif /* __LIBLDPC_TIMING_H__DEFINED__ */
@@ -1,21 +1,11 @@
 #include <ldpc/encoder.h>
 #include <ldpc/decoder.h>
+#include <ldpc/demapper.h>
 
 #include <cstdlib>
 #include <cmath>
 #include <random>
 
-/** Convert received BPSK symbol (-1.0=1, 1.0=0) to LLR ( log10(p(0)/p(1)) ) */
-ldpc::softbit_t sym2llr(ldpc::softbit_t x, const float sigma) {
-    // p_1(x) = 0.5 + 0.25*( erf( (x-1)/scale ) + erf( (x+1)/scale ) )      with scale = sqrt(2)*sigma
-    
-    const ldpc::softbit_t p1 = 0.5f-0.5f*tanh(x/sigma/sigma);
-    const ldpc::softbit_t llr = log10( (1.0f-p1)/p1 );
-    
-    //printf("Symb: %12f => p(1)==%12f => LLR=%12f\n", x, p1, llr);
-    return llr;
-}
-
 /** count nuber of active bits in byte */
 uint8_t count_bits(uint8_t b) {
     uint8_t count = 0;
@@ -46,7 +36,7 @@ int main(int argc, char** argv) {
     //// Create encoder and decoder
     //
     ldpc::encoder enc(generator_matrix_file, systype, &pconf);
-    ldpc::decoder dec(parity_matrix_file, systype, &pconf);
+    ldpc::decoder dec(parity_matrix_file, systype, &pconf, enc.get_column_order());
     ldpc::decoder::metadata_t meta;
     
     //
@@ -119,6 +109,7 @@ int main(int argc, char** argv) {
         float EbN0 = Eb_N0_start + static_cast<float>(i)*Eb_N0_step;
         float sigma = std::sqrt((std::pow(10.0f, -EbN0/10.0f)) / 2.0f);
         std::normal_distribution<ldpc::softbit_t> rng_softbit_normal(0.0f,sigma);
+        ldpc::demapper demod(ldpc::modulation::BPSK, sigma*sigma);
         
         size_t num_errors = 0lu;
         size_t num_errors_uncoded = 0lu;
@@ -147,9 +138,7 @@ int main(int argc, char** argv) {
             //
             //// Detector
             //
-            for(j=0; j<M_punct; j++) {
-                sbits_recv[j] = sym2llr(sym_recv[j], sigma);
-            }
+            demod.demap(sbits_recv, sym_recv, M_punct);
             
             //
             //// Decoder
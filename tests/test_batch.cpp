@@ -0,0 +1,118 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/encoder.h>
+#include "test_util.h"
+
+/** Two full groups of the widest kernel (64 lanes of AVX-512 with INT8) and a partial one */
+#define NUM_FRAMES 133
+
+/** Noise deviation at which some, but not all frames of the rate 2/3 test codes fail */
+#define SIGMA 0.6f
+
+static const char *ISA_NAMES[] = { "generic", "avx2", "avx512" };
+
+/** Decode the frames one by one and in batches with every instruction set, the results have to be identical */
+static void compare(ldpc::decoder *dec, const std::vector< std::vector<ldpc::softbit_t> > &llrs, const char *descr) {
+    const uint64_t K = dec->get_num_output();
+    
+    std::vector< std::vector<ldpc::softbit_t> > out_single(NUM_FRAMES, std::vector<ldpc::softbit_t>(K));
+    std::vector<ldpc::decoder::metadata_t> meta_single(NUM_FRAMES);
+    uint64_t num_failed = 0;
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        dec->decode(out_single[f].data(), llrs[f].data(), &meta_single[f]);
+        num_failed += meta_single[f].success ? 0u : 1u;
+    }
+    
+    for(uint64_t isa=0; isa<3; isa++) {
+        CHECK(setenv("LDPC_SIMD", ISA_NAMES[isa], 1) == 0);
+        
+        std::vector< std::vector<ldpc::softbit_t> > out_batch(NUM_FRAMES, std::vector<ldpc::softbit_t>(K));
+        std::vector<ldpc::decoder::metadata_t> meta_batch(NUM_FRAMES);
+        std::vector<ldpc::softbit_t*> out_ptr(NUM_FRAMES);
+        std::vector<const ldpc::softbit_t*> in_ptr(NUM_FRAMES);
+        for(uint64_t f=0; f<NUM_FRAMES; f++) {
+            out_ptr[f] = out_batch[f].data();
+            in_ptr[f] = llrs[f].data();
+        }
+        
+        const bool all_success = dec->decode_batch(out_ptr.data(), in_ptr.data(), NUM_FRAMES, meta_batch.data());
+        printf("%s, %s: %lu lanes, %lu of %d frames failed\n", descr, ISA_NAMES[isa], dec->get_batch_lanes(), num_failed, NUM_FRAMES);
+        
+        CHECK(all_success == (num_failed == 0));
+        for(uint64_t f=0; f<NUM_FRAMES; f++) {
+            CHECK(meta_batch[f].success == meta_single[f].success);
+            CHECK(meta_batch[f].num_iterations == meta_single[f].num_iterations);
+            CHECK(meta_batch[f].failure_flags == meta_single[f].failure_flags);
+            for(uint64_t i=0; i<K; i++) {
+                CHECK((out_batch[f][i] < 0.0f) == (out_single[f][i] < 0.0f));
+            }
+        }
+    }
+    
+    CHECK(unsetenv("LDPC_SIMD") == 0);
+}
+
+static void test_code(const std::string &file, bool quasi_cyclic) {
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code c(file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    CHECK((c.get_circulant_size() != 0) == quasi_cyclic);
+    
+    ldpc::encoder enc(&c);
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc.get_num_input());
+    std::vector<uint8_t> codeword(enc.get_num_output());
+    std::vector< std::vector<ldpc::softbit_t> > llrs(NUM_FRAMES, std::vector<ldpc::softbit_t>(c.get_num_input()));
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc.encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(llrs[f].data(), codeword.data(), c.get_num_input(), SIGMA, &rng);
+    }
+    
+    // Only the criteria decode_batch() supports
+    ldpc::stopping::conf_t stop;
+    stop.max_iterations = 30;
+    stop.max_awrm_iterations = stop.max_iterations;
+    stop.min_llr_delta = 0.0f;
+    
+    const ldpc::quantization::type_t quants[] = { ldpc::quantization::FLOAT, ldpc::quantization::INT16, ldpc::quantization::INT8 };
+    const char *quant_names[] = { "FLOAT", "INT16", "INT8" };
+    const ldpc::schedule::schedule_t scheds[] = { ldpc::schedule::FLOODING, ldpc::schedule::LAYERED };
+    const char *sched_names[] = { "flooding", "layered" };
+    
+    ldpc::decoder dec(&c);
+    dec.set_algorithm(ldpc::checknode::NORMALIZED_MIN_SUM);
+    dec.set_stopping(stop);
+    for(uint64_t q=0; q<3; q++) {
+        for(uint64_t s=0; s<2; s++) {
+            dec.set_quantization(quants[q]);
+            dec.set_schedule(scheds[s]);
+            
+            std::string descr = std::string(quasi_cyclic ? "QC code" : "code") + ", " + quant_names[q] + ", " + sched_names[s];
+            compare(&dec, llrs, descr.c_str());
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s work_dir\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    
+    // Rate 2/3 code with 27x27 circulants, and the same code with shuffled information bits without this structure
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 1);
+    ldpc_test::rows_t rows = ldpc_test::expand(base);
+    const std::string qc_file = ldpc_test::path(argv[1], "batch_qc.a");
+    ldpc_test::write_alist(qc_file, rows, base.cols*base.Z);
+    
+    ldpc_test::permute_bits(&rows, 0, (base.cols-base.rows)*base.Z, 2);
+    const std::string file = ldpc_test::path(argv[1], "batch.a");
+    ldpc_test::write_alist(file, rows, base.cols*base.Z);
+    
+    test_code(file, false);
+    test_code(qc_file, true);
+    
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include <ldpc/encoder.h>
 #include <ldpc/decoder.h>
+#include <ldpc/demapper.h>
 
 #include <stdlib.h>
 #include <math.h>
@@ -7,17 +8,6 @@
 
 #define LDPC_CODES_PATH "/home/v1tzl1/work/MOVE/LDPC/code/codes/"
 
-/** Convert received BPSK symbol (-1.0=1, 1.0=0) to LLR ( log10(p(0)/p(1)) ) */
-ldpc::softbit_t sym2llr(ldpc::softbit_t x, const float sigma) {
-    // p_1(x) = 0.5 + 0.25*( erf( (x-1)/scale ) + erf( (x+1)/scale ) )      with scale = sqrt(2)*sigma
-    
-    const ldpc::softbit_t p1 = 0.5f-0.5f*tanh(x/sigma/sigma);
-    const ldpc::softbit_t llr = log10( (1.0f-p1)/p1 );
-    
-    //printf("Symb: %12f => p(1)==%12f => LLR=%12f\n", x, p1, llr);
-    return llr;
-}
-
 /** count nuber of active bits in byte */
 uint8_t count_bits(uint8_t b) {
     uint8_t count = 0;
@@ -51,7 +41,7 @@ void test(const char *code_name, ldpc::systematic::systematic_t systype, ldpc::p
     //// Create encoder and decoder
     //
     ldpc::encoder enc(filename_gen, systype, &pconf);
-    ldpc::decoder dec(filename_par, systype, &pconf);
+    ldpc::decoder dec(filename_par, systype, &pconf, enc.get_column_order());
     ldpc::decoder::metadata_t meta;
     
     //
@@ -91,6 +81,7 @@ void test(const char *code_name, ldpc::systematic::systematic_t systype, ldpc::p
     std::default_random_engine gen;
     std::uniform_int_distribution<uint8_t> rng_uint8(0,255);
     std::normal_distribution<ldpc::softbit_t> rng_softbit_normal(0.0f,sigma);
+    ldpc::demapper demod(ldpc::modulation::BPSK, sigma*sigma);
     
     const uint64_t NUM_PROGRESS_BARS = 50;
     const uint64_t PROGRESS_PER_IT = NUM_ITERATIONS / NUM_PROGRESS_BARS;
@@ -133,9 +124,7 @@ void test(const char *code_name, ldpc::systematic::systematic_t systype, ldpc::p
         //
         //// Detector
         //
-        for(i=0; i<M_punct; i++) {
-            sbits_recv[i] = sym2llr(sym_recv[i], sigma);
-        }
+        demod.demap(sbits_recv, sym_recv, M_punct);
         
         //
         //// Decoder
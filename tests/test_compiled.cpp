@@ -0,0 +1,273 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/encoder.h>
+#include "test_util.h"
+#include "checksum.h"
+
+#define NUM_FRAMES 32
+
+/** Header words of a compiled code, see code_compiled.cpp */
+#define COMPILED_HEADER_WORDS 14
+
+static const char *work_dir;
+static const char *compile_code;
+static const char *compute_generator;
+
+/** Both codes have to decode every frame to the same result */
+static void compare_decoding(const ldpc::code *a, const ldpc::code *b, ldpc::schedule::schedule_t sched) {
+    CHECK(a->get_num_input() == b->get_num_input());
+    CHECK(a->get_num_output() == b->get_num_output());
+    
+    ldpc::decoder dec_a(a);
+    ldpc::decoder dec_b(b);
+    dec_a.set_schedule(sched);
+    dec_b.set_schedule(sched);
+    
+    std::mt19937 rng(1234);
+    std::normal_distribution<float> noise(0.0f, 1.0f);
+    std::vector<ldpc::softbit_t> llrs(a->get_num_input());
+    std::vector<ldpc::softbit_t> out_a(a->get_num_output());
+    std::vector<ldpc::softbit_t> out_b(b->get_num_output());
+    uint64_t num_success = 0;
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        // All-zero codeword
+        for(uint64_t i=0; i<llrs.size(); i++) {
+            llrs[i] = 1.0f + 0.4f*noise(rng);
+        }
+        
+        ldpc::decoder::metadata_t meta_a;
+        ldpc::decoder::metadata_t meta_b;
+        const bool success_a = dec_a.decode(out_a.data(), llrs.data(), &meta_a);
+        const bool success_b = dec_b.decode(out_b.data(), llrs.data(), &meta_b);
+        CHECK(success_a == success_b);
+        CHECK(meta_a.num_iterations == meta_b.num_iterations);
+        CHECK(meta_a.syndrome_count == meta_b.syndrome_count);
+        for(uint64_t i=0; i<out_a.size(); i++) {
+            CHECK(out_a[i] == out_b[i]);
+        }
+        num_success += success_a ? 1u : 0u;
+    }
+    CHECK(num_success > 0);
+}
+
+/** A file with one payload word changed and both checksums recomputed has to be rejected by the range checks */
+static void expect_malformed(const std::vector<uint8_t> &buf, uint64_t word, uint64_t value, const char *name, const char *descr) {
+    std::vector<uint8_t> malformed(buf);
+    uint64_t *h = reinterpret_cast<uint64_t*>(malformed.data());
+    h[COMPILED_HEADER_WORDS + word] = value;
+    h[12] = ldpc::checksum::add(ldpc::checksum::INIT, &h[COMPILED_HEADER_WORDS], h[11]);
+    h[13] = ldpc::checksum::add(ldpc::checksum::INIT, h, 13);
+    
+    const std::string malformed_file = ldpc_test::path(work_dir, (std::string(name) + "_malformed.ldpc").c_str());
+    ldpc_test::write_file(malformed_file, malformed);
+    ldpc_test::expect_failure([&malformed_file]() {
+        ldpc::puncturing::conf_t punctconf(ldpc::puncturing::BACK, 27, NULL);
+        ldpc::code c(malformed_file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    });
+    printf("%s: %s rejected\n", name, descr);
+}
+
+/** Load a code from its source and compiled file with the given puncturing, both have to be identical */
+static void compare_codes(const std::string &source, const std::string &compiled, ldpc::puncturing::puncturing_t type, uint64_t num_punct, const char *name) {
+    ldpc::puncturing::conf_t punctconf(type, num_punct, NULL);
+    ldpc::code a(source.c_str(), ldpc::systematic::FRONT, &punctconf);
+    ldpc::code b(compiled.c_str(), ldpc::systematic::FRONT, &punctconf);
+    
+    CHECK(a.get_num_checks() == b.get_num_checks());
+    CHECK(a.get_num_bits() == b.get_num_bits());
+    CHECK(a.get_circulant_size() == b.get_circulant_size());
+    
+    // Writing both again stores all arrays, including the puncturing maps of this configuration
+    const std::string file_a = ldpc_test::path(work_dir, (std::string(name) + "_source.ldpc").c_str());
+    const std::string file_b = ldpc_test::path(work_dir, (std::string(name) + "_compiled.ldpc").c_str());
+    a.write_compiled(file_a.c_str());
+    b.write_compiled(file_b.c_str());
+    CHECK(ldpc_test::read_file(file_a) == ldpc_test::read_file(file_b));
+    
+    compare_decoding(&a, &b, ldpc::schedule::FLOODING);
+    compare_decoding(&a, &b, ldpc::schedule::LAYERED);
+    printf("%s: %s and %s are identical with puncturing %d of %lu bits\n", name, source.c_str(), compiled.c_str(), static_cast<int>(type), num_punct);
+}
+
+static void test_code(const std::string &source, const ldpc_test::rows_t &rows, uint64_t M, const char *name) {
+    const std::string compiled = ldpc_test::path(work_dir, (std::string(name) + ".ldpc").c_str());
+    ldpc_test::run(std::string(compile_code) + " " + source + " " + compiled + " back 27");
+    
+    // Dimensions in the header and the CSR arrays in the payload
+    const std::vector<uint8_t> buf = ldpc_test::read_file(compiled);
+    CHECK(buf.size() > COMPILED_HEADER_WORDS*sizeof(uint64_t));
+    const uint64_t *h = reinterpret_cast<const uint64_t*>(buf.data());
+    uint64_t E = 0;
+    for(uint64_t j=0; j<rows.size(); j++) {
+        E += rows[j].size();
+    }
+    CHECK(h[2] == rows.size());
+    CHECK(h[3] == M);
+    CHECK(h[4] == E);
+    
+    const uint64_t *check_offsets = &h[COMPILED_HEADER_WORDS];
+    const uint64_t *check_edges = &check_offsets[rows.size()+1];
+    for(uint64_t j=0; j<rows.size(); j++) {
+        std::vector<uint64_t> r(rows[j]);
+        std::sort(r.begin(), r.end());
+        CHECK(check_offsets[j+1]-check_offsets[j] == r.size());
+        CHECK(std::equal(r.begin(), r.end(), &check_edges[check_offsets[j]]));
+    }
+    
+    // The compiled puncturing maps and maps computed for other configurations
+    compare_codes(source, compiled, ldpc::puncturing::BACK, 27, name);
+    compare_codes(source, compiled, ldpc::puncturing::NONE, 0, name);
+    compare_codes(source, compiled, ldpc::puncturing::FRONT, 20, name);
+    compare_codes(source, compiled, ldpc::puncturing::BACK, 13, name);
+    
+    // A single changed payload byte has to be detected
+    std::vector<uint8_t> corrupt(buf);
+    corrupt[COMPILED_HEADER_WORDS*sizeof(uint64_t) + (buf.size()-COMPILED_HEADER_WORDS*sizeof(uint64_t))/2] ^= 0x10;
+    const std::string corrupt_file = ldpc_test::path(work_dir, (std::string(name) + "_corrupt.ldpc").c_str());
+    ldpc_test::write_file(corrupt_file, corrupt);
+    ldpc_test::expect_failure([&corrupt_file]() {
+        ldpc::puncturing::conf_t punctconf(ldpc::puncturing::BACK, 27, NULL);
+        ldpc::code c(corrupt_file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    });
+    printf("%s: corrupt payload rejected\n", name);
+    
+    // Consistent files whose arrays would make the decoders read out of bounds
+    const uint64_t N = h[2];
+    const uint64_t b2c = (N+1) + E + (M+1) + E;
+    expect_malformed(buf, N+1, M, name, "edge to a bit past the end");
+    expect_malformed(buf, 1, check_offsets[2]+1, name, "decreasing check offsets");
+    expect_malformed(buf, N+1+E+M, E-1, name, "bit offsets not ending at E");
+    expect_malformed(buf, b2c, h[COMPILED_HEADER_WORDS+b2c+1], name, "edge map that is no permutation");
+}
+
+/** Encoders of the generator and of its compiled version have to encode every frame the same */
+static void compare_encoding(const std::string &gen, const std::string &compiled, ldpc::puncturing::conf_t *punctconf, ldpc::encoding::encoding_t enctype, const char *descr) {
+    ldpc::encoder a(gen.c_str(), ldpc::systematic::FRONT, punctconf, enctype);
+    ldpc::encoder b(compiled.c_str(), ldpc::systematic::FRONT, punctconf, enctype);
+    CHECK(a.get_num_input() == b.get_num_input());
+    CHECK(a.get_num_output() == b.get_num_output());
+    CHECK(a.get_circulant_size() == b.get_circulant_size());
+    CHECK((a.get_circulant_size() > 0) == (enctype == ldpc::encoding::QUASI_CYCLIC));
+    
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(a.get_num_input());
+    std::vector<uint8_t> out_a(a.get_num_output());
+    std::vector<uint8_t> out_b(b.get_num_output());
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        a.encode(out_a.data(), data.data());
+        b.encode(out_b.data(), data.data());
+        CHECK(out_a == out_b);
+    }
+    printf("Generator: %s encodes like %s, %s\n", compiled.c_str(), gen.c_str(), descr);
+}
+
+static void test_generator(const std::string &alist, uint64_t N, uint64_t K) {
+    const std::string text = ldpc_test::path(work_dir, "compiled_gen.txt");
+    const std::string gen = ldpc_test::path(work_dir, "compiled_gen.gen");
+    const std::string compiled = ldpc_test::path(work_dir, "compiled_gen.cgen");
+    ldpc_test::run(std::string(compute_generator) + " " + alist + " " + text + " " + gen);
+    ldpc_test::run(std::string(compile_code) + " -g " + gen + " " + compiled);
+    
+    // Without punctured parity bits or with only the last ones punctured, the mapped columns are used in place
+    ldpc::puncturing::conf_t none;
+    compare_encoding(gen, compiled, &none, ldpc::encoding::DENSE, "no puncturing");
+    ldpc::puncturing::conf_t back(ldpc::puncturing::BACK, 27, NULL);
+    compare_encoding(gen, compiled, &back, ldpc::encoding::DENSE, "last 27 bits punctured");
+    ldpc::puncturing::conf_t back_odd(ldpc::puncturing::BACK, 13, NULL);
+    compare_encoding(gen, compiled, &back_odd, ldpc::encoding::DENSE, "last 13 bits punctured");
+    
+    // Other parity bits punctured, the columns are gathered from the mapping
+    uint64_t pos[20];
+    for(uint64_t i=0; i<20; i++) {
+        pos[i] = K + (i*N)/20 + 1;
+    }
+    ldpc::puncturing::conf_t custom(ldpc::puncturing::CUSTOM, 20, pos);
+    compare_encoding(gen, compiled, &custom, ldpc::encoding::DENSE, "20 parity bits spread out punctured");
+    
+    compare_encoding(gen, compiled, &none, ldpc::encoding::QUASI_CYCLIC, "quasi-cyclic encoding");
+    compare_encoding(gen, compiled, &custom, ldpc::encoding::QUASI_CYCLIC, "quasi-cyclic encoding, 20 parity bits punctured");
+}
+
+/** A code of a generator with pivoting, compiled in the column order of the generator */
+static void test_column_order(const ldpc_test::rows_t &rows, uint64_t M) {
+    const std::string alist = ldpc_test::path(work_dir, "compiled_pivot.a");
+    const std::string text = ldpc_test::path(work_dir, "compiled_pivot.txt");
+    const std::string gen = ldpc_test::path(work_dir, "compiled_pivot.gen");
+    const std::string compiled = ldpc_test::path(work_dir, "compiled_pivot.ldpc");
+    ldpc_test::write_alist(alist, rows, M);
+    ldpc_test::run(std::string(compute_generator) + " -p " + alist + " " + text + " " + gen);
+    ldpc_test::run(std::string(compile_code) + " -o " + gen + " " + alist + " " + compiled);
+    
+    ldpc::puncturing::conf_t none;
+    ldpc::encoder enc(gen.c_str(), ldpc::systematic::FRONT, &none);
+    const uint64_t *column_order = enc.get_column_order();
+    CHECK(column_order != NULL);
+    
+    ldpc::code a(alist.c_str(), ldpc::systematic::FRONT, &none, column_order);
+    ldpc::code b(compiled.c_str(), ldpc::systematic::FRONT, &none);
+    const std::string file_a = ldpc_test::path(work_dir, "compiled_pivot_source.ldpc");
+    a.write_compiled(file_a.c_str());
+    CHECK(ldpc_test::read_file(file_a) == ldpc_test::read_file(compiled));
+    compare_decoding(&a, &b, ldpc::schedule::LAYERED);
+    
+    // Bit i of the encoded codewords is column column_order[i] of the parity check matrix
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc.get_num_input());
+    std::vector<uint8_t> codeword(enc.get_num_output());
+    std::vector<uint8_t> bits(M);
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc.encode(codeword.data(), data.data());
+        for(uint64_t i=0; i<M; i++) {
+            bits[column_order[i]] = ldpc_test::get_bit(codeword.data(), i) ? 1 : 0;
+        }
+        CHECK(ldpc_test::count_unsatisfied(rows, bits) == 0);
+    }
+    
+    // The compiled code is already in this order
+    ldpc_test::expect_failure([&compiled, column_order]() {
+        ldpc::puncturing::conf_t punctconf;
+        ldpc::code c(compiled.c_str(), ldpc::systematic::FRONT, &punctconf, column_order);
+    });
+    printf("Column order: %s is compiled in the order of %s\n", compiled.c_str(), gen.c_str());
+}
+
+int main(int argc, char **argv) {
+    if(argc != 4) {
+        fprintf(stderr, "Usage: %s work_dir ldpc_compile_code ldpc_compute_generator\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    work_dir = argv[1];
+    compile_code = argv[2];
+    compute_generator = argv[3];
+    
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 7);
+    const uint64_t M = base.cols*base.Z;
+    ldpc_test::rows_t rows = ldpc_test::expand(base);
+    
+    // Quasi-cyclic code from its alist and its base matrix
+    const std::string alist = ldpc_test::path(work_dir, "compiled_qc.a");
+    const std::string qc_file = ldpc_test::path(work_dir, "compiled_qc.qc");
+    ldpc_test::write_alist(alist, rows, M);
+    ldpc_test::write_base_matrix(qc_file, base);
+    test_code(alist, rows, M, "alist");
+    test_code(qc_file, rows, M, "base_matrix");
+    test_generator(alist, rows.size(), M-rows.size());
+    
+    // Code without circulant structure
+    ldpc_test::permute_bits(&rows, 0, M-rows.size(), 8);
+    const std::string plain = ldpc_test::path(work_dir, "compiled.a");
+    ldpc_test::write_alist(plain, rows, M);
+    test_code(plain, rows, M, "plain");
+    
+    // Parity bits moved into the information part, so the last columns are dependent
+    ldpc_test::permute_bits(&rows, 0, M, 9);
+    test_column_order(rows, M);
+    
+    return 0;
+}
@@ -0,0 +1,242 @@
+#include <ldpc/demapper.h>
+#include "test_util.h"
+
+/** Number of symbols of every test, not a multiple of any vector width */
+#define NUM_SYMBOLS 1001
+
+/** Number of symbols the noise variance is estimated from */
+#define NUM_ESTIMATE 100000
+
+static const char *ISA_NAMES[] = { "generic", "avx2", "avx512" };
+
+/** Constellation of a demapper, I and Q of the point with label s at 2*s and 2*s+1 */
+struct constellation_t {
+    uint64_t bits;
+    std::vector<double> xy;
+};
+
+static constellation_t make_constellation(ldpc::modulation::modulation_t modtype) {
+    constellation_t c;
+    if(modtype == ldpc::modulation::BPSK) {
+        c.bits = 1;
+        c.xy = { 1.0, 0.0, -1.0, 0.0 };
+    } else if(modtype == ldpc::modulation::QPSK) {
+        const double a = std::sqrt(0.5);
+        c.bits = 2;
+        c.xy = { a, a, a, -a, -a, a, -a, -a };
+    } else {
+        c.bits = 3;
+        c.xy.resize(16);
+        for(uint64_t k=0; k<8; k++) {
+            const uint64_t label = k ^ (k >> 1);
+            c.xy[2*label] = std::cos(static_cast<double>(k)*M_PI/4.0);
+            c.xy[2*label+1] = std::sin(static_cast<double>(k)*M_PI/4.0);
+        }
+    }
+    return c;
+}
+
+/** 4+12 APSK with unit average energy, which does not have a constant modulus */
+static constellation_t make_apsk16(void) {
+    const double ratio = 2.7;
+    const double r1 = std::sqrt(16.0/(4.0 + 12.0*ratio*ratio));
+    constellation_t c;
+    c.bits = 4;
+    c.xy.resize(32);
+    for(uint64_t k=0; k<16; k++) {
+        const double r = (k < 4) ? r1 : r1*ratio;
+        const double phi = (k < 4) ? (static_cast<double>(k)+0.5)*M_PI/2.0 : (static_cast<double>(k-4)+0.5)*M_PI/6.0;
+        c.xy[2*k] = r*std::cos(phi);
+        c.xy[2*k+1] = r*std::sin(phi);
+    }
+    return c;
+}
+
+/** Decimal BPSK LLR of the demo programs before the demapper, evaluated in double precision
+ *
+ * 1-tanh() cancels for large arguments, where the LLR is taken from its closed form 2*x/sigma^2/ln(10).
+ */
+static double sym2llr(double x, double sigma) {
+    if(std::fabs(x/sigma/sigma) > 8.0) {
+        return 2.0*x/sigma/sigma/std::log(10.0);
+    }
+    const double p1 = 0.5-0.5*std::tanh(x/sigma/sigma);
+    return std::log10((1.0-p1)/p1);
+}
+
+/** Brute force decimal LLRs of one symbol, sums or maxima of the likelihoods of all points */
+static void reference_llrs(double *out, const constellation_t &c, const double *y, double noise_variance, bool exact) {
+    const uint64_t num_points = static_cast<uint64_t>(1) << c.bits;
+    for(uint64_t b=0; b<c.bits; b++) {
+        double best[2] = { -HUGE_VAL, -HUGE_VAL };
+        for(uint64_t p=0; p<num_points; p++) {
+            const double dx = y[0] - c.xy[2*p];
+            const double dy = y[1] - c.xy[2*p+1];
+            const double m = -(dx*dx + dy*dy)/(2.0*noise_variance);
+            const uint64_t v = (p >> (c.bits-1-b)) & 0x01u;
+            best[v] = (m > best[v]) ? m : best[v];
+        }
+        if(!exact) {
+            out[b] = (best[0] - best[1])/std::log(10.0);
+            continue;
+        }
+        
+        double sum[2] = { 0.0, 0.0 };
+        for(uint64_t p=0; p<num_points; p++) {
+            const double dx = y[0] - c.xy[2*p];
+            const double dy = y[1] - c.xy[2*p+1];
+            const uint64_t v = (p >> (c.bits-1-b)) & 0x01u;
+            sum[v] += std::exp(-(dx*dx + dy*dy)/(2.0*noise_variance) - best[v]);
+        }
+        out[b] = ((best[0] + std::log(sum[0])) - (best[1] + std::log(sum[1])))/std::log(10.0);
+    }
+}
+
+/** Random symbols of a constellation with noise of the given variance in each of I and Q */
+static std::vector<ldpc::softbit_t> make_samples(const constellation_t &c, uint64_t num_symbols, double noise_variance, bool real, std::mt19937 *rng) {
+    std::normal_distribution<double> noise(0.0, std::sqrt(noise_variance));
+    const uint64_t dims = real ? 1 : 2;
+    std::vector<ldpc::softbit_t> samples(dims*num_symbols);
+    for(uint64_t n=0; n<num_symbols; n++) {
+        const uint64_t s = (*rng)() & ((static_cast<uint64_t>(1) << c.bits) - 1);
+        for(uint64_t d=0; d<dims; d++) {
+            samples[dims*n+d] = static_cast<ldpc::softbit_t>(c.xy[2*s+d] + noise(*rng));
+        }
+    }
+    return samples;
+}
+
+/** Demap NUM_SYMBOLS symbols and the first bits of one more, no LLR behind them may be written */
+static void compare_llrs(const ldpc::demapper &demap, const constellation_t &c, bool real, bool exact, double noise_variance, const char *descr) {
+    std::mt19937 rng(1234);
+    const std::vector<ldpc::softbit_t> samples = make_samples(c, NUM_SYMBOLS+1, noise_variance, real, &rng);
+    
+    for(uint64_t rest=0; rest<c.bits; rest++) {
+        const uint64_t num_llrs = NUM_SYMBOLS*c.bits + rest;
+        CHECK(demap.get_num_symbols(num_llrs) == NUM_SYMBOLS + ((rest > 0) ? 1u : 0u));
+        
+        std::vector<ldpc::softbit_t> llrs(num_llrs+1, 1234.0f);
+        demap.demap(llrs.data(), samples.data(), num_llrs);
+        CHECK(llrs[num_llrs] == 1234.0f);
+        
+        double max_error = 0.0;
+        for(uint64_t n=0; n*c.bits<num_llrs; n++) {
+            double ref[DEMAPPER_MAX_BITS];
+            if(real) {
+                ref[0] = sym2llr(static_cast<double>(samples[n]), std::sqrt(noise_variance));
+            } else {
+                const double y[2] = { static_cast<double>(samples[2*n]), static_cast<double>(samples[2*n+1]) };
+                reference_llrs(ref, c, y, noise_variance, exact);
+            }
+            
+            for(uint64_t b=0; b<c.bits && n*c.bits+b<num_llrs; b++) {
+                const double error = std::fabs(static_cast<double>(llrs[n*c.bits+b]) - ref[b]);
+                CHECK(error <= 1e-4*(1.0 + std::fabs(ref[b])));
+                max_error = (error > max_error) ? error : max_error;
+            }
+        }
+        if(rest == 0) {
+            printf("%s: largest LLR error %e\n", descr, max_error);
+        }
+    }
+}
+
+static void test_llrs(const char *isa) {
+    const double noise_variances[] = { 0.1, 0.5, 1.0 };
+    
+    for(uint64_t v=0; v<3; v++) {
+        char descr[128];
+        const ldpc::softbit_t nv = static_cast<ldpc::softbit_t>(noise_variances[v]);
+        
+        snprintf(descr, sizeof(descr), "%s, BPSK, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(ldpc::modulation::BPSK, nv), make_constellation(ldpc::modulation::BPSK), true, false, noise_variances[v], descr);
+        
+        // QPSK is exact with both methods
+        snprintf(descr, sizeof(descr), "%s, QPSK, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(ldpc::modulation::QPSK, nv), make_constellation(ldpc::modulation::QPSK), false, true, noise_variances[v], descr);
+        
+        snprintf(descr, sizeof(descr), "%s, 8PSK max-log, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(ldpc::modulation::PSK8, nv), make_constellation(ldpc::modulation::PSK8), false, false, noise_variances[v], descr);
+        snprintf(descr, sizeof(descr), "%s, 8PSK exact, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(ldpc::modulation::PSK8, nv, ldpc::demapping::EXACT), make_constellation(ldpc::modulation::PSK8), false, true, noise_variances[v], descr);
+        
+        const constellation_t apsk = make_apsk16();
+        const std::vector<ldpc::softbit_t> points(apsk.xy.begin(), apsk.xy.end());
+        snprintf(descr, sizeof(descr), "%s, 16APSK max-log, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(apsk.bits, points.data(), nv), apsk, false, false, noise_variances[v], descr);
+        snprintf(descr, sizeof(descr), "%s, 16APSK exact, noise variance %.1f", isa, noise_variances[v]);
+        compare_llrs(ldpc::demapper(apsk.bits, points.data(), nv, ldpc::demapping::EXACT), apsk, false, true, noise_variances[v], descr);
+    }
+}
+
+static void test_domain(void) {
+    const constellation_t c = make_constellation(ldpc::modulation::PSK8);
+    std::mt19937 rng(1234);
+    const std::vector<ldpc::softbit_t> samples = make_samples(c, NUM_SYMBOLS, 0.5, false, &rng);
+    
+    ldpc::demapper demap(ldpc::modulation::PSK8, 0.5f);
+    std::vector<ldpc::softbit_t> llrs(NUM_SYMBOLS*c.bits);
+    std::vector<ldpc::softbit_t> llrs_natural(NUM_SYMBOLS*c.bits);
+    demap.demap(llrs.data(), samples.data(), llrs.size());
+    demap.set_domain(ldpc::llr::NATURAL);
+    demap.demap(llrs_natural.data(), samples.data(), llrs.size());
+    
+    ldpc::convert_llrs(llrs.data(), llrs.data(), llrs.size(), ldpc::llr::LOG10, ldpc::llr::NATURAL);
+    for(uint64_t i=0; i<llrs.size(); i++) {
+        CHECK(std::fabs(llrs[i] - llrs_natural[i]) <= 1e-5f*(1.0f + std::fabs(llrs[i])));
+    }
+    
+    // Without noise every LLR is infinite
+    ldpc::demapper noiseless(ldpc::modulation::BPSK, 0.0f);
+    const ldpc::softbit_t x[2] = { 0.5f, -0.5f };
+    ldpc::softbit_t out[2];
+    noiseless.demap(out, x, 2);
+    CHECK(std::isinf(out[0]) && out[0] > 0.0f);
+    CHECK(std::isinf(out[1]) && out[1] < 0.0f);
+    printf("Natural and noiseless LLRs\n");
+}
+
+static void test_estimate(void) {
+    const double noise_variances[] = { 0.02, 0.1, 0.3 };
+    const ldpc::modulation::modulation_t modtypes[] = { ldpc::modulation::BPSK, ldpc::modulation::QPSK, ldpc::modulation::PSK8 };
+    const char *names[] = { "BPSK", "QPSK", "8PSK" };
+    
+    for(uint64_t v=0; v<3; v++) {
+        std::mt19937 rng(1234);
+        
+        // Constant modulus, the moments do not depend on the sent symbols
+        for(uint64_t m=0; m<3; m++) {
+            const bool real = (modtypes[m] == ldpc::modulation::BPSK);
+            const std::vector<ldpc::softbit_t> samples = make_samples(make_constellation(modtypes[m]), NUM_ESTIMATE, noise_variances[v], real, &rng);
+            ldpc::demapper demap(modtypes[m], 1.0f);
+            const double estimate = static_cast<double>(demap.estimate_noise_variance(samples.data(), NUM_ESTIMATE));
+            CHECK(std::fabs(estimate - noise_variances[v]) <= 0.05*noise_variances[v]);
+            printf("%s: noise variance %.2f estimated as %f\n", names[m], noise_variances[v], estimate);
+        }
+    }
+    
+    // Others take the closest point as the sent one, which only holds at high SNR
+    const constellation_t apsk = make_apsk16();
+    const std::vector<ldpc::softbit_t> points(apsk.xy.begin(), apsk.xy.end());
+    std::mt19937 rng(1234);
+    const std::vector<ldpc::softbit_t> samples = make_samples(apsk, NUM_ESTIMATE, 0.002, false, &rng);
+    ldpc::demapper demap(apsk.bits, points.data(), 1.0f);
+    const double estimate = static_cast<double>(demap.estimate_noise_variance(samples.data(), NUM_ESTIMATE));
+    CHECK(std::fabs(estimate - 0.002) <= 0.1*0.002);
+    CHECK(demap.estimate_noise_variance(samples.data(), 0) == 0.0f);
+    printf("16APSK: noise variance 0.002 estimated as %f\n", estimate);
+}
+
+int main(void) {
+    // The kernels are selected when a demapper is created
+    for(uint64_t isa=0; isa<3; isa++) {
+        CHECK(setenv("LDPC_SIMD", ISA_NAMES[isa], 1) == 0);
+        test_llrs(ISA_NAMES[isa]);
+    }
+    CHECK(unsetenv("LDPC_SIMD") == 0);
+    
+    test_domain();
+    test_estimate();
+    
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include <ldpc/code.h>
+#include <ldpc/encoder.h>
+#include "test_util.h"
+
+#define NUM_FRAMES 64
+
+static const char *work_dir;
+static const char *compute_generator;
+
+/** Codeword bits (one byte per bit, information bits first) of an encoder output without punctured bits */
+static std::vector<uint8_t> get_codeword(const std::vector<uint8_t> &out, uint64_t N, uint64_t K, ldpc::systematic::systematic_t systype) {
+    const uint64_t K_bytes = (K+7)/8;
+    const uint64_t N_bytes = (N+7)/8;
+    const uint8_t *info = (systype == ldpc::systematic::FRONT) ? &out[0] : &out[N_bytes];
+    const uint8_t *parity = (systype == ldpc::systematic::FRONT) ? &out[K_bytes] : &out[0];
+    
+    std::vector<uint8_t> bits(K+N);
+    for(uint64_t i=0; i<K; i++) {
+        bits[i] = ldpc_test::get_bit(info, i) ? 1 : 0;
+    }
+    for(uint64_t i=0; i<N; i++) {
+        bits[K+i] = ldpc_test::get_bit(parity, i) ? 1 : 0;
+    }
+    return bits;
+}
+
+/** All encodings of the code have to produce the same output, whose codewords satisfy all checks */
+static void test_code(const ldpc_test::qc_base_t &base, const char *name) {
+    const ldpc_test::rows_t rows = ldpc_test::expand(base);
+    const uint64_t N = base.rows*base.Z;
+    const uint64_t M = base.cols*base.Z;
+    const uint64_t K = M-N;
+    
+    const std::string alist = ldpc_test::path(work_dir, (std::string(name) + ".a").c_str());
+    const std::string text = ldpc_test::path(work_dir, (std::string(name) + ".txt").c_str());
+    const std::string gen = ldpc_test::path(work_dir, (std::string(name) + ".gen").c_str());
+    ldpc_test::write_alist(alist, rows, M);
+    ldpc_test::run(std::string(compute_generator) + " " + alist + " " + text + " " + gen);
+    
+    // Parity bits punctured at the front and the back of the parity part, the encoders only puncture parity bits
+    const uint64_t num_punct = base.Z + 5;
+    std::vector<uint64_t> front_pos(num_punct);
+    for(uint64_t i=0; i<num_punct; i++) {
+        front_pos[i] = K+i;
+    }
+    ldpc::puncturing::conf_t none;
+    ldpc::puncturing::conf_t front(ldpc::puncturing::CUSTOM, num_punct, front_pos.data());
+    ldpc::puncturing::conf_t back(ldpc::puncturing::BACK, num_punct, NULL);
+    ldpc::puncturing::conf_t *punctconfs[] = { &none, &front, &back };
+    const char *punct_names[] = { "no puncturing", "front of the parity bits punctured", "back of the parity bits punctured" };
+    
+    const ldpc::systematic::systematic_t systypes[] = { ldpc::systematic::FRONT, ldpc::systematic::BACK };
+    
+    for(uint64_t s=0; s<2; s++) {
+        // The codewords without puncturing, to verify the punctured outputs
+        ldpc::encoder reference(gen.c_str(), systypes[s], &none, ldpc::encoding::DENSE);
+        
+        for(uint64_t p=0; p<3; p++) {
+            ldpc::code c(alist.c_str(), systypes[s], punctconfs[p]);
+            ldpc::encoder dense(gen.c_str(), systypes[s], punctconfs[p], ldpc::encoding::DENSE);
+            ldpc::encoder quasi_cyclic(gen.c_str(), systypes[s], punctconfs[p], ldpc::encoding::QUASI_CYCLIC);
+            ldpc::encoder sparse(alist.c_str(), systypes[s], punctconfs[p], ldpc::encoding::SPARSE);
+            ldpc::encoder sparse_code(&c);
+            CHECK(quasi_cyclic.get_circulant_size() == base.Z);
+            CHECK(dense.get_num_output() == sparse.get_num_output());
+            CHECK(dense.get_num_output() == quasi_cyclic.get_num_output());
+            CHECK(dense.get_num_output() == sparse_code.get_num_output());
+            
+            std::mt19937 rng(1234);
+            std::vector<uint8_t> data(dense.get_num_input());
+            std::vector<uint8_t> full(reference.get_num_output());
+            std::vector<uint8_t> out_dense(dense.get_num_output());
+            std::vector<uint8_t> out_qc(dense.get_num_output());
+            std::vector<uint8_t> out_sparse(dense.get_num_output());
+            std::vector<uint8_t> out_sparse_code(dense.get_num_output());
+            for(uint64_t f=0; f<NUM_FRAMES; f++) {
+                for(uint64_t i=0; i<data.size(); i++) {
+                    data[i] = static_cast<uint8_t>(rng());
+                }
+                dense.encode(out_dense.data(), data.data());
+                quasi_cyclic.encode(out_qc.data(), data.data());
+                sparse.encode(out_sparse.data(), data.data());
+                sparse_code.encode(out_sparse_code.data(), data.data());
+                CHECK(out_qc == out_dense);
+                CHECK(out_sparse == out_dense);
+                CHECK(out_sparse_code == out_dense);
+                
+                reference.encode(full.data(), data.data());
+                const std::vector<uint8_t> codeword = get_codeword(full, N, K, systypes[s]);
+                CHECK(ldpc_test::count_unsatisfied(rows, codeword) == 0);
+                
+                // The punctured output holds the remaining parity bits of the codeword
+                const uint64_t N_punct = N - punctconfs[p]->num_punct;
+                const std::vector<uint8_t> punctured = get_codeword(out_dense, N_punct, K, systypes[s]);
+                for(uint64_t i=0, j=0; i<N; i++) {
+                    if(!punctconfs[p]->is_punctured(K+i, M)) {
+                        CHECK(punctured[K+j] == codeword[K+i]);
+                        j++;
+                    }
+                }
+                for(uint64_t i=0; i<K; i++) {
+                    CHECK(punctured[i] == codeword[i]);
+                }
+            }
+            printf("%s (Z=%lu), systematic %s, %s: all encodings identical\n", name, base.Z, (s == 0) ? "front" : "back", punct_names[p]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    if(argc != 3) {
+        fprintf(stderr, "Usage: %s work_dir ldpc_compute_generator\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    work_dir = argv[1];
+    compute_generator = argv[2];
+    
+    // Circulant sizes that are not a multiple of the word size, one of them spanning two words
+    test_code(ldpc_test::make_qc_base(4, 12, 27, 11), "encoding_z27");
+    test_code(ldpc_test::make_qc_base(6, 18, 100, 12), "encoding_z100");
+    
+    return 0;
+}
@@ -0,0 +1,116 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/encoder.h>
+#include "test_util.h"
+
+/** Number of frames belief propagation fails on that are decoded with guesses */
+#define NUM_FAILURES 16
+
+/** Number of them that are decoded again with debug files, on the calling thread only */
+#define NUM_DEBUG 4
+
+/** Noise deviation at which belief propagation fails on a good share of the frames */
+#define SIGMA 0.65f
+
+/** Largest number of guesses, both values of one bit on the first level and of DECODER_GUESS_BEAM bits on the others */
+static uint64_t max_guesses(uint64_t M) {
+    const uint64_t depth = (DECODER_GUESS_MAX_DEPTH < M) ? DECODER_GUESS_MAX_DEPTH : M;
+    return (depth > 0) ? 2 + (depth-1)*2*DECODER_GUESS_BEAM : 0;
+}
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s work_dir\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 13);
+    const ldpc_test::rows_t rows = ldpc_test::expand(base);
+    const uint64_t M = base.cols*base.Z;
+    const std::string file = ldpc_test::path(argv[1], "guess.a");
+    const std::string debugprefix = ldpc_test::path(argv[1], "guess_debug_");
+    ldpc_test::write_alist(file, rows, M);
+    
+    // The decoder returns the whole codeword, so its checks can be verified here
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code c_enc(file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    ldpc::code c_dec(file.c_str(), ldpc::systematic::NONE, &punctconf);
+    ldpc::encoder enc(&c_enc);
+    ldpc::decoder dec(&c_dec);
+    CHECK(dec.get_num_output() == M);
+    
+    ldpc::stopping::conf_t stop;
+    stop.max_iterations = 20;
+    dec.set_stopping(stop);
+    
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc.get_num_input());
+    std::vector<uint8_t> codeword(enc.get_num_output());
+    std::vector<ldpc::softbit_t> llrs(M);
+    std::vector<ldpc::softbit_t> out(M);
+    std::vector<ldpc::softbit_t> out_debug(M);
+    std::vector<uint8_t> bits(M);
+    uint64_t num_frames = 0;
+    uint64_t num_failures = 0;
+    uint64_t num_recovered = 0;
+    
+    while(num_failures < NUM_FAILURES) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc.encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(llrs.data(), codeword.data(), M, SIGMA, &rng);
+        num_frames++;
+        
+        ldpc::decoder::metadata_t meta;
+        if(dec.decode(out.data(), llrs.data(), &meta)) {
+            // Frames decoded by belief propagation need no guesses
+            CHECK(dec.decode_guess(out.data(), llrs.data(), &meta));
+            CHECK(meta.num_guesses == 0);
+            continue;
+        }
+        num_failures++;
+        
+        const bool success = dec.decode_guess(out.data(), llrs.data(), &meta);
+        CHECK(success == meta.success);
+        CHECK(meta.num_guesses >= 2);
+        CHECK(meta.num_guesses <= max_guesses(M));
+        CHECK(meta.num_guesses % 2 == 0);
+        
+        // Every bit whose decision differs from a non-zero input LLR is counted, guessed bits included
+        uint64_t num_corrected = 0;
+        for(uint64_t i=0; i<M; i++) {
+            bits[i] = (out[i] < 0.0f) ? 1 : 0;
+            num_corrected += (llrs[i]*out[i] < 0.0f) ? 1u : 0u;
+        }
+        CHECK(meta.num_corrected == num_corrected);
+        CHECK(ldpc_test::count_unsatisfied(rows, bits) == meta.syndrome_count);
+        if(success) {
+            CHECK(meta.syndrome_count == 0);
+            num_recovered++;
+        }
+        
+        // Decoding every guess on the calling thread walks the same tree
+        if(num_failures <= NUM_DEBUG) {
+            ldpc::decoder::metadata_t meta_debug;
+            const bool success_debug = dec.decode_guess(out_debug.data(), llrs.data(), &meta_debug, debugprefix.c_str());
+            CHECK(success_debug == success);
+            CHECK(meta_debug.num_guesses == meta.num_guesses);
+            CHECK(meta_debug.num_iterations == meta.num_iterations);
+            CHECK(meta_debug.syndrome_count == meta.syndrome_count);
+            CHECK(meta_debug.num_corrected == meta.num_corrected);
+            CHECK(meta_debug.failure_flags == meta.failure_flags);
+            CHECK(out_debug == out);
+            
+            // One debug file per decoding attempt, belief propagation first
+            FILE *f = fopen((debugprefix + std::to_string(meta.num_guesses)).c_str(), "r");
+            CHECK(f != NULL);
+            fclose(f);
+        }
+    }
+    
+    printf("Belief propagation failed on %lu of %lu frames, guessing bits recovered %lu of them\n", num_failures, num_frames, num_recovered);
+    CHECK(num_recovered > 0);
+    
+    return 0;
+}
@@ -0,0 +1,249 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/encoder.h>
+#include <limits>
+#include "llr_approx.h"
+#include "test_util.h"
+
+#define NUM_FRAMES 48
+
+/** Frames decoded with the exact and the phi table sum-product update */
+#define NUM_PHI_FRAMES 400
+
+/** Error bounds stated in llr_approx.h */
+#define JACOBIAN_MAX_ERROR 4e-4
+#define BOXPLUS_MAX_ERROR 8e-4
+
+static const float INF = std::numeric_limits<float>::infinity();
+static const float NOT_A_NUMBER = std::numeric_limits<float>::quiet_NaN();
+
+/** 2*atanh(tanh(a/2)*tanh(b/2)), the exact sum of two natural LLRs */
+static double exact_boxplus(double a, double b) {
+    return 2.0*std::atanh(std::tanh(a/2.0)*std::tanh(b/2.0));
+}
+
+static void test_jacobian(void) {
+    double max_error = 0.0;
+    for(uint64_t k=0; k<=20*1024; k++) {
+        const float x = static_cast<float>(k)/1024.0f;
+        const double error = std::fabs(static_cast<double>(ldpc::approx::jacobian_correction(x)) - std::log1p(std::exp(-static_cast<double>(x))));
+        max_error = (error > max_error) ? error : max_error;
+    }
+    CHECK(max_error < JACOBIAN_MAX_ERROR);
+    CHECK(ldpc::approx::jacobian_correction(INF) == 0.0f);
+    CHECK(ldpc::approx::jacobian_correction(NOT_A_NUMBER) == 0.0f);
+    printf("Jacobian correction: largest error %e\n", max_error);
+}
+
+static void test_boxplus(void) {
+    // Magnitudes up to 16, where tanh() of the exact update still has enough precision
+    std::vector<float> grid;
+    for(uint64_t k=0; k<=16*32; k++) {
+        grid.push_back(static_cast<float>(k)/32.0f);
+        grid.push_back(-static_cast<float>(k)/32.0f);
+    }
+    
+    double max_error = 0.0;
+    for(uint64_t i=0; i<grid.size(); i++) {
+        for(uint64_t j=0; j<grid.size(); j++) {
+            const float r = ldpc::approx::boxplus(grid[i], grid[j]);
+            const double exact = exact_boxplus(static_cast<double>(grid[i]), static_cast<double>(grid[j]));
+            const double error = std::fabs(static_cast<double>(r) - exact);
+            max_error = (error > max_error) ? error : max_error;
+            
+            // The sign always is the exact one, the corrections only reduce the magnitude down to zero
+            CHECK(r == 0.0f || (r < 0.0f) == (exact < 0.0));
+            CHECK(ldpc::approx::boxplus(grid[j], grid[i]) == r);
+        }
+    }
+    CHECK(max_error < BOXPLUS_MAX_ERROR);
+    
+    // +inf is neutral, -inf flips the sign, NaN is treated like an erased bit
+    for(uint64_t i=0; i<grid.size(); i++) {
+        CHECK(ldpc::approx::boxplus(INF, grid[i]) == grid[i]);
+        CHECK(ldpc::approx::boxplus(grid[i], INF) == grid[i]);
+        CHECK(ldpc::approx::boxplus(-INF, grid[i]) == -grid[i]);
+        CHECK(ldpc::approx::boxplus(grid[i], -INF) == -grid[i]);
+        CHECK(ldpc::approx::boxplus(NOT_A_NUMBER, grid[i]) == 0.0f);
+        CHECK(ldpc::approx::boxplus(grid[i], NOT_A_NUMBER) == 0.0f);
+    }
+    CHECK(ldpc::approx::boxplus(INF, INF) == INF);
+    CHECK(ldpc::approx::boxplus(INF, -INF) == -INF);
+    CHECK(ldpc::approx::boxplus(-INF, -INF) == INF);
+    CHECK(ldpc::approx::boxplus(NOT_A_NUMBER, INF) == 0.0f);
+    CHECK(ldpc::approx::boxplus(NOT_A_NUMBER, NOT_A_NUMBER) == 0.0f);
+    printf("Boxplus: largest error %e on %lu pairs\n", max_error, grid.size()*grid.size());
+}
+
+/** phi(x) = -ln(tanh(x/2)) */
+static double exact_phi(double x) {
+    return -std::log(std::tanh(x/2.0));
+}
+
+static void test_phi_table(uint64_t steps) {
+    ldpc::approx::phi_table_t table(steps);
+    
+    // Every cell spans at most 1/steps of its magnitude, phi is decreasing
+    const double width = 1.0/static_cast<double>(steps);
+    uint64_t num = 0;
+    for(double x=static_cast<double>(LLR_PHI_MIN); x<=static_cast<double>(LLR_PHI_MAX); x*=1.0+width/7.0) {
+        const double v = static_cast<double>(table.lookup(static_cast<float>(x)));
+        CHECK(v <= exact_phi(x*(1.0-width)));
+        CHECK(v >= exact_phi(x*(1.0+width)));
+        num++;
+    }
+    
+    // The first and the last cell of the table, magnitudes beyond it and NaN read them
+    CHECK(table.lookup(LLR_PHI_MIN) == table.values[0]);
+    CHECK(table.lookup(LLR_PHI_MAX) == table.values[table.size-1]);
+    CHECK(table.lookup(0.0f) == table.values[0]);
+    CHECK(table.lookup(LLR_PHI_MIN/2.0f) == table.values[0]);
+    CHECK(table.lookup(LLR_PHI_MAX*2.0f) == table.values[table.size-1]);
+    CHECK(table.lookup(INF) == table.values[table.size-1]);
+    CHECK(table.lookup(NOT_A_NUMBER) == table.values[table.size-1]);
+    CHECK(static_cast<double>(table.values[table.size-1]) <= exact_phi(static_cast<double>(LLR_PHI_MAX)));
+    CHECK(static_cast<double>(table.values[0]) <= exact_phi(static_cast<double>(LLR_PHI_MIN)));
+    printf("Phi table of %lu steps per octave: %lu cells, %lu magnitudes within their cell bounds\n", steps, table.size, num);
+}
+
+/** The phi table update has to decode like the exact sum-product update */
+static void test_phi_decoding(const ldpc::code *c, ldpc::encoder *enc, float sigma) {
+    ldpc::decoder dec_exact(c);
+    ldpc::decoder dec_phi(c);
+    dec_exact.set_algorithm(ldpc::checknode::SUM_PRODUCT);
+    dec_phi.set_algorithm(ldpc::checknode::SUM_PRODUCT_PHI);
+    
+    ldpc::stopping::conf_t stop;
+    stop.max_iterations = 30;
+    stop.syndrome_only = true;
+    dec_exact.set_stopping(stop);
+    dec_phi.set_stopping(stop);
+    
+    const uint64_t M = c->get_num_input();
+    std::mt19937 rng(4321);
+    std::vector<uint8_t> data(enc->get_num_input());
+    std::vector<uint8_t> codeword(enc->get_num_output());
+    std::vector<ldpc::softbit_t> llrs(M);
+    std::vector<ldpc::softbit_t> out_exact(c->get_num_output());
+    std::vector<ldpc::softbit_t> out_phi(c->get_num_output());
+    uint64_t frame_errors[2] = { 0, 0 };
+    uint64_t bit_errors[2] = { 0, 0 };
+    uint64_t num_same = 0;
+    
+    for(uint64_t f=0; f<NUM_PHI_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc->encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(llrs.data(), codeword.data(), M, sigma, &rng);
+        
+        dec_exact.decode(out_exact.data(), llrs.data());
+        dec_phi.decode(out_phi.data(), llrs.data());
+        
+        // Information bits of a systematic code at the front
+        uint64_t errors[2] = { 0, 0 };
+        bool same = true;
+        for(uint64_t i=0; i<out_exact.size(); i++) {
+            const bool bit = ldpc_test::get_bit(codeword.data(), i);
+            errors[0] += ((out_exact[i] < 0.0f) != bit) ? 1u : 0u;
+            errors[1] += ((out_phi[i] < 0.0f) != bit) ? 1u : 0u;
+            same = same && ((out_exact[i] < 0.0f) == (out_phi[i] < 0.0f));
+        }
+        for(uint64_t k=0; k<2; k++) {
+            bit_errors[k] += errors[k];
+            frame_errors[k] += (errors[k] > 0) ? 1u : 0u;
+        }
+        num_same += same ? 1u : 0u;
+    }
+    
+    // Within a tolerance of a tenth of the errors of the exact update, and a few frames more or less
+    const double ber_exact = static_cast<double>(bit_errors[0])/static_cast<double>(NUM_PHI_FRAMES*out_exact.size());
+    const double ber_phi = static_cast<double>(bit_errors[1])/static_cast<double>(NUM_PHI_FRAMES*out_exact.size());
+    CHECK(frame_errors[0] > 0);
+    CHECK(frame_errors[1] <= frame_errors[0] + frame_errors[0]/10 + 2);
+    CHECK(frame_errors[0] <= frame_errors[1] + frame_errors[1]/10 + 2);
+    CHECK(ber_phi <= 1.25*ber_exact + 1e-4);
+    CHECK(num_same >= NUM_PHI_FRAMES*9/10);
+    printf("Phi update: %lu/%lu frame errors and BER %e/%e of the exact/phi update, %lu of %d frames decoded to the same bits\n",
+           frame_errors[0], frame_errors[1], ber_exact, ber_phi, num_same, NUM_PHI_FRAMES);
+}
+
+/** Decimal LLRs and their natural conversion have to be decoded to the same bits */
+static void test_domain(const ldpc::code *c, ldpc::encoder *enc, ldpc::checknode::algorithm_t algorithm, float sigma) {
+    ldpc::decoder dec_log10(c);
+    ldpc::decoder dec_natural(c);
+    dec_natural.set_domain(ldpc::llr::NATURAL);
+    dec_log10.set_algorithm(algorithm);
+    dec_natural.set_algorithm(algorithm);
+    
+    // Thresholds are given in LLRs of the domain, only the syndromes stop the decoding
+    ldpc::stopping::conf_t stop;
+    stop.max_iterations = 30;
+    stop.syndrome_only = true;
+    dec_log10.set_stopping(stop);
+    dec_natural.set_stopping(stop);
+    
+    const uint64_t M = c->get_num_input();
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc->get_num_input());
+    std::vector<uint8_t> codeword(enc->get_num_output());
+    std::vector<ldpc::softbit_t> llrs(M);
+    std::vector<ldpc::softbit_t> llrs_natural(M);
+    std::vector<ldpc::softbit_t> out_log10(c->get_num_output());
+    std::vector<ldpc::softbit_t> out_natural(c->get_num_output());
+    uint64_t num_success = 0;
+    
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc->encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(llrs.data(), codeword.data(), M, sigma, &rng);
+        ldpc::convert_llrs(llrs_natural.data(), llrs.data(), M, ldpc::llr::LOG10, ldpc::llr::NATURAL);
+        
+        ldpc::decoder::metadata_t meta_log10;
+        ldpc::decoder::metadata_t meta_natural;
+        const bool success = dec_log10.decode(out_log10.data(), llrs.data(), &meta_log10);
+        CHECK(dec_natural.decode(out_natural.data(), llrs_natural.data(), &meta_natural) == success);
+        CHECK(meta_natural.num_iterations == meta_log10.num_iterations);
+        
+        // The output LLRs are given in the domain of the decoder, those of failed frames oscillate and drift apart
+        if(success) {
+            ldpc::convert_llrs(out_natural.data(), out_natural.data(), out_natural.size(), ldpc::llr::NATURAL, ldpc::llr::LOG10);
+            for(uint64_t i=0; i<out_log10.size(); i++) {
+                CHECK((out_natural[i] < 0.0f) == (out_log10[i] < 0.0f));
+                CHECK(std::fabs(out_natural[i] - out_log10[i]) <= 1e-3f*(1.0f + std::fabs(out_log10[i])));
+            }
+        }
+        num_success += success ? 1u : 0u;
+    }
+    CHECK(num_success > 0);
+    printf("Algorithm %d: decimal and natural LLRs decoded alike, %lu of %d frames decoded\n", static_cast<int>(algorithm), num_success, NUM_FRAMES);
+}
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s work_dir\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    
+    test_jacobian();
+    test_boxplus();
+    test_phi_table(1);
+    test_phi_table(static_cast<uint64_t>(DECODER_PHI_STEPS));
+    test_phi_table(static_cast<uint64_t>(DECODER_PHI_MAX_STEPS));
+    
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 17);
+    const std::string file = ldpc_test::path(argv[1], "llr.a");
+    ldpc_test::write_alist(file, ldpc_test::expand(base), base.cols*base.Z);
+    
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code c(file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    ldpc::encoder enc(&c);
+    test_domain(&c, &enc, ldpc::checknode::SUM_PRODUCT, 0.65f);
+    test_domain(&c, &enc, ldpc::checknode::MIN_SUM, 0.6f);
+    test_domain(&c, &enc, ldpc::checknode::SUM_PRODUCT_PHI, 0.65f);
+    test_phi_decoding(&c, &enc, 0.62f);
+    
+    return 0;
+}
@@ -0,0 +1,103 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/encoder.h>
+#include "test_util.h"
+
+/** Number of frames belief propagation fails on that are post-processed */
+#define NUM_FAILURES 24
+
+/** Noise deviation at which belief propagation fails on a good share of the frames */
+#define SIGMA 0.65f
+
+/** Largest number of test patterns of the given order, i.e. of at most order flips of window bits */
+static uint64_t max_patterns(uint64_t window, uint64_t order) {
+    uint64_t num = 1;
+    uint64_t binom = 1;
+    for(uint64_t i=1; i<=order && i<=window; i++) {
+        binom = binom*(window-i+1)/i;
+        num += binom;
+    }
+    return num;
+}
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s work_dir\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 5);
+    const ldpc_test::rows_t rows = ldpc_test::expand(base);
+    const uint64_t M = base.cols*base.Z;
+    const uint64_t K = M-rows.size();
+    const std::string file = ldpc_test::path(argv[1], "osd.a");
+    ldpc_test::write_alist(file, rows, M);
+    
+    // The decoder returns the whole codeword, so its checks can be verified here
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code c_enc(file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    ldpc::code c_dec(file.c_str(), ldpc::systematic::NONE, &punctconf);
+    ldpc::encoder enc(&c_enc);
+    ldpc::decoder dec(&c_dec);
+    CHECK(dec.get_num_output() == M);
+    
+    ldpc::stopping::conf_t stop;
+    stop.max_iterations = 20;
+    dec.set_stopping(stop);
+    
+    // The parity part has full rank, so all other bits are candidates of the window
+    const uint64_t window = (DECODER_OSD_WINDOW > 0 && DECODER_OSD_WINDOW < K) ? DECODER_OSD_WINDOW : K;
+    
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc.get_num_input());
+    std::vector<uint8_t> codeword(enc.get_num_output());
+    std::vector<ldpc::softbit_t> llrs(M);
+    std::vector<ldpc::softbit_t> out(M);
+    std::vector<uint8_t> bits(M);
+    uint64_t num_frames = 0;
+    uint64_t num_failures = 0;
+    uint64_t num_corrected[3] = { 0, 0, 0 };
+    
+    while(num_failures < NUM_FAILURES) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc.encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(llrs.data(), codeword.data(), M, SIGMA, &rng);
+        num_frames++;
+        
+        ldpc::decoder::metadata_t meta;
+        if(dec.decode(out.data(), llrs.data(), &meta)) {
+            // Frames decoded by belief propagation are not post-processed
+            CHECK(dec.decode_osd(out.data(), llrs.data(), &meta, 2));
+            CHECK(meta.num_guesses == 0);
+            continue;
+        }
+        num_failures++;
+        
+        for(uint64_t order=0; order<=2; order++) {
+            CHECK(dec.decode_osd(out.data(), llrs.data(), &meta, order));
+            CHECK(meta.success);
+            CHECK(meta.syndrome_count == 0);
+            CHECK(meta.num_guesses >= 1);
+            CHECK(meta.num_guesses <= max_patterns(window, order));
+            
+            for(uint64_t i=0; i<M; i++) {
+                bits[i] = (out[i] < 0.0f) ? 1 : 0;
+            }
+            CHECK(ldpc_test::count_unsatisfied(rows, bits) == 0);
+            
+            bool sent = true;
+            for(uint64_t i=0; i<M; i++) {
+                sent = sent && (bits[i] == (ldpc_test::get_bit(codeword.data(), i) ? 1 : 0));
+            }
+            num_corrected[order] += sent ? 1u : 0u;
+        }
+    }
+    
+    printf("Belief propagation failed on %lu of %lu frames, OSD of order 0, 1 and 2 returned the sent codeword for %lu, %lu and %lu of them\n",
+           num_failures, num_frames, num_corrected[0], num_corrected[1], num_corrected[2]);
+    CHECK(num_corrected[2] > 0);
+    
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <ldpc/code.h>
+#include <ldpc/decoder.h>
+#include <ldpc/decoder_pool.h>
+#include <ldpc/encoder.h>
+#include <mutex>
+#include "test_util.h"
+
+#define NUM_FRAMES 96
+#define NUM_STREAMS 3
+#define NUM_THREADS 4
+
+/** Frames of the test, every other one noisy enough to take many iterations or fail */
+struct frames_t {
+    std::vector< std::vector<ldpc::softbit_t> > llrs;
+    std::vector< std::vector<ldpc::softbit_t> > out;
+    std::vector<ldpc::decoder::metadata_t> meta;
+};
+
+/** Delivery log of the callbacks */
+struct log_t {
+    std::mutex mutex;
+    const frames_t *expected;
+    std::vector< std::vector<uint64_t> > delivered;
+    uint64_t num_delivered;
+};
+
+struct job_t {
+    log_t *log;
+    uint64_t frame;
+};
+
+static void check_frame(const frames_t *expected, uint64_t frame, const ldpc::softbit_t *out, const ldpc::decoder::metadata_t *meta) {
+    CHECK(meta->success == expected->meta[frame].success);
+    CHECK(meta->num_iterations == expected->meta[frame].num_iterations);
+    CHECK(meta->failure_flags == expected->meta[frame].failure_flags);
+    for(uint64_t i=0; i<expected->out[frame].size(); i++) {
+        CHECK((out[i] < 0.0f) == (expected->out[frame][i] < 0.0f));
+    }
+}
+
+static void callback(void *user, ldpc::softbit_t *out, const ldpc::decoder::metadata_t *meta) {
+    job_t *job = static_cast<job_t*>(user);
+    check_frame(job->log->expected, job->frame, out, meta);
+    
+    std::lock_guard<std::mutex> lock(job->log->mutex);
+    job->log->delivered[job->frame % NUM_STREAMS].push_back(job->frame);
+    job->log->num_delivered++;
+}
+
+/** Every stream has to be delivered in the order of submission */
+static void check_order(const log_t &log, uint64_t num_frames) {
+    for(uint64_t s=0; s<NUM_STREAMS; s++) {
+        CHECK(log.delivered[s].size() == (num_frames+NUM_STREAMS-1-s)/NUM_STREAMS);
+        for(uint64_t i=0; i<log.delivered[s].size(); i++) {
+            CHECK(log.delivered[s][i] == i*NUM_STREAMS+s);
+        }
+    }
+}
+
+static void test_callbacks(const ldpc::code *c, const frames_t &frames) {
+    std::vector< std::vector<ldpc::softbit_t> > out(NUM_FRAMES, std::vector<ldpc::softbit_t>(c->get_num_output()));
+    std::vector<job_t> jobs(NUM_FRAMES);
+    log_t log;
+    log.expected = &frames;
+    log.delivered.resize(NUM_STREAMS);
+    log.num_delivered = 0;
+    
+    ldpc::decoder_pool pool(c, NUM_THREADS, true);
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        jobs[f].log = &log;
+        jobs[f].frame = f;
+        pool.submit(out[f].data(), frames.llrs[f].data(), callback, &jobs[f], f % NUM_STREAMS);
+        CHECK(pool.get_queue_depth() <= f+1);
+    }
+    pool.wait();
+    
+    std::lock_guard<std::mutex> lock(log.mutex);
+    CHECK(log.num_delivered == NUM_FRAMES);
+    CHECK(pool.get_num_decoded() == NUM_FRAMES);
+    CHECK(pool.get_queue_depth() == 0);
+    check_order(log, NUM_FRAMES);
+    printf("Callbacks: %d frames on %d streams delivered in order\n", NUM_FRAMES, NUM_STREAMS);
+}
+
+static void test_futures(const ldpc::code *c, const frames_t &frames) {
+    std::vector< std::vector<ldpc::softbit_t> > out(NUM_FRAMES, std::vector<ldpc::softbit_t>(c->get_num_output()));
+    std::vector< std::future<ldpc::decoder::metadata_t> > futures(NUM_FRAMES);
+    
+    ldpc::decoder_pool pool(c, NUM_THREADS, true);
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        futures[f] = pool.submit(out[f].data(), frames.llrs[f].data(), f % NUM_STREAMS);
+    }
+    
+    // Once a frame has been delivered, all earlier frames of its stream have been delivered as well
+    for(uint64_t f=NUM_FRAMES; f-- > 0; ) {
+        futures[f].wait();
+        for(uint64_t g=f%NUM_STREAMS; g<f; g+=NUM_STREAMS) {
+            CHECK(futures[g].wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+        }
+        
+        const ldpc::decoder::metadata_t meta = futures[f].get();
+        check_frame(&frames, f, out[f].data(), &meta);
+    }
+    printf("Futures: %d frames on %d streams delivered in order\n", NUM_FRAMES, NUM_STREAMS);
+}
+
+static void test_destructor(const ldpc::code *c, const frames_t &frames) {
+    std::vector< std::vector<ldpc::softbit_t> > out(NUM_FRAMES, std::vector<ldpc::softbit_t>(c->get_num_output()));
+    std::vector<job_t> jobs(NUM_FRAMES);
+    log_t log;
+    log.expected = &frames;
+    log.delivered.resize(NUM_STREAMS);
+    log.num_delivered = 0;
+    
+    {
+        ldpc::decoder_pool pool(c, NUM_THREADS, true);
+        for(uint64_t f=0; f<NUM_FRAMES; f++) {
+            jobs[f].log = &log;
+            jobs[f].frame = f;
+            pool.submit(out[f].data(), frames.llrs[f].data(), callback, &jobs[f], f % NUM_STREAMS);
+        }
+    }
+    
+    // The destructor waits for all frames without wait()
+    CHECK(log.num_delivered == NUM_FRAMES);
+    check_order(log, NUM_FRAMES);
+    printf("Destructor: %d frames delivered\n", NUM_FRAMES);
+}
+
+int main(int argc, char **argv) {
+    if(argc != 2) {
+        fprintf(stderr, "Usage: %s work_dir\n", argv[0]);
+        exit( EXIT_FAILURE );
+    }
+    
+    const ldpc_test::qc_base_t base = ldpc_test::make_qc_base(4, 12, 27, 3);
+    const std::string file = ldpc_test::path(argv[1], "pool.a");
+    ldpc_test::write_alist(file, ldpc_test::expand(base), base.cols*base.Z);
+    
+    ldpc::puncturing::conf_t punctconf;
+    ldpc::code c(file.c_str(), ldpc::systematic::FRONT, &punctconf);
+    ldpc::encoder enc(&c);
+    ldpc::decoder dec(&c);
+    
+    // Frames of very different decoding times, so they finish out of order
+    frames_t frames;
+    frames.llrs.assign(NUM_FRAMES, std::vector<ldpc::softbit_t>(c.get_num_input()));
+    frames.out.assign(NUM_FRAMES, std::vector<ldpc::softbit_t>(c.get_num_output()));
+    frames.meta.resize(NUM_FRAMES);
+    
+    std::mt19937 rng(1234);
+    std::vector<uint8_t> data(enc.get_num_input());
+    std::vector<uint8_t> codeword(enc.get_num_output());
+    for(uint64_t f=0; f<NUM_FRAMES; f++) {
+        for(uint64_t i=0; i<data.size(); i++) {
+            data[i] = static_cast<uint8_t>(rng());
+        }
+        enc.encode(codeword.data(), data.data());
+        ldpc_test::bpsk_llrs(frames.llrs[f].data(), codeword.data(), c.get_num_input(), (f % 2) ? 0.85f : 0.4f, &rng);
+        dec.decode(frames.out[f].data(), frames.llrs[f].data(), &frames.meta[f]);
+    }
+    
+    test_callbacks(&c, frames);
+    test_futures(&c, frames);
+    test_destructor(&c, frames);
+    
+    return 0;
+}
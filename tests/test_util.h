@@ -0,0 +1,241 @@
+#ifndef __LDPC_TESTS_TEST_UTIL_H__DEFINED__
+#define __LDPC_TESTS_TEST_UTIL_H__DEFINED__
+
+#include <ldpc/ldpc.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+/** Exit with an error message if a condition of a test does not hold */
+#define CHECK(cond) \
+    do { \
+        if(!(cond)) { \
+            fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit( EXIT_FAILURE ); \
+        } \
+    } while(0)
+
+/** Helpers of the unittests
+ *
+ * The tests do not depend on code files, they generate quasi-cyclic codes with the dual-diagonal parity part
+ * of IEEE 802.11n. Its first parity block column has the shifts 1, 0 and 1 in the first, middle and last block
+ * row, all other parity block columns form a staircase of identities. The sum of all block rows leaves a single
+ * identity in the parity part, so the parity part is invertible for any circulant size.
+ */
+namespace ldpc_test {
+    
+    /** Bit indices of every check of a parity check matrix */
+    typedef std::vector< std::vector<uint64_t> > rows_t;
+    
+    /** Base matrix of a quasi-cyclic code, -1 denotes an all-zero block */
+    struct qc_base_t {
+        uint64_t rows;
+        uint64_t cols;
+        uint64_t Z;
+        std::vector<int64_t> shifts;
+    };
+    
+    /** Base matrix with random shifts in the information part and an invertible parity part */
+    inline qc_base_t make_qc_base(uint64_t rows, uint64_t cols, uint64_t Z, uint32_t seed) {
+        qc_base_t b;
+        b.rows = rows;
+        b.cols = cols;
+        b.Z = Z;
+        b.shifts.assign(rows*cols, -1);
+        
+        std::mt19937 rng(seed);
+        for(uint64_t r=0; r<rows; r++) {
+            for(uint64_t c=0; c<cols-rows; c++) {
+                b.shifts[r*cols+c] = static_cast<int64_t>(rng() % Z);
+            }
+        }
+        
+        const uint64_t pc = cols-rows;
+        b.shifts[0*cols+pc] = 1;
+        b.shifts[(rows/2)*cols+pc] = 0;
+        b.shifts[(rows-1)*cols+pc] = 1;
+        for(uint64_t i=0; i+1<rows; i++) {
+            b.shifts[i*cols+pc+1+i] = 0;
+            b.shifts[(i+1)*cols+pc+1+i] = 0;
+        }
+        
+        return b;
+    }
+    
+    /** Check r*Z+t is connected to bit c*Z+(t+s)%Z for every block with shift s */
+    inline rows_t expand(const qc_base_t &b) {
+        rows_t rows(b.rows*b.Z);
+        for(uint64_t r=0; r<b.rows; r++) {
+            for(uint64_t c=0; c<b.cols; c++) {
+                const int64_t s = b.shifts[r*b.cols+c];
+                if(s < 0) {
+                    continue;
+                }
+                for(uint64_t t=0; t<b.Z; t++) {
+                    rows[r*b.Z+t].push_back(c*b.Z+(t+static_cast<uint64_t>(s))%b.Z);
+                }
+            }
+        }
+        return rows;
+    }
+    
+    /** Shuffle the bits first...last-1, e.g. the information bits to destroy the quasi-cyclic structure */
+    inline void permute_bits(rows_t *rows, uint64_t first, uint64_t last, uint32_t seed) {
+        std::vector<uint64_t> perm(last-first);
+        for(uint64_t i=0; i<perm.size(); i++) {
+            perm[i] = first+i;
+        }
+        std::mt19937 rng(seed);
+        std::shuffle(perm.begin(), perm.end(), rng);
+        
+        for(uint64_t j=0; j<rows->size(); j++) {
+            for(uint64_t i=0; i<(*rows)[j].size(); i++) {
+                uint64_t &bit = (*rows)[j][i];
+                if(bit >= first && bit < last) {
+                    bit = perm[bit-first];
+                }
+            }
+        }
+    }
+    
+    inline void write_alist(const std::string &file, const rows_t &rows, uint64_t M) {
+        std::vector< std::vector<uint64_t> > cols(M);
+        uint64_t max_row = 0;
+        for(uint64_t j=0; j<rows.size(); j++) {
+            for(uint64_t i=0; i<rows[j].size(); i++) {
+                cols[rows[j][i]].push_back(j);
+            }
+            max_row = (rows[j].size() > max_row) ? rows[j].size() : max_row;
+        }
+        uint64_t max_col = 0;
+        for(uint64_t i=0; i<M; i++) {
+            max_col = (cols[i].size() > max_col) ? cols[i].size() : max_col;
+        }
+        
+        FILE *f = fopen(file.c_str(), "w");
+        CHECK(f != NULL);
+        fprintf(f, "%lu %lu\n%lu %lu\n", rows.size(), M, max_row, max_col);
+        for(uint64_t j=0; j<rows.size(); j++) {
+            fprintf(f, "%lu ", rows[j].size());
+        }
+        fprintf(f, "\n");
+        for(uint64_t i=0; i<M; i++) {
+            fprintf(f, "%lu ", cols[i].size());
+        }
+        fprintf(f, "\n");
+        for(uint64_t j=0; j<rows.size(); j++) {
+            std::vector<uint64_t> r(rows[j]);
+            std::sort(r.begin(), r.end());
+            for(uint64_t i=0; i<r.size(); i++) {
+                fprintf(f, "%lu ", r[i]+1);
+            }
+            fprintf(f, "\n");
+        }
+        for(uint64_t i=0; i<M; i++) {
+            for(uint64_t j=0; j<cols[i].size(); j++) {
+                fprintf(f, "%lu ", cols[i][j]+1);
+            }
+            fprintf(f, "\n");
+        }
+        CHECK(fclose(f) == 0);
+    }
+    
+    inline void write_base_matrix(const std::string &file, const qc_base_t &b) {
+        FILE *f = fopen(file.c_str(), "w");
+        CHECK(f != NULL);
+        fprintf(f, "%lu %lu %lu\n", b.rows, b.cols, b.Z);
+        for(uint64_t r=0; r<b.rows; r++) {
+            for(uint64_t c=0; c<b.cols; c++) {
+                fprintf(f, "%ld ", b.shifts[r*b.cols+c]);
+            }
+            fprintf(f, "\n");
+        }
+        CHECK(fclose(f) == 0);
+    }
+    
+    /** Bit i of a buffer, MSB first like the encoder output */
+    inline bool get_bit(const uint8_t *buf, uint64_t i) {
+        return (buf[i/8] & (0x80 >> (i%8))) != 0;
+    }
+    
+    /** Number of checks a codeword (one byte per bit) does not satisfy */
+    inline uint64_t count_unsatisfied(const rows_t &rows, const std::vector<uint8_t> &bits) {
+        uint64_t count = 0;
+        for(uint64_t j=0; j<rows.size(); j++) {
+            uint8_t parity = 0;
+            for(uint64_t i=0; i<rows[j].size(); i++) {
+                parity ^= bits[rows[j][i]];
+            }
+            count += parity;
+        }
+        return count;
+    }
+    
+    /** Decimal LLRs of num bits sent with BPSK over an AWGN channel with noise deviation sigma */
+    inline void bpsk_llrs(ldpc::softbit_t *llr, const uint8_t *buf, uint64_t num, float sigma, std::mt19937 *rng) {
+        std::normal_distribution<float> noise(0.0f, sigma);
+        const float factor = 2.0f/(sigma*sigma)/std::log(10.0f);
+        for(uint64_t i=0; i<num; i++) {
+            const float y = (get_bit(buf, i) ? -1.0f : 1.0f) + noise(*rng);
+            llr[i] = factor*y;
+        }
+    }
+    
+    /** Path of a file in the working directory of the test */
+    inline std::string path(const char *dir, const char *name) {
+        return std::string(dir) + "/" + name;
+    }
+    
+    /** Contents of a file */
+    inline std::vector<uint8_t> read_file(const std::string &file) {
+        FILE *f = fopen(file.c_str(), "rb");
+        CHECK(f != NULL);
+        std::vector<uint8_t> buf;
+        uint8_t chunk[4096];
+        size_t num;
+        while((num = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+            buf.insert(buf.end(), chunk, chunk+num);
+        }
+        CHECK(fclose(f) == 0);
+        return buf;
+    }
+    
+    inline void write_file(const std::string &file, const std::vector<uint8_t> &buf) {
+        FILE *f = fopen(file.c_str(), "wb");
+        CHECK(f != NULL);
+        CHECK(fwrite(buf.data(), 1, buf.size(), f) == buf.size());
+        CHECK(fclose(f) == 0);
+    }
+    
+    /** Run a function in a child process and check that it exits with EXIT_FAILURE, as the library does on invalid input */
+    template<typename F> void expect_failure(F func) {
+        fflush(stdout);
+        fflush(stderr);
+        const pid_t pid = fork();
+        CHECK(pid >= 0);
+        if(pid == 0) {
+            func();
+            _exit(EXIT_SUCCESS);
+        }
+        
+        int status;
+        CHECK(waitpid(pid, &status, 0) == pid);
+        CHECK(WIFEXITED(status) && WEXITSTATUS(status) == EXIT_FAILURE);
+    }
+    
+    /** Run a command, e.g. one of the applications, and check that it succeeds */
+    inline void run(const std::string &cmd) {
+        printf("%s\n", cmd.c_str());
+        fflush(stdout);
+        CHECK(system(cmd.c_str()) == 0);
+    }
+}
+
+#endif /* __LDPC_TESTS_TEST_UTIL_H__DEFINED__ */